@@ -41,6 +41,7 @@ BIT fEZMacPRO_PacketSent = 0;
 BIT fEZMacPRO_LBTTimeout = 0;
 BIT fEZMacPRO_AckTimeout = 0;
 BIT fEZMacPRO_AckSending = 0;
+BIT fEZMacPRO_BulkReceived = 0;
 
 
                 /* ======================================= *
@@ -144,7 +145,7 @@ void EZMacPRO_PacketForwarding(void)
 
 
 #ifndef RECEIVER_ONLY_OPERATION
-void EZMacPRO_PacketSent(void)
+void EZMacPRO_PacketSent(U8 attempts)
 {
     fEZMacPRO_PacketSent = 1;
 }
@@ -161,7 +162,7 @@ void EZMacPRO_LBTTimeout (void)
 
 #ifdef EXTENDED_PACKET_FORMAT
 #ifdef TRANSCEIVER_OPERATION
-void EZMacPRO_AckTimeout (void)
+void EZMacPRO_AckTimeout (U8 attempts)
 {
     fEZMacPRO_AckTimeout = 1;
 }
@@ -169,6 +170,16 @@ void EZMacPRO_AckTimeout (void)
 #endif //EXTENDED_PACKET_FORMAT
 
 
+#ifdef EXTENDED_PACKET_FORMAT
+#ifdef TRANSCEIVER_OPERATION
+void EZMacPRO_BulkReceived (void)
+{
+    fEZMacPRO_BulkReceived = 1;
+}
+#endif //TRANSCEIVER_OPERATION
+#endif //EXTENDED_PACKET_FORMAT
+
+
 void EZMacPRO_CRCError(void)
 {
     fEZMacPRO_CRCError = 1;
@@ -40,6 +40,7 @@ volatile BIT fEZMacPRO_PacketSent = 0;
 volatile BIT fEZMacPRO_LBTTimeout = 0;
 volatile BIT fEZMacPRO_AckTimeout = 0;
 volatile BIT fEZMacPRO_AckSending = 0;
+volatile BIT fEZMacPRO_BulkReceived = 0;
 
 /* ======================================= *
  *   C A L L B A C K   F U N C T I O N S   *
@@ -52,6 +53,7 @@ void EZMacPRO_StateWakeUpEntered(void)
 {
 	TRACE("EZMacPRO_StateWakeUpEntered\n");
     fEZMacPRO_StateWakeUpEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_WAKE_UP, 0);
 }
 
 /*!
@@ -61,6 +63,7 @@ void EZMacPRO_StateSleepEntered(void)
 {
 	TRACE("EZMacPRO_StateSleepEntered\n");
     fEZMacPRO_StateSleepEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_SLEEP, 0);
 }
 
 /*!
@@ -70,6 +73,7 @@ void EZMacPRO_StateIdleEntered(void)
 {
 	TRACE("EZMacPRO_StateIdleEntered\n");
     fEZMacPRO_StateIdleEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_IDLE, 0);
 }
 
 /*!
@@ -79,6 +83,7 @@ void EZMacPRO_StateRxEntered(void)
 {
 	TRACE("EZMacPRO_StateRxEntered\n");
     fEZMacPRO_StateRxEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_RX, 0);
 }
 
 /*!
@@ -88,6 +93,7 @@ void EZMacPRO_StateTxEntered(void)
 {
 	TRACE("EZMacPRO_StateTxEntered\n");
     fEZMacPRO_StateTxEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_TX, 0);
 }
 
 /*!
@@ -97,18 +103,21 @@ void EZMacPRO_StateErrorEntered(void)
 {
 	TRACE("EZMacPRO_StateErrorEntered\n");
     fEZMacPRO_StateErrorEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_ERROR, 0);
 }
 
 void EZMacPRO_LFTimerExpired(void)
 {
 	TRACE("EZMacPRO_LFTimerExpired\n");
     fEZMacPRO_LFTimerExpired = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_LF_TIMER_EXPIRED, 0);
 }
 
 void EZMacPRO_LowBattery(void)
 {
 	TRACE("EZMacPRO_LowBattery\n");
     fEZMacPRO_LowBattery = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_LOW_BATTERY, 0);
 }
 
 
@@ -117,6 +126,7 @@ void EZMacPRO_SyncWordReceived(void)
 {
 	TRACE("EZMacPRO_SyncWordReceived\n");
     fEZMacPRO_SyncWordReceived = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_SYNC_WORD_RECEIVED, 0);
 }
 #endif
 
@@ -126,6 +136,7 @@ void EZMacPRO_PacketDiscarded(void)
 {
 	TRACE("EZMacPRO_PacketDiscarded\n");
     fEZMacPRO_PacketDiscarded = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_DISCARDED, 0);
 }
 #endif
 
@@ -133,10 +144,9 @@ void EZMacPRO_PacketDiscarded(void)
 #ifndef TRANSMITTER_ONLY_OPERATION
 void EZMacPRO_PacketReceived(U8 rssi)
 {
-    U8 rssiVal;
 	TRACE("EZMacPRO_PacketReceived\n");
-    rssiVal = rssi; // touch rssi to eliminate warning
     fEZMacPRO_PacketReceived = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_RECEIVED, rssi);
 }
 #endif
 
@@ -146,15 +156,17 @@ void EZMacPRO_PacketForwarding(void)
 {
 	TRACE("EZMacPRO_PacketForwarding\n");
     fEZMacPRO_PacketForwarding = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_FORWARDING, 0);
 }
 #endif
 
 
 #ifndef RECEIVER_ONLY_OPERATION
-void EZMacPRO_PacketSent(void)
+void EZMacPRO_PacketSent(U8 attempts)
 {
 	TRACE("EZMacPRO_PacketSent\n");
     fEZMacPRO_PacketSent = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_SENT, attempts);
 }
 #endif
 
@@ -164,16 +176,30 @@ void EZMacPRO_LBTTimeout (void)
 {
 	TRACE("EZMacPRO_LBTTimeout\n");
     fEZMacPRO_LBTTimeout = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_LBT_TIMEOUT, 0);
 }
 #endif
 
 
 #ifdef EXTENDED_PACKET_FORMAT
 #ifdef TRANSCEIVER_OPERATION
-void EZMacPRO_AckTimeout (void)
+void EZMacPRO_AckTimeout (U8 attempts)
 {
 	TRACE("EZMacPRO_AckTimeout\n");
     fEZMacPRO_AckTimeout = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_ACK_TIMEOUT, attempts);
+}
+#endif
+#endif
+
+
+#ifdef EXTENDED_PACKET_FORMAT
+#ifdef TRANSCEIVER_OPERATION
+void EZMacPRO_BulkReceived (void)
+{
+	TRACE("EZMacPRO_BulkReceived\n");
+    fEZMacPRO_BulkReceived = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_BULK_RECEIVED, 0);
 }
 #endif
 #endif
@@ -182,6 +208,7 @@ void EZMacPRO_AckTimeout (void)
 void EZMacPRO_CRCError(void)
 {
     fEZMacPRO_CRCError = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_CRC_ERROR, 0);
 }
 
 
@@ -192,6 +219,7 @@ void EZMacPRO_AckSending(void)
     U8 BUFFER_MSPACE i;
 
     fEZMacPRO_AckSending = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_ACK_SENDING, 0);
     //example: RSSI is sent back in Ack payload
     i = EZMacProRSSIvalue;
     EZMacPRO_Ack_Write(1,&i);
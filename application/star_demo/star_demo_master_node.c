@@ -16,6 +16,9 @@
  * \n the Master. LED1 shows the power state of the radio. Off means the radio
  * \n is in Sleep state.
  *
+ * \n The associated Slaves are saved in the flash, after a reset the Master
+ * \n restores them and queries them in the first cycle.
+ *
  *
  * \n This software must be used in accordance with the End User License
  * \n Agreement.
@@ -52,10 +55,75 @@ volatile SEGMENT_VARIABLE(DEMO_SR,	U8,			APPLICATION_MSPACE);
 	SEGMENT_VARIABLE(printBuf[40], U8, APPLICATION_MSPACE);
 #endif
 
+/*!
+ * Protothread of the running demo phase and the flags of the time frames.
+ */
+static SEGMENT_VARIABLE(ptPhase,			EZMacProPt,	APPLICATION_MSPACE);
+static SEGMENT_VARIABLE(fTimeFrameOver,		U8,			APPLICATION_MSPACE);
+static SEGMENT_VARIABLE(timeFrameLftmr2,	U8,			APPLICATION_MSPACE);
+static SEGMENT_VARIABLE(fSlaveAnswered,		U8,			APPLICATION_MSPACE);
+
 /* ======================================= *
  *		L O C A L	F U N C T I O N S		*
  * ======================================= */
 
+/*!
+ * Configure and start the LFT for a time frame. MasterNodeTimeFrame() sets
+ * fTimeFrameOver when it expires.
+ */
+static void MasterTimeFrameStart(U8 lftmr0, U8 lftmr1, U8 lftmr2)
+{
+	fTimeFrameOver = 0;
+	timeFrameLftmr2 = lftmr2;
+	EZMacPRO_Reg_Write(LFTMR0, lftmr0);
+	EZMacPRO_Reg_Write(LFTMR1, lftmr1);
+	EZMacPRO_Reg_Write(LFTMR2, 0x80 | lftmr2);
+}
+
+#ifdef FLASH_ENABLED
+/*!
+ * Save the association and the address of the Slaves to the flash. The record
+ * is only written if an association changed.
+ */
+static void MasterSaveAssocTable(void)
+{
+	SEGMENT_VARIABLE(table[MAX_NMBR_OF_SLAVES], AssocEntry_t, APPLICATION_MSPACE);
+	U8 cnt;
+
+	for (cnt = 0; cnt < MAX_NMBR_OF_SLAVES; cnt++)
+	{
+		table[cnt].associated = SlaveInfoTable[cnt].associated;
+		table[cnt].address = SlaveInfoTable[cnt].address;
+	}
+	EZMacPRO_Nvm_Write(NVM_KEY_MASTER_ASSOC_TABLE, (U8 *)table, sizeof(table));
+}
+
+/*!
+ * Restore the associated Slaves from the flash.
+ */
+static void MasterRestoreAssocTable(void)
+{
+	SEGMENT_VARIABLE(table[MAX_NMBR_OF_SLAVES], AssocEntry_t, APPLICATION_MSPACE);
+	U8 cnt;
+
+	if (EZMacPRO_Nvm_Read(NVM_KEY_MASTER_ASSOC_TABLE, (U8 *)table, sizeof(table)) != sizeof(table))
+		return;
+
+	for (cnt = 0; cnt < MAX_NMBR_OF_SLAVES; cnt++)
+	{
+		if (table[cnt].associated != ASSOCIATED)
+			continue;
+		SlaveInfoTable[cnt].associated = ASSOCIATED;
+		SlaveInfoTable[cnt].address = table[cnt].address;
+#ifdef __CC_ARM
+		TRACE("[DEMO_BOOT] Slave association restored: %02u.\n", table[cnt].address.sfid);
+#else
+		TRACE("[DEMO_BOOT] Slave association restored: %02bu.\n", table[cnt].address.sfid);
+#endif
+	}
+}
+#endif //FLASH_ENABLED
+
 /*!
  * Entry point to the state machine.
  */
@@ -63,319 +131,280 @@ void StateMachine_Init(void)
 {
 	DISABLE_WATCHDOG();
 	DEMO_SR = DEMO_BOOT_INIT;
+
+	EZMacPRO_Task_Init();
+	// The time frame task runs first, the others see fTimeFrameOver in the same round.
+	EZMacPRO_Task_Add(MasterNodeTimeFrame);
+	EZMacPRO_Task_Add(MasterNodeMonitor);
+	EZMacPRO_Task_Add(MasterNodeTask);
 }
 
 /*!
- * This is the State Machine of the Demo Application.
+ * This is the State Machine of the Demo Application. The tasks sleep in the
+ * scheduler until the next EZMacPRO event.
  */
 void StateMachine(void)
 {
-	switch (DEMO_SR & DEMO_STATE_MASK)
+	EZMacPRO_Task_Schedule();
+}
+
+/*!
+ * Time frame task. Ends the running time frame when the LFT expires.
+ */
+U8 MasterNodeTimeFrame(EZMacProPt *pt)
+{
+	PT_BEGIN(pt);
+
+	while (1)
 	{
-		case DEMO_BOOT:
-			BoardInit();				// Initialise board.
-			MasterNodeBoot();			// Boot Master Node.
-			break;
+		PT_WAIT_EVENT(pt, EZMAC_EVENT_LF_TIMER_EXPIRED);
+		EZMacPRO_Reg_Write(LFTMR2, ~0x80 & timeFrameLftmr2);	// Disable LFT.
+		fTimeFrameOver = 1;
+	}
 
-		case DEMO_ASSOC:
-			MasterNodeAssociate();		// Associate slaves.
-			break;
+	PT_END(pt);
+}
 
-		case DEMO_SU:
-			MasterNodeStatusUpdate();	// Get status updates from slaves.
-			break;
+/*!
+ * Monitor task. Reports the low battery events independently of the demo phases.
+ */
+U8 MasterNodeMonitor(EZMacProPt *pt)
+{
+	PT_BEGIN(pt);
 
-		case DEMO_SLEEP:
-			MasterNodeSleep();			// Sleep between cycles.
-			break;
+	while (1)
+	{
+		PT_WAIT_EVENT(pt, EZMAC_EVENT_LOW_BATTERY);
+		TRACE("[DEMO] Low battery.\n");
 	}
+
+	PT_END(pt);
 }
 
 /*!
- * Boot Master Node.
+ * Master Node task. Boots the node, then runs the association, status update
+ * and sleep phases in a loop.
  */
-void MasterNodeBoot(void)
+U8 MasterNodeTask(EZMacProPt *pt)
 {
-	switch (DEMO_SR)
+	PT_BEGIN(pt);
+
+	PT_SPAWN(pt, &ptPhase, MasterNodeBoot(&ptPhase));		// Boot Master Node.
+
+	while (1)
 	{
-		case DEMO_BOOT_INIT:
-			ENABLE_GLOBAL_INTERRUPTS();					// Enable global interrupts.
-			EZMacPRO_Init();							// Initialise EZMacPRO.
+		PT_SPAWN(pt, &ptPhase, MasterNodeAssociate(&ptPhase));	// Associate slaves.
+		PT_SPAWN(pt, &ptPhase, MasterNodeStatusUpdate(&ptPhase));	// Get status updates from slaves.
+		PT_SPAWN(pt, &ptPhase, MasterNodeSleep(&ptPhase));		// Sleep between cycles.
+	}
+
+	PT_END(pt);
+}
+
+/*!
+ * Boot Master Node.
+ */
+U8 MasterNodeBoot(EZMacProPt *pt)
+{
+	PT_BEGIN(pt);
+
+	BoardInit();								// Initialise board.
+	ENABLE_GLOBAL_INTERRUPTS();					// Enable global interrupts.
+	EZMacPRO_Init();							// Initialise EZMacPRO.
 #ifdef WIFI_ROUTE
-			WiFi_Init();
+	WiFi_Init();
+#endif
+	PT_WAIT_EVENT(pt, EZMAC_EVENT_STATE_SLEEP);	// Wait until device goes to Sleep.
+
+	// Configure and start 2sec timeout for Silabs splash screen.
+	MasterTimeFrameStart(LFTMR0_TIMEOUT_SEC(STARTUP_TIMEOUT),
+						 LFTMR1_TIMEOUT_SEC(STARTUP_TIMEOUT),
+						 LFTMR2_TIMEOUT_SEC(STARTUP_TIMEOUT));
+
+	PERFORM_MENU(sMenu_StartupScreen);			// Show Silabs logo, demo name & version.
+
+	PT_WAIT_UNTIL(pt, fTimeFrameOver);			// Wait here until LFT expires.
+												// Star demo Master node initialisation.
+	EZMacPRO_Reg_Write(MCR, 0xAC);				// CIDE=1, DR=9.6kbps, RAD=1, DNPL=1, NFR=0
+	EZMacPRO_Reg_Write(SECR, 0x60);				// State after receive is RX state and state after transmit is Idle state
+	EZMacPRO_Reg_Write(RCR, 0x00);				// Search disable
+	EZMacPRO_Reg_Write(FR0, 0);					// Set the used frequency channel
+	EZMacPRO_Reg_Write(TCR, (0x70 | LBT_SWITCH)); // LBT enabled/disabled, Output power: +20 dBm, ACK disable, AFC disable
+	EZMacPRO_Reg_Write(LBTLR, 0x78);			// RSSI threshold -60 dB
+	EZMacPRO_Reg_Write(LBTIR, 0x8A);			// Time interval
+	EZMacPRO_Reg_Write(LBDR, 0x80);				// Enable Low Battery Detect
+	EZMacPRO_Reg_Write(PFCR, 0x28);				// Destination address filter is enabled
+	EZMacPRO_Reg_Write(SCID, DEMO_MASTER_CID);	// Set customer ID
+	EZMacPRO_Reg_Write(SFID, DEMO_MASTER_SFID); // Set self ID
+
+	for (nodeCnt = 0; nodeCnt < MAX_NMBR_OF_SLAVES; nodeCnt++)
+	{	// Init slave info table.
+		SlaveInfoTable[nodeCnt].associated = NOT_ASSOCIATED;
+		SlaveInfoTable[nodeCnt].address.cid = DEMO_MASTER_CID;
+		SlaveInfoTable[nodeCnt].address.sfid = nodeCnt + 1;
+		SlaveInfoTable[nodeCnt].timeout = TIMEOUT_INITIAL_VALUE;
+		SlaveInfoTable[nodeCnt].temperature = TEMP_INVALID_VALUE;
+		SlaveInfoTable[nodeCnt].voltage = VOLTAGE_INVALID_VALUE;
+		SlaveInfoTable[nodeCnt].rssi = RSSI_INITIAL_VALUE;
+	}
+#ifdef FLASH_ENABLED
+	MasterRestoreAssocTable();					// Slaves associated before the reset.
 #endif
-			WAIT_FLAG_TRUE(fEZMacPRO_StateSleepEntered);// Wait until device goes to Sleep.
-			fEZMacPRO_StateWakeUpEntered = 0;			// Clear State transition flags.
-
-			// Configure and start 2sec timeout for Silabs splash screen.
-			EZMacPRO_Reg_Write(LFTMR0, LFTMR0_TIMEOUT_SEC(STARTUP_TIMEOUT));
-			EZMacPRO_Reg_Write(LFTMR1, LFTMR1_TIMEOUT_SEC(STARTUP_TIMEOUT));
-			EZMacPRO_Reg_Write(LFTMR2, 0x80 | LFTMR2_TIMEOUT_SEC(STARTUP_TIMEOUT));
-
-			PERFORM_MENU(sMenu_StartupScreen);			// Show Silabs logo, demo name & version.
-
-			WAIT_FLAG_TRUE(fEZMacPRO_LFTimerExpired);	// Wait here until LFT expires.
-														// Disable LFT.
-			EZMacPRO_Reg_Write(LFTMR2, ~0x80 & LFTMR2_TIMEOUT_SEC(STARTUP_TIMEOUT));
-														// Star demo Master node initialisation.
-			EZMacPRO_Reg_Write(MCR, 0xAC);				// CIDE=1, DR=9.6kbps, RAD=1, DNPL=1, NFR=0
-			EZMacPRO_Reg_Write(SECR, 0x60);				// State after receive is RX state and state after transmit is Idle state
-			EZMacPRO_Reg_Write(RCR, 0x00);				// Search disable
-			EZMacPRO_Reg_Write(FR0, 0);					// Set the used frequency channel
-			EZMacPRO_Reg_Write(TCR, (0x70 | LBT_SWITCH)); // LBT enabled/disabled, Output power: +20 dBm, ACK disable, AFC disable
-			EZMacPRO_Reg_Write(LBTLR, 0x78);			// RSSI threshold -60 dB
-			EZMacPRO_Reg_Write(LBTIR, 0x8A);			// Time interval
-			EZMacPRO_Reg_Write(LBDR, 0x80);				// Enable Low Battery Detect
-			EZMacPRO_Reg_Write(PFCR, 0x28);				// Destination address filter is enabled
-			EZMacPRO_Reg_Write(SCID, DEMO_MASTER_CID);	// Set customer ID
-			EZMacPRO_Reg_Write(SFID, DEMO_MASTER_SFID); // Set self ID
-
-			for (nodeCnt = 0; nodeCnt < MAX_NMBR_OF_SLAVES; nodeCnt++)
-			{	// Init slave info table.
-				SlaveInfoTable[nodeCnt].associated = NOT_ASSOCIATED;
-				SlaveInfoTable[nodeCnt].address.cid = DEMO_MASTER_CID;
-				SlaveInfoTable[nodeCnt].address.sfid = nodeCnt + 1;
-				SlaveInfoTable[nodeCnt].timeout = TIMEOUT_INITIAL_VALUE;
-				SlaveInfoTable[nodeCnt].temperature = TEMP_INVALID_VALUE;
-				SlaveInfoTable[nodeCnt].voltage = VOLTAGE_INVALID_VALUE;
-				SlaveInfoTable[nodeCnt].rssi = RSSI_INITIAL_VALUE;
-			}
 
-			PERFORM_MENU(sMenu_MainScreen);				// Show main screen.
-			TRACE("[DEMO_BOOT] Master startup done.\n");
+	PERFORM_MENU(sMenu_MainScreen);				// Show main screen.
+	TRACE("[DEMO_BOOT] Master startup done.\n");
 
-			EZMacPRO_Wake_Up();							// Wake up from Sleep mode.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-			fEZMacPRO_StateWakeUpEntered = 0;			// Clear State transition flags.
-			DEMO_SR = DEMO_ASSOC_BEACON_TX;				// Go to next state.
-			break;
-	}
+	EZMacPRO_Wake_Up_Async(NULL);				// Wake up from Sleep mode.
+	PT_WAIT_ASYNC(pt);							// Wait until device goes to Idle.
+	DEMO_SR = DEMO_ASSOC_BEACON_TX;				// Go to next phase.
+
+	PT_END(pt);
 }
 
 
 /*!
  * Associate slaves.
  */
-void MasterNodeAssociate(void)
+U8 MasterNodeAssociate(EZMacProPt *pt)
 {
-	/* LFT expired. Go to Status Update state. */
-	if (fEZMacPRO_LFTimerExpired)
-	{
-										// Disable LFT
-		EZMacPRO_Reg_Write(LFTMR2, ~0x80 & LFTMR2_TIMEOUT_MSEC(TIMEFRAME_ASSOC));
-		fEZMacPRO_LFTimerExpired = 0;	// Clear flag
+	PT_BEGIN(pt);
 
-		EZMacPRO_Idle();				// Go to Idle state.
+	/* Configure and start 200msec timeout for Beacon time frame. */
+	MasterTimeFrameStart(LFTMR0_TIMEOUT_MSEC(TIMEFRAME_ASSOC),
+						 LFTMR1_TIMEOUT_MSEC(TIMEFRAME_ASSOC),
+						 LFTMR2_TIMEOUT_MSEC(TIMEFRAME_ASSOC));
+	LED1_ON();		// LED1 indicates the radio is ON
 
-		PERFORM_MENU(sMenu_StatusUpdate_State);		// Display Status Update state on LCD.
+	/* Display Associate state on LCD. */
+	PERFORM_MENU(sMenu_Associate_State);
+	TRACE("[DEMO_ASSOC] Search for slaves to associate with.\n");
 
-		WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
+	// Configure Beacon Frame.
+	EZMacPRO_Reg_Write(TCR, (0x70 | LBT_SWITCH));	// LBT enabled/disabled, Output power: +20 dBm, ACK disable, AFC disable
+	EZMacPRO_Reg_Write(DID, DEMO_MASTER_MCAST);		// Set Destination ID
 
-		TRACE("[DEMO_ASSOC] Search ended.\n");
-		TRACE("[DEMO_SU] Start to query slaves.\n");
+	rfPayload.frameUnion.beacon.type = FRAME_BEACON;// Assemble beacon frame
+	// Write the packet length and payload to the TX buffer
+	EZMacPRO_TxBuf_Write(sizeof(FrameBeacon_t), &rfPayload.frameRaw[0]);
+	EZMacPRO_Transmit_Async(NULL);					// Send the packet
+	PT_WAIT_ASYNC(pt);								// Wait until the packet is sent.
 
-		nodeCnt = 0;				// Reset node counter.
-		DEMO_SR = DEMO_SU_REQ_TX;	// Go ahead and request status updates.
-		return;
-	}
-
-	switch(DEMO_SR)
+	while (!fTimeFrameOver)
 	{
-		case DEMO_ASSOC_BEACON_TX:
-			/* Configure and start 200msec timeout for Beacon time frame. */
-			EZMacPRO_Reg_Write(LFTMR0, LFTMR0_TIMEOUT_MSEC(TIMEFRAME_ASSOC));
-			EZMacPRO_Reg_Write(LFTMR1, LFTMR1_TIMEOUT_MSEC(TIMEFRAME_ASSOC));
-			EZMacPRO_Reg_Write(LFTMR2, 0x80 | LFTMR2_TIMEOUT_MSEC(TIMEFRAME_ASSOC));
-			LED1_ON();		// LED1 indicates the radio is ON
-
-			/* Display Associate state on LCD. */
-			PERFORM_MENU(sMenu_Associate_State);
-			TRACE("[DEMO_ASSOC] Search for slaves to associate with.\n");
-
-			// Configure Beacon Frame.
-			EZMacPRO_Reg_Write(TCR, (0x70 | LBT_SWITCH));	// LBT enabled/disabled, Output power: +20 dBm, ACK disable, AFC disable
-			EZMacPRO_Reg_Write(DID, DEMO_MASTER_MCAST);		// Set Destination ID
-			
-			rfPayload.frameUnion.beacon.type = FRAME_BEACON;// Assemble beacon frame
-			// Write the packet length and payload to the TX buffer
-			EZMacPRO_TxBuf_Write(sizeof(FrameBeacon_t), &rfPayload.frameRaw[0]);
-			EZMacPRO_Transmit();							// Send the packet
-
-			WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);		// Wait until device goes to Idle.
-
-			DEMO_SR = DEMO_ASSOC_REQ_RX;					// Go to next state.
-			break;
-
-		case DEMO_ASSOC_REQ_RX:
-			EZMacPRO_Receive();								// Go to receive state.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateRxEntered);		// Wait until radio is placed to RX.
-			DEMO_SR = DEMO_ASSOC_REQ_RXD;					// Go to next state.
-			break;
-
-		case DEMO_ASSOC_REQ_RXD:
-			 if (fEZMacPRO_PacketReceived)
-			 {
-				 fEZMacPRO_PacketReceived = 0;
-				 // Free slot in association table. Check message type.
-				 if ((nodeCnt = SearchFreeSlotInAssocTable()) != ASSOC_TABLE_FULL)
-				 {	// Read out the payload.
-					 EZMacPRO_RxBuf_Read(&packetLength, &rfPayload.frameRaw[0]);
-					 // Message is association request.
-					 if (rfPayload.frameUnion.assocReq.type == FRAME_ASSOC_REQ)
-					 {
-						 EZMacPRO_Reg_Read(RCID, &slaveAddr.cid);		// Save address of the slave.
-						 EZMacPRO_Reg_Read(RSID, &slaveAddr.sfid);
-						 DEMO_SR = DEMO_ASSOC_RESP_TX;					// Go to next state.
-					 }
-				 }
-			 }
-			 break;
-
-		case DEMO_ASSOC_RESP_TX:
-			EZMacPRO_Idle();							// Go to Idle state to read Beacon frame response.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-
-			EZMacPRO_Reg_Write(DID, slaveAddr.sfid);	// Send Association response with new address of the node.
-														// Assemble Association response frame.
-			rfPayload.frameUnion.assocResp.type = FRAME_ASSOC_RESP;
-			rfPayload.frameUnion.assocResp.newAddr.cid = SlaveInfoTable[nodeCnt].address.cid;
-			rfPayload.frameUnion.assocResp.newAddr.sfid = SlaveInfoTable[nodeCnt].address.sfid;
-														// Write the packet length and payload to the TX buffer.
-			EZMacPRO_TxBuf_Write(sizeof(FrameAssocResp_t), &rfPayload.frameRaw[0]);
-			EZMacPRO_Transmit();						// Send the packet.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-			DEMO_SR = DEMO_ASSOC_RESP_ACK_RX;			// Go to next state.
+		DEMO_SR = DEMO_ASSOC_REQ_RXD;
+		EZMacPRO_Receive_Async(NULL);				// Go to receive state.
+		PT_WAIT_UNTIL(pt, !EZMacPRO_Async_Busy() || fTimeFrameOver);
+		if (fTimeFrameOver)
 			break;
 
-		case DEMO_ASSOC_RESP_ACK_RX:
-			EZMacPRO_Receive();							// Go to receive state.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateRxEntered);	// Wait until radio is placed to RX.
-			DEMO_SR = DEMO_ASSOC_RESP_ACK_RXD;			// Go to next state.
+		// Free slot in association table. Check message type.
+		if ((nodeCnt = SearchFreeSlotInAssocTable()) == ASSOC_TABLE_FULL)
+			continue;
+		// Read out the payload.
+		EZMacPRO_RxBuf_Read(&packetLength, &rfPayload.frameRaw[0]);
+		// Message is association request.
+		if (rfPayload.frameUnion.assocReq.type != FRAME_ASSOC_REQ)
+			continue;
+		EZMacPRO_Reg_Read(RCID, &slaveAddr.cid);	// Save address of the slave.
+		EZMacPRO_Reg_Read(RSID, &slaveAddr.sfid);
+
+		DEMO_SR = DEMO_ASSOC_RESP_TX;
+		EZMacPRO_Idle_Async(NULL);					// Go to Idle state to read Beacon frame response.
+		PT_WAIT_ASYNC(pt);							// Wait until device goes to Idle.
+
+		EZMacPRO_Reg_Write(DID, slaveAddr.sfid);	// Send Association response with new address of the node.
+													// Assemble Association response frame.
+		rfPayload.frameUnion.assocResp.type = FRAME_ASSOC_RESP;
+		rfPayload.frameUnion.assocResp.newAddr.cid = SlaveInfoTable[nodeCnt].address.cid;
+		rfPayload.frameUnion.assocResp.newAddr.sfid = SlaveInfoTable[nodeCnt].address.sfid;
+													// Write the packet length and payload to the TX buffer.
+		EZMacPRO_TxBuf_Write(sizeof(FrameAssocResp_t), &rfPayload.frameRaw[0]);
+		EZMacPRO_Transmit_Async(NULL);				// Send the packet.
+		PT_WAIT_ASYNC(pt);							// Wait until the packet is sent.
+
+		DEMO_SR = DEMO_ASSOC_RESP_ACK_RXD;
+		EZMacPRO_Receive_Async(NULL);				// Go to receive state.
+		PT_WAIT_UNTIL(pt, !EZMacPRO_Async_Busy() || fTimeFrameOver);
+		if (fTimeFrameOver)
 			break;
 
-		case DEMO_ASSOC_RESP_ACK_RXD:
-			if (fEZMacPRO_PacketReceived)
+		EZMacPRO_RxBuf_Read(&packetLength, &rfPayload.frameRaw[0]);	// Read out the payload of the acknowledgement.
+		// Message is the acknowledgement of association response.
+		if (rfPayload.frameUnion.assocRespAck.type == FRAME_ASSOC_RESP_ACK)
+		{	// From the right node.
+			if (memcmp(&rfPayload.frameUnion.assocRespAck.rndAddr, &slaveAddr, sizeof(Addr_t)) == 0)
 			{
-				fEZMacPRO_PacketReceived = 0;
-				EZMacPRO_RxBuf_Read(&packetLength, &rfPayload.frameRaw[0]);	// Read out the payload of the acknowledgement.
-				// Message is the acknowledgement of association response.
-				if (rfPayload.frameUnion.assocRespAck.type == FRAME_ASSOC_RESP_ACK)
-				{	// From the right node.
-					if (memcmp(&rfPayload.frameUnion.assocRespAck.rndAddr, &slaveAddr, sizeof(Addr_t)) == 0)
-					{
-						SlaveInfoTable[nodeCnt].associated = ASSOCIATED;	// Set flag.
+				SlaveInfoTable[nodeCnt].associated = ASSOCIATED;	// Set flag.
 #ifdef __CC_ARM
-						TRACE("[DEMO_ASSOC] Slave associated with address: %02u.\n", SlaveInfoTable[nodeCnt].address.sfid);
+				TRACE("[DEMO_ASSOC] Slave associated with address: %02u.\n", SlaveInfoTable[nodeCnt].address.sfid);
 #else
-						TRACE("[DEMO_ASSOC] Slave associated with address: %02bu.\n", SlaveInfoTable[nodeCnt].address.sfid);
+				TRACE("[DEMO_ASSOC] Slave associated with address: %02bu.\n", SlaveInfoTable[nodeCnt].address.sfid);
 #endif
-					}
-				}
-				EZMacPRO_Idle();							// Go to Idle state.
-				WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-				DEMO_SR = DEMO_ASSOC_REQ_RX;				// Go to next state.
 			}
-			break;
+		}
+		EZMacPRO_Idle_Async(NULL);					// Go to Idle state.
+		PT_WAIT_ASYNC(pt);							// Wait until device goes to Idle.
 	}
+
+	/* LFT expired. Go to Status Update state. */
+	EZMacPRO_Idle_Async(NULL);						// Go to Idle state.
+
+	PERFORM_MENU(sMenu_StatusUpdate_State);			// Display Status Update state on LCD.
+
+	PT_WAIT_ASYNC(pt);								// Wait until device goes to Idle.
+
+	TRACE("[DEMO_ASSOC] Search ended.\n");
+	TRACE("[DEMO_SU] Start to query slaves.\n");
+
+	nodeCnt = 0;				// Reset node counter.
+	DEMO_SR = DEMO_SU_REQ_TX;	// Go ahead and request status updates.
+
+	PT_END(pt);
 }
 
 
 /*!
  * Query slaves.
  */
-void MasterNodeStatusUpdate(void)
+U8 MasterNodeStatusUpdate(EZMacProPt *pt)
 {
-	/* LFT expired. Go to Status Update state. */
-	if (fEZMacPRO_LFTimerExpired)
-	{
-		if (fEZMacPRO_StateSleepEntered)				// Successful Slave query. Master was in Sleep state.
-		{												// Wake up the stack.
-			fEZMacPRO_StateSleepEntered = 0;
-			EZMacPRO_Wake_Up();							// Wake up from Sleep mode.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-			fEZMacPRO_StateWakeUpEntered = 0;			// Clear State transition flags.
-		}
-		else											// Slave query failed. No response from Slave.
-		{
-			EZMacPRO_Idle();							// Go to Idle state.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-			// Decrement timeout value of the node, replace temperature,
-			// supply voltage and rssi values with zero.
-			if (--SlaveInfoTable[nodeCnt].timeout == TIMEOUT_ZERO_VALUE)
-			{	// Timeout. Disassociate Slave.
-				SlaveInfoTable[nodeCnt].associated = NOT_ASSOCIATED;
-				SlaveInfoTable[nodeCnt].timeout = TIMEOUT_INITIAL_VALUE;
-			}
-			SlaveInfoTable[nodeCnt].temperature = TEMP_INVALID_VALUE;
-			SlaveInfoTable[nodeCnt].voltage = VOLTAGE_INVALID_VALUE;
-			SlaveInfoTable[nodeCnt].rssi = RSSI_ZERO_VALUE;
-		}
+	PT_BEGIN(pt);
 
-		LED1_ON();	// LED1 indicates the radio is ON.
-														// Disable LFT.
-		EZMacPRO_Reg_Write(LFTMR2, ~0x80 & LFTMR2_TIMEOUT_MSEC(TIMEFRAME_SU_PER_SLAVE));
-		fEZMacPRO_LFTimerExpired = 0;
-
-		if (++nodeCnt < MAX_NMBR_OF_SLAVES)				// Jump to next node in Slave Info table.
-			DEMO_SR = DEMO_SU_REQ_TX;					// Go ahead and request status update from next node.
-		else
-		{	// Go to Sleep between cycles.
-			TRACE("[DEMO_SU] Slave query ended.\n");
-			DEMO_SR = DEMO_SLEEP_INIT;
-		}
-	}
-
-	switch(DEMO_SR)
+	for (nodeCnt = 0; nodeCnt < MAX_NMBR_OF_SLAVES; nodeCnt++)
 	{
-		case DEMO_SU_REQ_TX:
-			// Configure and start 200msec timeout for Status Update time frame.
-			EZMacPRO_Reg_Write(LFTMR0, LFTMR0_TIMEOUT_MSEC(TIMEFRAME_SU_PER_SLAVE));
-			EZMacPRO_Reg_Write(LFTMR1, LFTMR1_TIMEOUT_MSEC(TIMEFRAME_SU_PER_SLAVE));
-			EZMacPRO_Reg_Write(LFTMR2, 0x80 | LFTMR2_TIMEOUT_MSEC(TIMEFRAME_SU_PER_SLAVE));
-
-			// Associated. Query status.
-			if (SlaveInfoTable[nodeCnt].associated == ASSOCIATED)
-			{											// Set DID of Status Update request frame.
-				EZMacPRO_Reg_Write(DID, SlaveInfoTable[nodeCnt].address.sfid);
-														// Assemble Status Update request frame.
-				rfPayload.frameUnion.statusUpdateReq.type = FRAME_SU_REQ;
-														// Write the packet length and payload to the TX buffer.
-				EZMacPRO_TxBuf_Write(sizeof(FrameStatusUpdateReq_t), &rfPayload.frameRaw[0]);
+		// Configure and start 200msec timeout for Status Update time frame.
+		MasterTimeFrameStart(LFTMR0_TIMEOUT_MSEC(TIMEFRAME_SU_PER_SLAVE),
+							 LFTMR1_TIMEOUT_MSEC(TIMEFRAME_SU_PER_SLAVE),
+							 LFTMR2_TIMEOUT_MSEC(TIMEFRAME_SU_PER_SLAVE));
+		DEMO_SR = DEMO_SU_REQ_TX;
+		fSlaveAnswered = 0;
+
+		// Associated. Query status.
+		if (SlaveInfoTable[nodeCnt].associated == ASSOCIATED)
+		{											// Set DID of Status Update request frame.
+			EZMacPRO_Reg_Write(DID, SlaveInfoTable[nodeCnt].address.sfid);
+													// Assemble Status Update request frame.
+			rfPayload.frameUnion.statusUpdateReq.type = FRAME_SU_REQ;
+													// Write the packet length and payload to the TX buffer.
+			EZMacPRO_TxBuf_Write(sizeof(FrameStatusUpdateReq_t), &rfPayload.frameRaw[0]);
 #ifdef __CC_ARM
-				TRACE("[DEMO_SU] Slave[%02u]: associated. Query slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
+			TRACE("[DEMO_SU] Slave[%02u]: associated. Query slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
 #else
-				TRACE("[DEMO_SU] Slave[%02bu]: associated. Query slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
+			TRACE("[DEMO_SU] Slave[%02bu]: associated. Query slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
 #endif
-				EZMacPRO_Transmit();					// Send the packet.
-				WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-				DEMO_SR = DEMO_SU_RESP_RX;				// Go to wait for status update response.
-			}
-			else										// Not associated.
-			{
-				EZMacPRO_Sleep();						// Go to Sleep state.
-				while (!fEZMacPRO_StateSleepEntered);	// Wait until device goes to Sleep.
-				LED1_OFF();								// LED1 indicates the radio is OFF.
-#ifdef __CC_ARM
-				TRACE("[DEMO_SU] Slave[%02u]: not associated. Skip slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
-#else
-				TRACE("[DEMO_SU] Slave[%02bu]: not associated. Skip slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
-#endif
-				DEMO_SR = DEMO_SU_SLEEP;				// Go to Status Update Sleep state.
-			}
-			break;
+			EZMacPRO_Transmit_Async(NULL);			// Send the packet.
+			PT_WAIT_ASYNC(pt);						// Wait until the packet is sent.
 
-		case DEMO_SU_RESP_RX:
 			TRACE("[DEMO_SU] DEMO_SU_RESP_RX\n");
-			EZMacPRO_Receive();							// Go to receive state.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateRxEntered);	// Wait until radio is placed to RX.
-			DEMO_SR = DEMO_SU_RESP_RXD;					// Go to next state.
-			break;
-
-		case DEMO_SU_RESP_RXD:
-			if (fEZMacPRO_PacketReceived)
+			DEMO_SR = DEMO_SU_RESP_RXD;				// Wait for status update response.
+			while (!fTimeFrameOver && !fSlaveAnswered)
 			{
+				EZMacPRO_Receive_Async(NULL);		// Go to receive state.
+				PT_WAIT_UNTIL(pt, !EZMacPRO_Async_Busy() || fTimeFrameOver);
+				if (fTimeFrameOver)
+					break;
+
 				TRACE("[DEMO_SU] Packet Received\n");
-				fEZMacPRO_PacketReceived = 0;
 				// Read out the payload of the packet.
 				EZMacPRO_RxBuf_Read(&packetLength, &rfPayload.frameRaw[0]);
 				// Frame is status update response.
@@ -389,74 +418,106 @@ void MasterNodeStatusUpdate(void)
 						SlaveInfoTable[nodeCnt].temperature = rfPayload.frameUnion.statusUpdateResp.temperature;
 						SlaveInfoTable[nodeCnt].voltage = rfPayload.frameUnion.statusUpdateResp.voltage;
 						SlaveInfoTable[nodeCnt].rssi = rfPayload.frameUnion.statusUpdateResp.rssi;
-
-						EZMacPRO_Idle();							// Go to Idle state.
-
-						WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-						EZMacPRO_Sleep();							// Go to Sleep state.
-						while (!fEZMacPRO_StateSleepEntered);		// Wait until device goes to Sleep.
-						LED1_OFF();									// LED1 indicates the radio is OFF.
-						DEMO_SR = DEMO_SU_SLEEP;					// Go to sleep state.
-						break;
+						fSlaveAnswered = 1;
 					}
 				}
 			}
-			break;
 
-		case DEMO_SU_SLEEP:
-			// Wait here until current Status Update time slot is over.
-			break;
+			if (fSlaveAnswered)
+			{
+				EZMacPRO_Idle_Async(NULL);			// Go to Idle state.
+				PT_WAIT_ASYNC(pt);					// Wait until device goes to Idle.
+				EZMacPRO_Sleep_Async(NULL);			// Go to Sleep state.
+				PT_WAIT_ASYNC(pt);					// Wait until device goes to Sleep.
+				LED1_OFF();							// LED1 indicates the radio is OFF.
+				DEMO_SR = DEMO_SU_SLEEP;
+			}
+		}
+		else										// Not associated.
+		{
+			EZMacPRO_Sleep_Async(NULL);				// Go to Sleep state.
+			PT_WAIT_ASYNC(pt);						// Wait until device goes to Sleep.
+			LED1_OFF();								// LED1 indicates the radio is OFF.
+#ifdef __CC_ARM
+			TRACE("[DEMO_SU] Slave[%02u]: not associated. Skip slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
+#else
+			TRACE("[DEMO_SU] Slave[%02bu]: not associated. Skip slave.\n", SlaveInfoTable[nodeCnt].address.sfid);
+#endif
+			DEMO_SR = DEMO_SU_SLEEP;				// Go to Status Update Sleep state.
+		}
+
+		// Wait here until current Status Update time slot is over.
+		PT_WAIT_UNTIL(pt, fTimeFrameOver);
+
+		if (EZMacProReg.name.MSR == EZMAC_PRO_SLEEP)	// Successful Slave query. Master was in Sleep state.
+		{												// Wake up the stack.
+			EZMacPRO_Wake_Up_Async(NULL);				// Wake up from Sleep mode.
+			PT_WAIT_ASYNC(pt);							// Wait until device goes to Idle.
+		}
+		else											// Slave query failed. No response from Slave.
+		{
+			EZMacPRO_Idle_Async(NULL);					// Go to Idle state.
+			PT_WAIT_ASYNC(pt);							// Wait until device goes to Idle.
+			// Decrement timeout value of the node, replace temperature,
+			// supply voltage and rssi values with zero.
+			if (--SlaveInfoTable[nodeCnt].timeout == TIMEOUT_ZERO_VALUE)
+			{	// Timeout. Disassociate Slave.
+				SlaveInfoTable[nodeCnt].associated = NOT_ASSOCIATED;
+				SlaveInfoTable[nodeCnt].timeout = TIMEOUT_INITIAL_VALUE;
+			}
+			SlaveInfoTable[nodeCnt].temperature = TEMP_INVALID_VALUE;
+			SlaveInfoTable[nodeCnt].voltage = VOLTAGE_INVALID_VALUE;
+			SlaveInfoTable[nodeCnt].rssi = RSSI_ZERO_VALUE;
+		}
+
+		LED1_ON();	// LED1 indicates the radio is ON.
 	}
+
+	// Go to Sleep between cycles.
+	TRACE("[DEMO_SU] Slave query ended.\n");
+	DEMO_SR = DEMO_SLEEP_INIT;
+
+	PT_END(pt);
 }
 
 
 /*!
  * Sleep between cycles.
  */
-void MasterNodeSleep(void)
+U8 MasterNodeSleep(EZMacProPt *pt)
 {
-	if (fEZMacPRO_LFTimerExpired)					// LFT expired. Go to Status Update state.
-	{												// Disable LFT.
-		EZMacPRO_Reg_Write(LFTMR2, ~0x80 & LFTMR2_TIMEOUT_SEC(TIMEFRAME_SLEEP));
-		fEZMacPRO_LFTimerExpired = 0;
-
-		EZMacPRO_Wake_Up();							// Wake up from Sleep mode.
-
-		WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);	// Wait until device goes to Idle.
-		fEZMacPRO_StateWakeUpEntered = 0;			// Clear State transition flags.
-		TRACE("[DEMO_ASSOC] Master woke up.\n");
-		DEMO_SR = DEMO_ASSOC_BEACON_TX;				// Go ahead and request status updates.
-		return;
-	}
-
-	switch(DEMO_SR)
-	{
-		case DEMO_SLEEP_INIT:
-			EZMacPRO_Sleep();								// Go to Sleep state.
-			WAIT_FLAG_TRUE(fEZMacPRO_StateSleepEntered);	// Wait until device goes to Sleep.
-															// Configure and start inter-cycle timeout.
-			EZMacPRO_Reg_Write(LFTMR0, LFTMR0_TIMEOUT_SEC(TIMEFRAME_SLEEP));
-			EZMacPRO_Reg_Write(LFTMR1, LFTMR1_TIMEOUT_SEC(TIMEFRAME_SLEEP));
-			EZMacPRO_Reg_Write(LFTMR2, 0x80 | LFTMR2_TIMEOUT_SEC(TIMEFRAME_SLEEP));
-			LED1_OFF();										// LED1 indicates the radio is OFF.
-															// Update parameters of Slaves on LCD.
-			PERFORM_MENU(sMenu_RefreshScreen);				// Display Status Update state on UART.
+	PT_BEGIN(pt);
+
+	EZMacPRO_Sleep_Async(NULL);						// Go to Sleep state.
+	PT_WAIT_ASYNC(pt);								// Wait until device goes to Sleep.
+													// Configure and start inter-cycle timeout.
+	MasterTimeFrameStart(LFTMR0_TIMEOUT_SEC(TIMEFRAME_SLEEP),
+						 LFTMR1_TIMEOUT_SEC(TIMEFRAME_SLEEP),
+						 LFTMR2_TIMEOUT_SEC(TIMEFRAME_SLEEP));
+	LED1_OFF();										// LED1 indicates the radio is OFF.
+#ifdef FLASH_ENABLED
+	MasterSaveAssocTable();							// Save the changed associations.
+#endif
+													// Update parameters of Slaves on LCD.
+	PERFORM_MENU(sMenu_RefreshScreen);				// Display Status Update state on UART.
 #ifdef __CC_ARM
-			TRACE("[DEMO_SLEEP] Slave Info Table: %02u\n", SlaveInfoTable[nodeCnt].address.sfid);
+	TRACE("[DEMO_SLEEP] Slave Info Table: %02u\n", SlaveInfoTable[nodeCnt].address.sfid);
 #else
-			TRACE("[DEMO_SLEEP] Slave Info Table: %02bu\n", SlaveInfoTable[nodeCnt].address.sfid);
+	TRACE("[DEMO_SLEEP] Slave Info Table: %02bu\n", SlaveInfoTable[nodeCnt].address.sfid);
 #endif
-			TRACE_SLAVE_INFO();
-			PERFORM_MENU(sMenu_SleepState);					// Display Status Update state on LCD.
-			TRACE("[DEMO_SLEEP] Master went to sleep.\n\n\n");
+	TRACE_SLAVE_INFO();
+	PERFORM_MENU(sMenu_SleepState);					// Display Status Update state on LCD.
+	TRACE("[DEMO_SLEEP] Master went to sleep.\n\n\n");
 
-			DEMO_SR = DEMO_SLEEP_LOOP;						// Go to sleep loop state.
-			break;
+	DEMO_SR = DEMO_SLEEP_LOOP;						// Wait here between cycles.
+	PT_WAIT_UNTIL(pt, fTimeFrameOver);
 
-		case DEMO_SLEEP_LOOP:
-			// Wait here between cycles.
-			break;
-	}
+	EZMacPRO_Wake_Up_Async(NULL);					// Wake up from Sleep mode.
+	PT_WAIT_ASYNC(pt);								// Wait until device goes to Idle.
+	TRACE("[DEMO_ASSOC] Master woke up.\n");
+	DEMO_SR = DEMO_ASSOC_BEACON_TX;					// Go ahead and associate slaves.
+
+	PT_END(pt);
 }
 
 
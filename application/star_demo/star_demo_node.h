@@ -67,6 +67,7 @@
 #define DEMO_ASSOC_RESP_ACK_TX				(0x1A)
 #define DEMO_ASSOC_RESP_ACK_RX				(0x1B)
 #define DEMO_ASSOC_RESP_ACK_RXD			 (0x1C)
+#define DEMO_ASSOC_REQ_BACKOFF				(0x1D)
 #define DEMO_SU							 (0x20)
 #define DEMO_SU_REQ_TX						(0x21)
 #define DEMO_SU_REQ_RX						(0x22)
@@ -75,6 +76,7 @@
 #define DEMO_SU_RESP_RX					 (0x25)
 #define DEMO_SU_RESP_RXD					(0x26)
 #define DEMO_SU_SLEEP						(0x27)
+#define DEMO_SU_ADC_SETTLE					(0x28)
 #define DEMO_SLEEP							(0x30)
 #define DEMO_SLEEP_INIT					 (0x31)
 #define DEMO_SLEEP_LOOP					 (0x32)
@@ -122,6 +124,17 @@
 #define TIMEFRAME_TOTAL					 (TIMEFRAME_ASSOC + \
 											MAX_NMBR_OF_SLAVES * TIMEFRAME_SU_PER_SLAVE + \
 											TIMEFRAME_SLEEP * 1000)
+// a restored Slave associates again if the Master does not query it in this time
+#define TIMEFRAME_RESTORED					(TIMEOUT_INITIAL_VALUE * TIMEFRAME_TOTAL)	// msec
+
+/*!
+ * Keys of the records saved in the flash. The link statistics of the Slave are
+ * saved after every NVM_LINK_SAVE_PERIOD status updates only, to spare the flash.
+ */
+#define NVM_KEY_SLAVE_NETWORK				(1)
+#define NVM_KEY_SLAVE_LINK					(2)
+#define NVM_KEY_MASTER_ASSOC_TABLE			(3)
+#define NVM_LINK_SAVE_PERIOD				(32)
 
 /*!
  * Return value of the SearchFreeSlotInAssocTable() function if the association
@@ -176,6 +189,28 @@ typedef struct
 	U8		rssi;
 } SlaveInfoTable_t;
 
+/*!
+ * Records saved in the flash.
+ */
+typedef struct
+{
+	U8		sfid;			// address assigned by the Master
+	Addr_t	master;
+	U8		channel;
+} SlaveNetwork_t;
+
+typedef struct
+{
+	U16		statusUpdates;
+	U8		rssi;
+} SlaveLink_t;
+
+typedef struct
+{
+	U8		associated;
+	Addr_t	address;
+} AssocEntry_t;
+
 /*!
  * Below are the defined frames of the demo.
  */
@@ -262,10 +297,13 @@ extern volatile SEGMENT_VARIABLE(DEMO_SR, U8, APPLICATION_MSPACE);
 void StateMachine_Init(void);
 void StateMachine(void);
 
-void MasterNodeBoot(void);
-void MasterNodeAssociate(void);
-void MasterNodeStatusUpdate(void);
-void MasterNodeSleep(void);
+U8 MasterNodeTimeFrame(EZMacProPt *pt);
+U8 MasterNodeMonitor(EZMacProPt *pt);
+U8 MasterNodeTask(EZMacProPt *pt);
+U8 MasterNodeBoot(EZMacProPt *pt);
+U8 MasterNodeAssociate(EZMacProPt *pt);
+U8 MasterNodeStatusUpdate(EZMacProPt *pt);
+U8 MasterNodeSleep(EZMacProPt *pt);
 U8 SearchFreeSlotInAssocTable(void);
 void PrintSlaveInfo(void);
 
@@ -274,6 +312,8 @@ void SlaveNodeBeacon(void);
 void SlaveNodeAssociate(void);
 void SlaveNodeStatusUpdate(void);
 void SlaveNodeSleep(void);
+U8 SlaveNodeRestore(void);
+void SlaveNodeForget(void);
 U8 GenTempRndAddr(void);
 
 #endif
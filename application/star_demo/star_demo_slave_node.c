@@ -16,6 +16,10 @@
  * \n the Master. LED1 shows the power state of the radio. Off means the radio
  * \n is in Sleep state.
  *
+ * \n The assigned address, the address of the Master and the channel are saved
+ * \n in the flash after the association. After a reset the Slave restores them
+ * \n and waits for the next Status Update request without association.
+ *
  *
  * \n This software must be used in accordance with the End User License
  * \n Agreement.
@@ -45,6 +49,11 @@ SEGMENT_VARIABLE(rndCounter, U16, APPLICATION_MSPACE);
 SEGMENT_VARIABLE(masterAddr, Addr_t, APPLICATION_MSPACE);
 SEGMENT_VARIABLE(rndAddr, Addr_t, APPLICATION_MSPACE);
 volatile SEGMENT_VARIABLE(DEMO_SR, U8, APPLICATION_MSPACE);
+// random backoff and ADC settling time
+SEGMENT_VARIABLE(slaveTimer, EZMacProTimer, APPLICATION_MSPACE);
+#ifdef FLASH_ENABLED
+SEGMENT_VARIABLE(slaveLink, SlaveLink_t, APPLICATION_MSPACE);
+#endif
 
 
 				/* ======================================= *
@@ -68,6 +77,9 @@ void StateMachine_Init(void)
  */
 void StateMachine(void)
 {
+	/* Expire the software timers. */
+	EZMacPRO_Timer_Process();
+
 	switch (DEMO_SR & DEMO_STATE_MASK)
 	{
 		case DEMO_BOOT:
@@ -129,6 +141,11 @@ void SlaveNodeBoot(void)
 			SlaveInfo.voltage = VOLTAGE_INVALID_VALUE;
 			SlaveInfo.rssi = RSSI_INITIAL_VALUE;
 
+#ifdef FLASH_ENABLED
+			if (SlaveNodeRestore())							// Associated before the reset, skip association
+				break;
+#endif
+
 			TRACE("[DEMO_BOOT] Slave startup done.\n");
 			TRACE("[DEMO_BOOT] Wait for button press...\n\n");
 
@@ -226,7 +243,14 @@ void SlaveNodeAssociate(void)
 																	// Write the packet length and payload to the TX buffer
 			EZMacPRO_TxBuf_Write(sizeof(FrameAssocReq_t), &rfPayload.frameRaw[0]);
 
-			DELAY_uS((rndAddr.sfid%10) * DELAY_1MS_TIMER2);	// Wait random time between 0-10msec
+			// Wait random time between 0-10msec
+			EZMacPRO_Timer_Start(&slaveTimer, TIMER_MS(rndAddr.sfid%10), 0, NULL);
+			DEMO_SR = DEMO_ASSOC_REQ_BACKOFF;
+			break;
+
+		case DEMO_ASSOC_REQ_BACKOFF:
+			if (!slaveTimer.expired)
+				break;
 
 			EZMacPRO_Transmit();				// Send the packet.
 			// Wait until device goes to Idle or LBTTimeout.
@@ -238,7 +262,8 @@ void SlaveNodeAssociate(void)
 			{	
 				fEZMacPRO_LBTTimeout = 0;		// Clear LBT timeout flag.
 				EZMacPRO_Idle();				// Recover from Error state by entering Idle
-				break;							// Stay in this state and wait till timeout.
+				DEMO_SR = DEMO_ASSOC_REQ_TX;	// Send the request again till timeout.
+				break;
 			}
 			DEMO_SR = DEMO_ASSOC_RESP_RX;		// Go to next state.
 			break;
@@ -289,6 +314,21 @@ void SlaveNodeAssociate(void)
 		
 			// Reconfigure PFCR to accept only packets destined to itself.
 			EZMacPRO_Reg_Write(PFCR, 0xA0);				// CID filter and DID filter enabled
+
+#ifdef FLASH_ENABLED
+			{	// Save the association.
+				SEGMENT_VARIABLE(network, SlaveNetwork_t, APPLICATION_MSPACE);
+
+				EZMacPRO_Reg_Read(SFID, &network.sfid);
+				EZMacPRO_Reg_Read(FR0, &network.channel);
+				network.master = masterAddr;
+				EZMacPRO_Nvm_Write(NVM_KEY_SLAVE_NETWORK, (U8 *)&network, sizeof(network));
+				slaveLink.statusUpdates = 0;
+				slaveLink.rssi = SlaveInfo.rssi;
+				EZMacPRO_Nvm_Write(NVM_KEY_SLAVE_LINK, (U8 *)&slaveLink, sizeof(slaveLink));
+				fEZMacPRO_LFTimerExpired = 0;
+			}
+#endif
 		
 #ifdef TRACE_ENABLED
 			EZMacPRO_Reg_Read(SFID, &rndAddr.sfid);		// Temporary reuse of rndAddr variable.
@@ -317,7 +357,14 @@ void SlaveNodeStatusUpdate(void)
 			// Configure ADC for temperature measurement.
 			EZMacPRO_Reg_Write(ADCTSR, 0x80);
 
-			DELAY_uS(DELAY_1MS_TIMER2);
+			// Let the ADC settle.
+			EZMacPRO_Timer_Start(&slaveTimer, TIMER_MS(1), 0, NULL);
+			DEMO_SR = DEMO_SU_ADC_SETTLE;
+			break;
+
+		case DEMO_SU_ADC_SETTLE:
+			if (!slaveTimer.expired)
+				break;
 
 			// Get temperature value
 			EZMacPRO_Reg_Read(ADCTSV, &SlaveInfo.temperature);
@@ -342,6 +389,13 @@ void SlaveNodeStatusUpdate(void)
 			break;
 
 		case DEMO_SU_REQ_RXD:
+#ifdef FLASH_ENABLED
+			if (fEZMacPRO_LFTimerExpired)
+			{	// The restored association is not known by the Master.
+				SlaveNodeForget();
+				break;
+			}
+#endif
 			// Packet received.
 			if (fEZMacPRO_PacketReceived)
 			{
@@ -351,6 +405,11 @@ void SlaveNodeStatusUpdate(void)
 				// Message is Status Update request
 				if(rfPayload.frameUnion.statusUpdateResp.type == FRAME_SU_REQ)
 				{
+#ifdef FLASH_ENABLED
+					// Disable LFT of the restored association.
+					EZMacPRO_Reg_Write(LFTMR2, ~0x80 & LFTMR2_TIMEOUT_MSEC(TIMEFRAME_RESTORED));
+					fEZMacPRO_LFTimerExpired = 0;
+#endif
 					TRACE("[DEMO_SU] Status update request received.\n");
 					// Go ahead and send Status Update response.
 					DEMO_SR = DEMO_SU_RESP_TX;
@@ -389,6 +448,13 @@ void SlaveNodeStatusUpdate(void)
 			EZMacPRO_Reg_Write(LFTMR1, LFTMR1_TIMEOUT_MSEC(TIMEFRAME_TOTAL));
 			EZMacPRO_Reg_Write(LFTMR2, 0x80 | LFTMR2_TIMEOUT_MSEC(TIMEFRAME_TOTAL));
 
+#ifdef FLASH_ENABLED
+			// Save the link statistics now and then.
+			slaveLink.rssi = SlaveInfo.rssi;
+			if ((++slaveLink.statusUpdates % NVM_LINK_SAVE_PERIOD) == 0)
+				EZMacPRO_Nvm_Write(NVM_KEY_SLAVE_LINK, (U8 *)&slaveLink, sizeof(slaveLink));
+#endif
+
 			LED1_OFF();		// LED1 indicates the radio is OFF.
 #ifdef TRACE_ENABLED
 			EZMacPRO_Reg_Read(SFID, &rndAddr.sfid);	// Temporary reuse of rndAddr variable.
@@ -443,14 +509,87 @@ void SlaveNodeSleep(void)
 }
 
 
+#ifdef FLASH_ENABLED
+/*!
+ * Restore the association saved in the flash. The Slave wakes up and waits for
+ * the next Status Update request of the Master. If it does not arrive in
+ * TIMEFRAME_RESTORED, SlaveNodeForget() is called.
+ * Returns 1 if the association is restored.
+ */
+U8 SlaveNodeRestore(void)
+{
+	SEGMENT_VARIABLE(network, SlaveNetwork_t, APPLICATION_MSPACE);
+
+	if (EZMacPRO_Nvm_Read(NVM_KEY_SLAVE_NETWORK, (U8 *)&network, sizeof(network)) != sizeof(network))
+		return 0;
+	if (EZMacPRO_Nvm_Read(NVM_KEY_SLAVE_LINK, (U8 *)&slaveLink, sizeof(slaveLink)) != sizeof(slaveLink))
+	{
+		slaveLink.statusUpdates = 0;
+		slaveLink.rssi = RSSI_INITIAL_VALUE;
+	}
+
+	masterAddr = network.master;
+	SlaveInfo.rssi = slaveLink.rssi;
+	EZMacPRO_Reg_Write(SFID, network.sfid);			// Assigned SFID
+	EZMacPRO_Reg_Write(FR0, network.channel);		// Used frequency channel
+	EZMacPRO_Reg_Write(PFCR, 0xA0);					// CID filter and DID filter enabled
+
+#ifdef __CC_ARM
+	TRACE("[DEMO_BOOT] Association restored. Slave address: %02u.\n", network.sfid);
+#else
+	TRACE("[DEMO_BOOT] Association restored. Slave address: %02bu.\n", network.sfid);
+#endif
+
+	EZMacPRO_Wake_Up();								// Wake up from Sleep mode
+	WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);		// Wait until device goes to Idle
+	fEZMacPRO_StateWakeUpEntered = 0;				// Clear State transition flags
+	LED1_ON();										// LED1 indicates the radio is ON
+
+	// Set the Low Frequency Timer interval and start it.
+	fEZMacPRO_LFTimerExpired = 0;
+	EZMacPRO_Reg_Write(LFTMR0, LFTMR0_TIMEOUT_MSEC(TIMEFRAME_RESTORED));
+	EZMacPRO_Reg_Write(LFTMR1, LFTMR1_TIMEOUT_MSEC(TIMEFRAME_RESTORED));
+	EZMacPRO_Reg_Write(LFTMR2, 0x80 | LFTMR2_TIMEOUT_MSEC(TIMEFRAME_RESTORED));
+
+	DEMO_SR = DEMO_SU_REQ_RX;						// Go ahead and wait for Status Update request
+	return 1;
+}
+
+/*!
+ * Drop the restored association, the Slave has to be associated again.
+ */
+void SlaveNodeForget(void)
+{
+													// Disable LFT.
+	EZMacPRO_Reg_Write(LFTMR2, ~0x80 & LFTMR2_TIMEOUT_MSEC(TIMEFRAME_RESTORED));
+	fEZMacPRO_LFTimerExpired = 0;
+
+	EZMacPRO_Idle();								// Go to Idle state
+	WAIT_FLAG_TRUE(fEZMacPRO_StateIdleEntered);		// Wait until device goes to Idle
+	EZMacPRO_Nvm_Write(NVM_KEY_SLAVE_NETWORK, NULL, 0);
+	EZMacPRO_Reg_Write(PFCR, 0x91);					// CID filter and Mcast addr. filter (MCA mode) are enabled
+	EZMacPRO_Sleep();								// Go to Sleep state
+	WAIT_FLAG_TRUE(fEZMacPRO_StateSleepEntered);	// Wait until device goes to Sleep
+	LED1_OFF();										// LED1 indicates the radio is OFF
+
+	TRACE("[DEMO_SU] Not queried by the Master.\n");
+	TRACE("[DEMO_BOOT] Wait for button press...\n\n");
+
+	DEMO_SR = DEMO_BOOT_RND_ADDR;					// Go back and wait for the button
+}
+#endif //FLASH_ENABLED
+
+
 /*!
  * Generate temporary random SFID for slave for the duration of association.
+ * The random number of the MAC is mixed with the time of the button press, the
+ * slaves started together get different addresses.
  * Note: result will fall in the 0x05-0xFD range. Permanent slave ID domain,
  * multicast and broadcast addresses are reserved.
  */
 U8 GenTempRndAddr(void)
 {
-	return ((rndCounter%(253-MAX_NMBR_OF_SLAVES))+MAX_NMBR_OF_SLAVES+1);
+	return (((EZMacPRO_Random() ^ rndCounter)%(253-MAX_NMBR_OF_SLAVES))+MAX_NMBR_OF_SLAVES+1);
 }
 
 
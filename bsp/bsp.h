@@ -43,6 +43,9 @@
 #ifdef UART0_ENABLED
 	#include "uart.h"
 #endif //UART0_ENABLED
+#ifdef FLASH_ENABLED
+	#include "flash.h"
+#endif //FLASH_ENABLED
 
 
 /*!
@@ -78,5 +81,8 @@
 #endif //SI1010_DAUGHTERCARD_SI1000_MOTHERBOARD
 
 void BoardInit(void);
+#ifdef STM32L1XX_MD
+void BoardStop(void);
+#endif
 
 #endif //_BSP_H_
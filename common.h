@@ -22,6 +22,7 @@
 	#define SPI_ENABLED
 	#define TIMER_ENABLED
 	#define TRACE_ENABLED
+	#define FLASH_ENABLED
 
 #endif //STM32
 
@@ -0,0 +1,98 @@
+#include "bsp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//================================================================================================
+//
+// Flash emulation of the EZMacPro_Nvm module
+//
+//================================================================================================
+//
+// Notes:
+//
+// The whole image is read from the file at the first access, a missing or short file reads as
+// erased flash. Every erase and write is written through to the file and flushed, so a killed
+// process behaves like a reset of the MCU.
+//
+
+static U8 NvmImage[NVM_PAGES * NVM_PAGE_SIZE];
+static FILE * NvmFile = NULL;
+
+static U8 nvmOpen(void)
+{
+	const char * name;
+
+	if (NvmFile != NULL)
+		return 1;
+
+	name = getenv("EZMACPRO_NVM");
+	if (name == NULL)
+		name = NVM_FILE;
+
+	memset(NvmImage, (U8)NVM_ERASED, sizeof(NvmImage));
+	NvmFile = fopen(name, "r+b");
+	if (NvmFile != NULL)
+	{
+		fread(NvmImage, 1, sizeof(NvmImage), NvmFile);
+	}
+	else
+	{
+		NvmFile = fopen(name, "w+b");
+		if (NvmFile == NULL)
+			return 0;
+	}
+	// write back the whole image, a short file is extended with erased pages
+	fseek(NvmFile, 0, SEEK_SET);
+	fwrite(NvmImage, 1, sizeof(NvmImage), NvmFile);
+	fflush(NvmFile);
+	return 1;
+}
+
+static U8 nvmSync(U16 address, U16 size)
+{
+	if (fseek(NvmFile, address, SEEK_SET) != 0)
+		return 0;
+	if (fwrite(&NvmImage[address], 1, size, NvmFile) != size)
+		return 0;
+	return (fflush(NvmFile) == 0) ? 1 : 0;
+}
+
+U32 NvmReadWord(U8 page, U16 offset)
+{
+	U16 address = (U16)page * NVM_PAGE_SIZE + offset;
+
+	if (!nvmOpen() || (page >= NVM_PAGES) || (offset >= NVM_PAGE_SIZE))
+		return NVM_ERASED;
+
+	return (U32)NvmImage[address]
+		| ((U32)NvmImage[address + 1] << 8)
+		| ((U32)NvmImage[address + 2] << 16)
+		| ((U32)NvmImage[address + 3] << 24);
+}
+
+U8 NvmErasePage(U8 page)
+{
+	if (!nvmOpen() || (page >= NVM_PAGES))
+		return 0;
+
+	memset(&NvmImage[(U16)page * NVM_PAGE_SIZE], (U8)NVM_ERASED, NVM_PAGE_SIZE);
+	return nvmSync((U16)page * NVM_PAGE_SIZE, NVM_PAGE_SIZE);
+}
+
+U8 NvmWriteWord(U8 page, U16 offset, U32 data)
+{
+	U16 address = (U16)page * NVM_PAGE_SIZE + offset;
+	U8 i;
+
+	if (!nvmOpen() || (page >= NVM_PAGES) || (offset >= NVM_PAGE_SIZE) || (offset & 3))
+		return 0;
+
+	// programming clears bits only
+	for (i = 0; i < 4; i++)
+		NvmImage[address + i] &= (U8)(data >> (8 * i));
+	if (!nvmSync(address, 4))
+		return 0;
+	return (NvmReadWord(page, offset) == data) ? 1 : 0;
+}
@@ -0,0 +1,20 @@
+#ifndef _FLASH_H_
+#define _FLASH_H_
+
+/*!
+ * Flash emulation of the EZMacPro_Nvm record log.
+ * The pages are kept in a file, NVM_FILE or the file named by the EZMACPRO_NVM environment
+ * variable. It behaves like the STM32F1 flash: an erased word reads 0xFFFFFFFF and programming
+ * can only clear bits.
+ */
+#define NVM_PAGE_SIZE						1024
+#define NVM_PAGES							4
+#define NVM_ERASED							0xFFFFFFFF
+
+#define NVM_FILE							"ezmacpro_nvm.bin"
+
+U32 NvmReadWord(U8 page, U16 offset);
+U8  NvmErasePage(U8 page);
+U8  NvmWriteWord(U8 page, U16 offset, U32 data);
+
+#endif //_FLASH_H_
@@ -243,6 +243,42 @@ SBIT(LED1, SFR_P1, 5);
 #define DISABLE_MAC_EXT_INTERRUPT()     DISABLE_EXT0_INTERRUPT()
 #define CLEAR_MAC_EXT_INTERRUPT()       CLEAR_EXT0_INTERRUPT()
 
+/*!
+ * MAC critical section of an API call.
+ * There is no priority masking, the enables of INT0 (IE.0) and Timer3 (EIE1.7)
+ * are saved and the MAC interrupts are disabled. The sections can be nested.
+ */
+#define MAC_CRITICAL_ENTER(save)        do { \
+                                            (save) = (IE & 0x01) | (EIE1 & 0x80); \
+                                            DISABLE_MAC_INTERRUPTS(); \
+                                        } while (0)
+#define MAC_CRITICAL_EXIT(save)         do { \
+                                            IE |= ((save) & 0x01); \
+                                            EIE1 |= ((save) & 0x80); \
+                                        } while (0)
+
+/*!
+ * Deferred part of the MAC external interrupt.
+ * There is no free software interrupt, it runs at the end of the external
+ * interrupt.
+ */
+#define TRIGGER_MAC_DEFERRED_INTERRUPT()    externalIntDeferredISR()
+
+/*!
+ * Low power and cycle counter macros.
+ * The Idle mode is not entered as it can not be left with EA cleared, and there
+ * is no cycle counter.
+ */
+#define WAIT_FOR_INTERRUPT()
+#define CYCLE_COUNTER()                 0
+#define CYCLE_COUNTER_INIT()
+
+/*!
+ * Unique device ID (part of the random seed).
+ * The MCU has no unique ID, the seed comes from the radio only.
+ */
+#define MCU_UNIQUE_ID(n)                0
+
 #define ENABLE_UART_INTERRUPT()         ENABLE_UART0_INTERRUPT()
 #define SET_UART_INTERRUPT_FLAG()       SET_UART0_INTERRUPT_FLAG()
 #define CLEAR_UART_INTERRUPT_FLAG()     CLEAR_UART0_INTERRUPT_FLAG()
@@ -249,11 +249,12 @@ U8 extIntSpiReadReg (U8 macReg)
 //
 // Notes:
 //    Write FIFO uses Double buffered transfers.
-//    The WriteFIFO function is only included if packet forwarding is defined.
-//    Packet forwarding requires writing the forward packet back to the TX buffer.
+//    The WriteFIFO function is only included if packet forwarding or the extended packet format
+//    is defined. Packet forwarding requires writing the forward packet back to the TX buffer,
+//    the bulk transfer writes the next frame in the interrupt.
 //
 //-----------------------------------------------------------------------------------------------
-#ifdef PACKET_FORWARDING_SUPPORTED
+#if defined(PACKET_FORWARDING_SUPPORTED) || defined(EXTENDED_PACKET_FORMAT)
 void extIntSpiWriteFIFO (U8 n, VARIABLE_SEGMENT_POINTER(buffer, U8, BUFFER_MSPACE))
 {
    NSS = 0;                            // drive NSS low
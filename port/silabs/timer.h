@@ -42,6 +42,18 @@
 #define CLEAR_MAC_TIMER_INTERRUPT()     CLEAR_TIMER3_INTERRUPT()
 #define START_MAC_TIMER()               START_TIMER3()
 #define STOP_MAC_TIMER()                STOP_TIMER3()
+// the upper word of the timeout is counted down on each overflow of the MAC timer
+#define MAC_TIMER_EXPIRED()             \
+    ((EZMacProTimerMSB == 0) || (CLEAR_MAC_TIMER_INTERRUPT(), EZMacProTimerMSB--, 0))
+// there is no free-running MAC clock, the crystal start-up time is not measured
+#define MAC_TIMER_NOW()                 0
+// the times kept by the MAC (link data rate hold) can not be measured, see LACR_RATE
+#define MAC_TIMER_NO_CLOCK
+#define MAC_TIMER_LATENCY()             0
+// the timer wheel has no tick source on this port
+#define TIMER_WHEEL_TICK_START()
+#define TIMER_WHEEL_TICK_STOP()
+#define MAC_TIMER_TICK()                0
 
 #define TIMER_PRESCALER                 TIMER3_PRESCALER
 
@@ -40,6 +40,9 @@ void BoardInit(void)
 	SPI_InitTypeDef   SPI_InitStructure;
 	EXTI_InitTypeDef   EXTI_InitStructure;
 	NVIC_InitTypeDef   NVIC_InitStructure;
+#ifdef FAST_BOOT
+	U32 radioOn;
+#endif
 #ifdef STM32F10X_MD
 	RCC_APB2PeriphClockCmd( 0
 		| RCC_APB2Periph_GPIOA
@@ -52,6 +55,10 @@ void BoardInit(void)
 		| RCC_AHBPeriph_GPIOA
 		| RCC_AHBPeriph_GPIOB
 		, ENABLE);
+	// STOP mode: the internal reference is switched off, the wake-up does not wait for it
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR, ENABLE);
+	PWR_UltraLowPowerCmd(ENABLE);
+	PWR_FastWakeUpCmd(ENABLE);
 #else
 	#error "Unknown CPU type"
 #endif
@@ -64,15 +71,14 @@ void BoardInit(void)
 		| DBGMCU_STANDBY
 		, ENABLE);
 	MAC_TIMER_CLOCK();
-	DELAY_TIMER_CLOCK();
+	MAC_TIMER_HIGH_CLOCK();
 
 	LED1_OFF();
 	LED1_INIT();
 	LED2_OFF();
 	LED2_INIT();
 	
-	TimerInit( MAC_TIMER,   MAC_TIMER_PRESCALER,	MAC_TIMER_IRQn );
-	TimerInit( DELAY_TIMER, DELAY_TIMER_PRESCALER,	0 );
+	TimersInit();
 	
 	RF_SDN_HIGH();
 	RF_SDN_INIT();
@@ -85,7 +91,13 @@ void BoardInit(void)
 
 	DELAY_uS(10 * DELAY_1MS_TIMER2);
 	RF_SDN_LOW();
+	EZMacPRO_Boot_Mark(EZMAC_BOOT_RADIO_ON);
+#ifdef FAST_BOOT
+	// the rest of the MCU is initialized while the radio crystal starts
+	radioOn = MAC_TIMER_NOW();
+#else
 	DELAY_uS(50 * DELAY_1MS_TIMER2);
+#endif
 
 	RF_SPI_CLOCK();
 
@@ -118,19 +130,52 @@ void BoardInit(void)
 	DISABLE_MAC_EXT_INTERRUPT();
 	CLEAR_MAC_EXT_INTERRUPT();
 
-	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_0);
+	NVIC_PriorityGroupConfig(NVIC_PRIORITY_GROUP);
 
 	NVIC_InitStructure.NVIC_IRQChannel = RF_IRQ_EXT_IRQ;
-	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x0;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = MAC_IRQ_PREEMPTION;
 	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x0;
 	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
 	NVIC_Init(&NVIC_InitStructure);
 
+	MAC_DEFERRED_INTERRUPT_INIT();
+
 #ifdef RTC_ENABLED
     RTC_INIT();
 #endif
 #ifdef UART0_ENABLED
 	Uart0Init();
 #endif
+
+#ifdef FAST_BOOT
+	// the POR and chip ready interrupts of the radio are enabled after reset, nIRQ goes low
+	// when the radio is powered up, the fixed delay is the limit
+	while (RF_IRQ_READ() && (MAC_TIMER_NOW() - radioOn) < 50 * DELAY_1MS_TIMER2)
+		;
+#endif
+	EZMacPRO_Boot_Mark(EZMAC_BOOT_BOARD_READY);
 }
 
+
+#ifdef STM32L1XX_MD
+/*!
+ * Enter STOP mode from the idle loop of the stack, called with the interrupts
+ * disabled. The radio interrupt (EXTI) wakes up the MCU, the pending interrupt
+ * runs after the system clock is restored.
+ * The clocks of the timers and of the UART stop, a UART transmission in
+ * progress is finished in Sleep mode first.
+ */
+void BoardStop(void)
+{
+#ifdef UART0_ENABLED
+	if (USART_GetFlagStatus(USART_PORT, USART_FLAG_TC) == RESET)
+	{
+		WAIT_FOR_INTERRUPT();
+		return;
+	}
+#endif
+	PWR_EnterSTOPMode(PWR_Regulator_LowPower, PWR_STOPEntry_WFI);
+	// the MCU runs from the MSI after STOP
+	SystemInit();
+}
+#endif
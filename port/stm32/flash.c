@@ -0,0 +1,66 @@
+#include "bsp.h"
+
+//================================================================================================
+//
+// Flash functions of the EZMacPro_Nvm module
+//
+//================================================================================================
+//
+// Notes:
+//
+// The CPU stalls while the flash is erased or programmed (a page erase takes about 20ms), the
+// interrupts are served after it. The caller has to make sure that nothing is timed meanwhile.
+//
+// The functions return 1 if the operation succeeded and the flash holds the written value.
+//
+
+#ifdef STM32L1XX_MD
+	#define FLASH_FLAG_ERRORS	(FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | FLASH_FLAG_SIZERR | FLASH_FLAG_OPTVERR)
+#else
+	#define FLASH_FLAG_ERRORS	(FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR)
+#endif
+
+U8 NvmErasePage(U8 page)
+{
+	FLASH_Status status;
+	U16 offset;
+
+	if (page >= NVM_PAGES)
+		return 0;
+
+	FLASH_Unlock();
+	FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_ERRORS);
+	status = FLASH_ErasePage(NVM_ADDRESS(page, 0));
+	FLASH_Lock();
+
+	if (status != FLASH_COMPLETE)
+		return 0;
+	for (offset = 0; offset < NVM_PAGE_SIZE; offset += 4)
+		if (NvmReadWord(page, offset) != NVM_ERASED)
+			return 0;
+	return 1;
+}
+
+U8 NvmWriteWord(U8 page, U16 offset, U32 data)
+{
+	FLASH_Status status;
+
+	if ((page >= NVM_PAGES) || (offset >= NVM_PAGE_SIZE) || (offset & 3))
+		return 0;
+	// the erased value is already there, programming it would be an error on the L1
+	if (data == NVM_ERASED)
+		return (NvmReadWord(page, offset) == NVM_ERASED) ? 1 : 0;
+
+	FLASH_Unlock();
+	FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_ERRORS);
+#ifdef STM32L1XX_MD
+	status = FLASH_FastProgramWord(NVM_ADDRESS(page, offset), data);
+#else
+	status = FLASH_ProgramWord(NVM_ADDRESS(page, offset), data);
+#endif
+	FLASH_Lock();
+
+	if (status != FLASH_COMPLETE)
+		return 0;
+	return (NvmReadWord(page, offset) == data) ? 1 : 0;
+}
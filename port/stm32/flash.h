@@ -0,0 +1,28 @@
+#ifndef _FLASH_H_
+#define _FLASH_H_
+
+/*!
+ * Flash pages of the EZMacPro_Nvm record log.
+ * The last 4K of the flash is reserved, the IROM1 region of the targets has to end at NVM_BASE.
+ * The erased flash reads 0xFF on the STM32F1 and 0x00 on the STM32L1.
+ */
+#ifdef STM32L1XX_MD
+	#define NVM_BASE						0x0801F000
+	#define NVM_PAGE_SIZE					256
+	#define NVM_PAGES						16
+	#define NVM_ERASED						0x00000000
+#else
+	#define NVM_BASE						0x0800F000
+	#define NVM_PAGE_SIZE					1024
+	#define NVM_PAGES						4
+	#define NVM_ERASED						0xFFFFFFFF
+#endif
+
+#define NVM_ADDRESS(page, offset)			(NVM_BASE + (U32)(page) * NVM_PAGE_SIZE + (offset))
+
+#define NvmReadWord(page, offset)			(*(__IO U32 *)NVM_ADDRESS((page), (offset)))
+
+U8 NvmErasePage(U8 page);
+U8 NvmWriteWord(U8 page, U16 offset, U32 data);
+
+#endif //_FLASH_H_
@@ -19,16 +19,18 @@
 
 #define SYSCLK_HZ				(72000000L)
 #define MAC_TIMER_PRESCALER		72L
-#define DELAY_TIMER_PRESCALER	72L
 
 #define MAC_TIMER				TIM3
 #define MAC_TIMER_CLOCK()		RCC_APB1PeriphClockCmd( RCC_APB1Periph_TIM3, ENABLE )
 #define MAC_TIMER_IRQn			TIM3_IRQn
 #define timerIntT3_ISR			TIM3_IRQHandler
 
-#define DELAY_TIMER				TIM2
-#define DELAY_TIMER_CLOCK()		RCC_APB1PeriphClockCmd( RCC_APB1Periph_TIM2, ENABLE )
-#define delayIntT2_ISR			TIM2_IRQHandler
+// counts the overflows of MAC_TIMER (TRGO of TIM3 is ITR2 of TIM2)
+#define MAC_TIMER_HIGH			TIM2
+#define MAC_TIMER_HIGH_CLOCK()	RCC_APB1PeriphClockCmd( RCC_APB1Periph_TIM2, ENABLE )
+#define MAC_TIMER_HIGH_IRQn		TIM2_IRQn
+#define MAC_TIMER_HIGH_TRIGGER	TIM_TS_ITR2
+#define macTimerHighISR			TIM2_IRQHandler
 
 #define LED1_PIN			PB12
 #define LED2_PIN			PB11
@@ -87,6 +89,52 @@
 #define ENABLE_GLOBAL_INTERRUPTS()      __enable_irq()
 #define DISABLE_GLOBAL_INTERRUPTS()     __disable_irq()
 
+/*!
+ * Priority-masked MAC critical section.
+ * The MAC external and timer interrupts use preemption priority MAC_IRQ_PREEMPTION, the UART
+ * uses 0, the deferred MAC interrupt (PendSV) the lowest priority. BASEPRI masks the MAC
+ * interrupts and everything below them, the UART (and any other interrupt above the MAC)
+ * stays live. A main thread API call takes one critical section for the whole operation.
+ * The sections can be nested, the inner one does not lower BASEPRI.
+ */
+#define NVIC_PRIORITY_GROUP		NVIC_PriorityGroup_2
+#define MAC_IRQ_PREEMPTION		1
+// NVIC_PriorityGroup_2: the preemption priority is in bits 7:6 of the priority byte
+#define MAC_CRITICAL_BASEPRI	(MAC_IRQ_PREEMPTION << 6)
+
+#ifdef __CC_ARM
+	// the CoreSupport of the STM32F10x library implements __get_BASEPRI() in core_cm3.c
+	static __INLINE uint32_t macGetBasePri(void)
+	{
+		register uint32_t basepri __ASM("basepri");
+		return basepri;
+	}
+	static __INLINE void macSetBasePri(uint32_t value)
+	{
+		register uint32_t basepri __ASM("basepri");
+		basepri = value;
+	}
+#else
+	static __INLINE uint32_t macGetBasePri(void)
+	{
+		uint32_t value;
+		__ASM volatile ("MRS %0, basepri" : "=r" (value));
+		return value;
+	}
+	static __INLINE void macSetBasePri(uint32_t value)
+	{
+		__ASM volatile ("MSR basepri, %0" : : "r" (value) : "memory");
+	}
+#endif
+
+#define MAC_CRITICAL_ENTER(save)			\
+	do {									\
+		(save) = (U8)macGetBasePri();		\
+		if ((save) == 0 || (save) > MAC_CRITICAL_BASEPRI)	\
+			macSetBasePri(MAC_CRITICAL_BASEPRI);			\
+	} while (0)
+#define MAC_CRITICAL_EXIT(save)			macSetBasePri(save)
+
 #define ENABLE_MAC_EXT_INTERRUPT()		EXTI->IMR |=  RF_IRQ_EXT_LINE
 #define CLEAR_MAC_EXT_INTERRUPT()		EXTI->PR   =  RF_IRQ_EXT_LINE
 #define GET_MAC_EXT_INTERRUPT()			((EXTI->IMR & RF_IRQ_EXT_LINE) ? 1 : 0)
@@ -98,9 +146,10 @@
 
 #define DISABLE_MAC_EXT_INTERRUPT()		\
 	do {								\
-		DISABLE_GLOBAL_INTERRUPTS();	\
+		U8 macCritical;					\
+		MAC_CRITICAL_ENTER(macCritical);\
 		DISABLE_MAC_EXT_INTERRUPT_INT();\
-		ENABLE_GLOBAL_INTERRUPTS();		\
+		MAC_CRITICAL_EXIT(macCritical);	\
 	} while (0)
 #define SET_MAC_EXT_INTERRUPT(enable)	\
 	do {								\
@@ -116,12 +165,53 @@
 	} while (0)
 #define DISABLE_MAC_INTERRUPTS()		\
 	do {									\
-		DISABLE_GLOBAL_INTERRUPTS();		\
+		U8 macCritical;						\
+		MAC_CRITICAL_ENTER(macCritical);	\
 		DISABLE_MAC_EXT_INTERRUPT_INT();	\
 		DISABLE_MAC_TIMER_INTERRUPT_INT();	\
-		ENABLE_GLOBAL_INTERRUPTS();			\
+		MAC_CRITICAL_EXIT(macCritical);		\
+	} while (0)
+
+/*!
+ * Deferred part of the MAC external interrupt.
+ * The PendSV gets the lowest priority, so it can be preempted by the MAC interrupts and the
+ * UART.
+ */
+#define MAC_DEFERRED_PRIORITY	0x0F
+#define externalIntDeferredISR	PendSV_Handler
+#define MAC_DEFERRED_INTERRUPT_INIT()	NVIC_SetPriority(PendSV_IRQn, MAC_DEFERRED_PRIORITY)
+#define TRIGGER_MAC_DEFERRED_INTERRUPT()	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk
+
+/*!
+ * Low power and cycle counter macros.
+ * The DWT registers are accessed directly, the CM3 CoreSupport header of the STM32F10x
+ * library does not define them.
+ */
+#define DWT_CONTROL_REG			(*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT_REG			(*(volatile uint32_t *)0xE0001004)
+#define DEMCR_REG				(*(volatile uint32_t *)0xE000EDFC)
+
+#define WAIT_FOR_INTERRUPT()	__WFI()
+#ifdef STM32L1XX_MD
+	// the idle loop of the stack may enter STOP mode, see BoardStop()
+	#define ENTER_STOP_MODE()		BoardStop()
+#endif
+#define CYCLE_COUNTER()			DWT_CYCCNT_REG
+#define CYCLE_COUNTER_INIT()			\
+	do {								\
+		DEMCR_REG |= (1UL << 24);		\
+		DWT_CONTROL_REG |= 1UL;			\
 	} while (0)
 
+/*!
+ * Unique device ID, three words of the 96-bit ID (part of the random seed).
+ */
+#ifdef STM32L1XX_MD
+	#define MCU_UNIQUE_ID(n)		(*(volatile uint32_t *)(0x1FF80050 + ((n) == 2 ? 0x14 : (n) * 4)))
+#else
+	#define MCU_UNIQUE_ID(n)		(*(volatile uint32_t *)(0x1FFFF7E8 + (n) * 4))
+#endif
+
 /*!
  * UART baud rate.
  */
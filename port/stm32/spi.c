@@ -19,14 +19,11 @@ U8 spiWriteReadReg (U8 reg, U8 value)
 
 U8 macSpiWriteReadReg (U8 reg, U8 value)
 {
-	U8 restoreTIM = GET_MAC_TIMER_INTERRUPT();
-	U8 restoreEXT = GET_MAC_EXT_INTERRUPT();
-	DISABLE_MAC_INTERRUPTS();
+	U8 critical;
 
+	MAC_CRITICAL_ENTER(critical);
 	value = spiWriteReadReg(reg, value);
-
-	SET_MAC_TIMER_INTERRUPT(restoreTIM);
-	SET_MAC_EXT_INTERRUPT(restoreEXT);
+	MAC_CRITICAL_EXIT(critical);
 
 	return value;
 }
@@ -44,6 +41,10 @@ U8 macSpiWriteReadReg (U8 reg, U8 value)
 // interrupt INT0 thread, and the T0 interrupt. Since all SPI tranfers are multiple bytes. It is
 // important that MAC interrupts are disabled when using the SPI from the main thread.
 //
+// The API functions hold the MAC critical section (BASEPRI) for the whole operation, the
+// section taken here is nested and costs only the BASEPRI read. The enables of the MAC
+// interrupts are not touched, a call from outside of the API is still protected.
+//
 // These SPI functions may be interrupted by other interrupts, so the double buffered transfers
 // are managed with this in mind.
 //
@@ -61,7 +62,7 @@ U8 macSpiWriteReadReg (U8 reg, U8 value)
 //    				U8 value - value to write to register
 // Notes:
 //
-//    MAC interrupts are preserved and restored.
+//    MAC interrupts are masked by BASEPRI during the transfer.
 //    Write uses a Double buffered transfer.
 //-----------------------------------------------------------------------------------------------
 void macSpiWriteReg (U8 reg, U8 value)
@@ -93,10 +94,9 @@ U8 macSpiReadReg (U8 reg)
 //-----------------------------------------------------------------------------------------------
 void macSpiWriteFIFO (U8 n, VARIABLE_SEGMENT_POINTER(buffer, U8, BUFFER_MSPACE))
 {
-	U8 restoreTIM = GET_MAC_TIMER_INTERRUPT();
-	U8 restoreEXT = GET_MAC_EXT_INTERRUPT();
-	DISABLE_MAC_INTERRUPTS();
+	U8 critical;
 
+	MAC_CRITICAL_ENTER(critical);
 	RF_NSS_LOW();
 	SPI_WAIT_TX_READY();
 	SPI_WRITE(0x80 | SI4432_FIFO_ACCESS);
@@ -107,9 +107,7 @@ void macSpiWriteFIFO (U8 n, VARIABLE_SEGMENT_POINTER(buffer, U8, BUFFER_MSPACE))
 	}
 	SPI_WAIT_BUSY();
 	RF_NSS_HIGH();
-
-	SET_MAC_TIMER_INTERRUPT(restoreTIM);
-	SET_MAC_EXT_INTERRUPT(restoreEXT);
+	MAC_CRITICAL_EXIT(critical);
 }
 
 //================================================================================================
@@ -185,11 +183,12 @@ U8 extIntSpiReadReg   (U8 reg)
 //
 // Notes:
 //    Write FIFO uses Double buffered transfers.
-//    The WriteFIFO function is only included if packet forwarding is defined.
-//    Packet forwarding requires writing the forward packet back to the TX buffer.
+//    The WriteFIFO function is only included if packet forwarding or the extended packet format
+//    is defined. Packet forwarding requires writing the forward packet back to the TX buffer,
+//    the bulk transfer writes the next frame in the interrupt.
 //
 //-----------------------------------------------------------------------------------------------
-#ifdef PACKET_FORWARDING_SUPPORTED
+#if defined(PACKET_FORWARDING_SUPPORTED) || defined(EXTENDED_PACKET_FORMAT)
 void extIntSpiWriteFIFO (U8 n, VARIABLE_SEGMENT_POINTER(buffer, U8, BUFFER_MSPACE))
 {
 	RF_NSS_LOW();
@@ -46,7 +46,7 @@
 //#include "stm32l1xx_iwdg.h"
 //#include "stm32l1xx_lcd.h"
 //#include "stm32l1xx_opamp.h"
-//#include "stm32l1xx_pwr.h"
+#include "stm32l1xx_pwr.h"
 #include "stm32l1xx_rcc.h"
 //#include "stm32l1xx_rtc.h"
 //#include "stm32l1xx_sdio.h"
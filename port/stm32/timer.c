@@ -1,9 +1,13 @@
 #include "bsp.h"
 
-SEGMENT_VARIABLE(EZMacProTimerMSB, U16, EZMAC_PRO_GLOBAL_MSPACE);
+// absolute deadline of the armed timeout on the 32-bit MAC clock
+volatile SEGMENT_VARIABLE(MacTimerDeadline, U32, EZMAC_PRO_GLOBAL_MSPACE);
+// compare stage waiting for the deadline (MAC_TIMER_STAGE_xxx)
+volatile SEGMENT_VARIABLE(MacTimerStage, U8, EZMAC_PRO_GLOBAL_MSPACE);
 
 /*!
  * Initialise Timer.
+ * The counter is free-running, it wraps around after 0xFFFF.
  */
 void TimerInit(TIM_TypeDef* TIMx, uint16_t prescaler, uint8_t irq)
 {
@@ -20,15 +24,13 @@ void TimerInit(TIM_TypeDef* TIMx, uint16_t prescaler, uint8_t irq)
 	TIM_TimeBaseStructure.TIM_RepetitionCounter = 0;
 #endif
 	TIM_TimeBaseInit(TIMx, &TIM_TimeBaseStructure);
-	TIM_ClearFlag(TIMx, TIM_FLAG_Update);
-
-	TIM_SelectOnePulseMode(TIMx, TIM_OPMode_Single);
+	TIM_ClearFlag(TIMx, TIM_FLAG_Update | TIM_FLAG_CC1);
 
 	if (irq != 0)
 	{
-		NVIC_PriorityGroupConfig(NVIC_PriorityGroup_0);
+		NVIC_PriorityGroupConfig(NVIC_PRIORITY_GROUP);
 		NVIC_InitStructure.NVIC_IRQChannel = irq;
-		NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+		NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = MAC_IRQ_PREEMPTION;
 		NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
 		NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
 		NVIC_Init(&NVIC_InitStructure); 
@@ -36,16 +38,116 @@ void TimerInit(TIM_TypeDef* TIMx, uint16_t prescaler, uint8_t irq)
 }
 
 /*!
- * This function is used to busy wait for timeout msec.
- * Note: longest wait interval is ~32 msec.
+ * Initialise the 32-bit MAC clock.
+ * MAC_TIMER counts the prescaled system clock, MAC_TIMER_HIGH is clocked by the update
+ * event (overflow) of MAC_TIMER. Both run from here on, no interrupt is needed to extend
+ * the clock to 32 bits.
+ */
+void TimersInit(void)
+{
+	MacTimerStage = MAC_TIMER_STAGE_NONE;
+
+	TimerInit( MAC_TIMER,		MAC_TIMER_PRESCALER,	MAC_TIMER_IRQn );
+	TimerInit( MAC_TIMER_HIGH,	0,						MAC_TIMER_HIGH_IRQn );
+
+	TIM_SelectOutputTrigger(MAC_TIMER, TIM_TRGOSource_Update);
+	TIM_SelectInputTrigger(MAC_TIMER_HIGH, MAC_TIMER_HIGH_TRIGGER);
+	TIM_SelectSlaveMode(MAC_TIMER_HIGH, TIM_SlaveMode_External1);
+
+	TIM_Cmd(MAC_TIMER_HIGH, ENABLE);
+	TIM_Cmd(MAC_TIMER, ENABLE);
+}
+
+/*!
+ * Reads the 32-bit MAC clock.
+ * The high word is read before and after the low word, the read is repeated if MAC_TIMER
+ * overflowed in between. The low word 0 is skipped, MAC_TIMER_HIGH is incremented a few
+ * clocks after the overflow.
+ */
+U32 macTimerNow(void)
+{
+	UU32 now;
+	U16 high;
+
+	do
+	{
+		high = (U16)MAC_TIMER_HIGH->CNT;
+		now.U16[LSB] = (U16)MAC_TIMER->CNT;
+		now.U16[MSB] = (U16)MAC_TIMER_HIGH->CNT;
+	} while ((now.U16[MSB] != high) || (now.U16[LSB] == 0));
+
+	return now.U32;
+}
+
+/*!
+ * This function is used to busy wait for timeout MAC timer ticks.
+ * Note: longest wait interval is ~65 msec.
  */
 void Timer2BusyWait_ms(U16 timeout)
 {
-	CLEAR_DELAY_COMPLETE();
-	SET_DELAY_TIMER_COUNT(65535 - timeout);
-	START_DELAY_TIMER();
-	WAIT_DELAY_COMPLETE();
-	STOP_DELAY_TIMER();
+	U32 start = macTimerNow();
+
+	while ((macTimerNow() - start) < timeout)
+		;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//    macTimerArm()
+//
+// Return Value : None
+// Parameters   : None
+//
+// Notes:
+//
+// Arms the compare stage for MacTimerDeadline. If more than 65535 ticks are left, the compare
+// channel of MAC_TIMER_HIGH waits for the high word, otherwise the compare channel of MAC_TIMER
+// waits for the low word. A deadline that is already passed (or passes while it is written) is
+// expired by a software compare event. The timer interrupt is enabled again for the new stage
+// if it was enabled.
+//
+//-----------------------------------------------------------------------------------------------
+static void macTimerArm(void)
+{
+	UU32 deadline;
+	U8 restoreInts = GET_MAC_TIMER_INTERRUPT();
+
+	DISABLE_MAC_TIMER_INTERRUPT_INT();
+	deadline.U32 = MacTimerDeadline;
+
+	if ((S32)(deadline.U32 - macTimerNow()) > 0xFFFF)
+	{
+		MAC_TIMER_HIGH->CCR1 = deadline.U16[MSB];
+		MAC_TIMER_HIGH->SR = (uint16_t)~TIM_IT_CC1;
+		MacTimerStage = MAC_TIMER_STAGE_HIGH;
+		// the high word can be reached while it is written
+		if ((S32)(deadline.U32 - macTimerNow()) > 0xFFFF)
+		{
+			SET_MAC_TIMER_INTERRUPT(restoreInts);
+			return;
+		}
+	}
+
+	MAC_TIMER->CCR1 = deadline.U16[LSB];
+	CLEAR_MAC_TIMER_INTERRUPT();
+	MacTimerStage = MAC_TIMER_STAGE_LOW;
+	if ((S32)(deadline.U32 - macTimerNow()) <= 0)
+		MAC_TIMER->EGR = TIM_EventSource_CC1;
+
+	SET_MAC_TIMER_INTERRUPT(restoreInts);
+}
+
+/*!
+ * MAC_TIMER_HIGH compare interrupt.
+ * The high word of the deadline is reached, the rest is waited for by MAC_TIMER. It is the
+ * only intermediate interrupt of a timeout, and only for timeouts longer than 65535 ticks.
+ */
+void macTimerHighISR(void)
+{
+	MAC_TIMER_HIGH->SR = (uint16_t)~TIM_IT_CC1;
+
+	if ((MacTimerStage == MAC_TIMER_STAGE_HIGH) && (MAC_TIMER_HIGH->DIER & TIM_IT_CC1))
+		macTimerArm();
 }
 
 //================================================================================================
@@ -63,23 +165,15 @@ void Timer2BusyWait_ms(U16 timeout)
 // Notes:
 //
 // This function is called when a interrupt event must initiate a timeout event.
-// A 32-bit union is used to provide word and byte access. The upper word is stored in
-// EZMacProTimerMSB. The The lower word is first negated then written to the TL0 and TH0 sfrs.
+// The deadline is counted from now on the free-running 32-bit MAC clock.
 //
 //-----------------------------------------------------------------------------------------------
 void extIntTimeout (U32 longTime)
 {
-	UU32 time;
-
 	DISABLE_MAC_TIMER_INTERRUPT();
-	STOP_MAC_TIMER();
-	CLEAR_MAC_TIMER_INTERRUPT();
-
-	time.U32 = longTime;
-	EZMacProTimerMSB = time.U16[MSB];
-	SET_MAC_TIMER_COUNT( - time.U16[LSB]);
 
-	START_MAC_TIMER();
+	MacTimerDeadline = macTimerNow() + longTime;
+	macTimerArm();
 }
 
 //================================================================================================
@@ -97,14 +191,26 @@ void extIntTimeout (U32 longTime)
 // Notes:
 //
 // This function is called when a timeout event must initiate a subsequent timeout event.
-// A 32-bit union is used to provide word and byte access. The upper word is stored in
-// EZMacProTimerMSB. The The lower word is first negated then written to the TL0 and TH0 sfrs.
+// The new deadline is counted from the expired one, so the latency of the timer interrupt
+// does not accumulate in a chain of timeouts. If the new deadline is already missed it is
+// counted from now.
 //
 // This function is not included for the Transmitter only configuration.
 //
 //-----------------------------------------------------------------------------------------------
 #ifndef TRANSMITTER_ONLY_OPERATION
-void timerIntTimeout (U32 longTime) __attribute__((alias("extIntTimeout")));
+void timerIntTimeout (U32 longTime)
+{
+	U32 now;
+
+	DISABLE_MAC_TIMER_INTERRUPT();
+
+	now = macTimerNow();
+	MacTimerDeadline += longTime;
+	if ((S32)(MacTimerDeadline - now) < 0)
+		MacTimerDeadline = now + longTime;
+	macTimerArm();
+}
 #endif
 
 //================================================================================================
@@ -112,15 +218,15 @@ void timerIntTimeout (U32 longTime) __attribute__((alias("extIntTimeout")));
 //
 // Parameters   : U32 longTime
 // Notes:
-// This function is called when a interrupt event must initiate a timeout event.
-// A 32-bit union is used to provide word and byte access. The upper word is stored in
-// EZMacProTimerMSB. The The lower word is first negated then written to the TL0 and TH0 sfrs.
+// This function is called when an API function must initiate a timeout event.
+// The deadline is counted from now on the free-running 32-bit MAC clock.
 //================================================================================================
 void macTimeout (U32 longTime)
 {
-	U8 restoreInts = GET_MAC_EXT_INTERRUPT();
-	DISABLE_MAC_INTERRUPTS();
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
 	extIntTimeout(longTime);
-	SET_MAC_EXT_INTERRUPT(restoreInts);
+	MAC_CRITICAL_EXIT(critical);
 }
 //================================================================================================
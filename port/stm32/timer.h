@@ -5,34 +5,55 @@
  * Timer macros.
  */
 
-#define START_DELAY_TIMER()				DELAY_TIMER->CR1 |= TIM_CR1_CEN
-#define START_MAC_TIMER()				MAC_TIMER->CR1   |= TIM_CR1_CEN
-
-#define STOP_DELAY_TIMER()				DELAY_TIMER->CR1 &= (uint16_t)(~((uint16_t)TIM_CR1_CEN))
-#define STOP_MAC_TIMER()				MAC_TIMER->CR1   &= (uint16_t)(~((uint16_t)TIM_CR1_CEN))
+/*!
+ * MAC timer macros.
+ * MAC_TIMER and MAC_TIMER_HIGH are chained into a free-running 32-bit clock, MAC_TIMER_HIGH
+ * counts the overflows of MAC_TIMER. A timeout is an absolute deadline on this clock, it is
+ * armed on the compare channel 1 of MAC_TIMER_HIGH while more than 65535 ticks are left, then
+ * on the compare channel 1 of MAC_TIMER. The counters are never stopped or written,
+ * STOP_MAC_TIMER() only cancels the deadline.
+ */
 
-#define WAIT_DELAY_COMPLETE()			while (!(DELAY_TIMER->SR & TIM_FLAG_Update))
-	
-#define CLEAR_DELAY_COMPLETE()			DELAY_TIMER->SR = (uint16_t)~TIM_FLAG_Update
+#define MAC_TIMER_STAGE_NONE			0
+#define MAC_TIMER_STAGE_HIGH			1
+#define MAC_TIMER_STAGE_LOW				2
 
-#define SET_DELAY_TIMER_COUNT(count)	DELAY_TIMER->CNT = count
-#define SET_MAC_TIMER_COUNT(count)		MAC_TIMER->CNT   = count
+#define STOP_MAC_TIMER()					\
+	do {									\
+		MacTimerStage = MAC_TIMER_STAGE_NONE;	\
+		MAC_TIMER->DIER &= ~TIM_IT_CC1;		\
+		MAC_TIMER_HIGH->DIER &= ~TIM_IT_CC1;	\
+	} while (0)
 
 #define DELAY_uS(delay)					Timer2BusyWait_ms(delay)
 
-#define ENABLE_MAC_TIMER_INTERRUPT()		MAC_TIMER->DIER |=  TIM_IT_Update
-#define CLEAR_MAC_TIMER_INTERRUPT()			MAC_TIMER->SR = (uint16_t)~TIM_IT_Update
-#define GET_MAC_TIMER_INTERRUPT()			((MAC_TIMER->DIER &  TIM_IT_Update) ? 1 : 0)
+#define MAC_TIMER_NOW()					macTimerNow()
+// a timeout is armed
+#define MAC_TIMER_PENDING()				(MacTimerStage != MAC_TIMER_STAGE_NONE)
+// time passed since the deadline of the expired timeout
+#define MAC_TIMER_LATENCY()				(macTimerNow() - MacTimerDeadline)
+
+#define ENABLE_MAC_TIMER_INTERRUPT()		\
+	do {									\
+		if (MacTimerStage == MAC_TIMER_STAGE_LOW)		\
+			MAC_TIMER->DIER |= TIM_IT_CC1;				\
+		else if (MacTimerStage == MAC_TIMER_STAGE_HIGH)	\
+			MAC_TIMER_HIGH->DIER |= TIM_IT_CC1;			\
+	} while (0)
+#define CLEAR_MAC_TIMER_INTERRUPT()			MAC_TIMER->SR = (uint16_t)~TIM_IT_CC1
+#define GET_MAC_TIMER_INTERRUPT()			(((MAC_TIMER->DIER | MAC_TIMER_HIGH->DIER) & TIM_IT_CC1) ? 1 : 0)
 #define DISABLE_MAC_TIMER_INTERRUPT_INT()	\
 	do {									\
-		MAC_TIMER->DIER &= ~TIM_IT_Update;	\
+		MAC_TIMER->DIER &= ~TIM_IT_CC1;		\
+		MAC_TIMER_HIGH->DIER &= ~TIM_IT_CC1;	\
 		CLEAR_MAC_TIMER_INTERRUPT();		\
 	} while (0)
 #define DISABLE_MAC_TIMER_INTERRUPT()		\
 	do {									\
-		DISABLE_GLOBAL_INTERRUPTS();		\
+		U8 macCritical;						\
+		MAC_CRITICAL_ENTER(macCritical);	\
 		DISABLE_MAC_TIMER_INTERRUPT_INT();	\
-		ENABLE_GLOBAL_INTERRUPTS();			\
+		MAC_CRITICAL_EXIT(macCritical);		\
 	} while (0)
 #define SET_MAC_TIMER_INTERRUPT(enable)		\
 	do {									\
@@ -41,19 +62,51 @@
 		}									\
 	} while (0)
 
+// the MAC timer interrupt of the deadline is only enabled for its last stage
+#define MAC_TIMER_EXPIRED()					((MAC_TIMER->SR & MAC_TIMER->DIER & TIM_IT_CC1) ? 1 : 0)
+
+/*!
+ * Timer wheel tick on the compare channel 2 of MAC_TIMER.
+ * The compare value is advanced by one tick period on each tick, the tick does not drift.
+ */
+#define TIMER_WHEEL_TICK				TIMEOUT_US(TIMER_WHEEL_TICK_MS * 1000L)
+
+#define TIMER_WHEEL_TICK_START()			\
+	do {									\
+		U8 macCritical;						\
+		MAC_CRITICAL_ENTER(macCritical);	\
+		MAC_TIMER->CCR2 = (uint16_t)(MAC_TIMER->CNT + TIMER_WHEEL_TICK);	\
+		MAC_TIMER->SR = (uint16_t)~TIM_IT_CC2;	\
+		MAC_TIMER->DIER |= TIM_IT_CC2;		\
+		MAC_CRITICAL_EXIT(macCritical);		\
+	} while (0)
+#define TIMER_WHEEL_TICK_STOP()				\
+	do {									\
+		U8 macCritical;						\
+		MAC_CRITICAL_ENTER(macCritical);	\
+		MAC_TIMER->DIER &= ~TIM_IT_CC2;		\
+		MAC_CRITICAL_EXIT(macCritical);		\
+	} while (0)
+#define MAC_TIMER_TICK()					\
+	((MAC_TIMER->SR & MAC_TIMER->DIER & TIM_IT_CC2) ?	\
+		(MAC_TIMER->SR = (uint16_t)~TIM_IT_CC2, MAC_TIMER->CCR2 = (uint16_t)(MAC_TIMER->CCR2 + TIMER_WHEEL_TICK), 1) : 0)
+
 #define TIMEOUT_US(n)                   ((U32)(n) * (SYSCLK_HZ / MAC_TIMER_PRESCALER / 1000000L))
 // n = transmission speed
 #define BYTE_TIME(n)                    ((SYSCLK_HZ / n) * 20 / MAC_TIMER_PRESCALER)
 
-#define DELAY_1MS_TIMER2                (U16)((SYSCLK_HZ / DELAY_TIMER_PRESCALER) / 1012)
-#define DELAY_2MS_TIMER2                (U16)((SYSCLK_HZ / DELAY_TIMER_PRESCALER) /  506)
-#define DELAY_5MS_TIMER2                (U16)((SYSCLK_HZ / DELAY_TIMER_PRESCALER) /  202)
-#define DELAY_15MS_TIMER2               (U16)((SYSCLK_HZ / DELAY_TIMER_PRESCALER) /   67)
+// the busy waits count the ticks of the MAC timer
+#define DELAY_1MS_TIMER2                (U16)((SYSCLK_HZ / MAC_TIMER_PRESCALER) / 1012)
+#define DELAY_2MS_TIMER2                (U16)((SYSCLK_HZ / MAC_TIMER_PRESCALER) /  506)
+#define DELAY_5MS_TIMER2                (U16)((SYSCLK_HZ / MAC_TIMER_PRESCALER) /  202)
+#define DELAY_15MS_TIMER2               (U16)((SYSCLK_HZ / MAC_TIMER_PRESCALER) /   67)
 
-extern SEGMENT_VARIABLE(EZMacProTimerMSB, U16, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(MacTimerDeadline, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(MacTimerStage, U8, EZMAC_PRO_GLOBAL_MSPACE);
 
 void TimerInit(TIM_TypeDef* TIMx, uint16_t prescaler, uint8_t irq);
 void TimersInit(void);
+U32  macTimerNow(void);
 
 void Timer2BusyWait_ms(U16 timeout);
 
@@ -90,7 +90,7 @@ void Uart0Init(void)
 	USART_RX_INIT();
 	USART_TX_INIT();
 
-	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_0);
+	NVIC_PriorityGroupConfig(NVIC_PRIORITY_GROUP);
 	NVIC_InitStructure.NVIC_IRQChannel = USART_IRQn;
 	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x0;
 	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x1;
@@ -1,6 +1,10 @@
 /*!\file EZMacPro.c
  * \brief EZMacPRO stack functions.
  *
+ * \n Each API function that accesses the radio or the MAC state runs its body
+ * \n in one MAC critical section (MAC_CRITICAL_ENTER/EXIT), the MAC interrupts
+ * \n can not preempt the operation between two register accesses.
+ *
  * \n EZMacPRO version: 3.0.1r
  *
  * \n This software must be used in accordance with the End User License
@@ -21,21 +25,75 @@
  *	 G L O B A L	V A R I A B L E S	 *
  * ======================================= */
 
+#ifdef EZMACPRO_CONTEXT
+// the state of the radios, see EZMacProContext
+volatile EZMacProContext EZMacProDefaultContext;
+volatile EZMacProContext * volatile EZMacProCtx = &EZMacProDefaultContext;
+#else
 volatile SEGMENT_VARIABLE(EZMacProReg, EZMacProUnion, REGISTER_MSPACE);
 volatile SEGMENT_VARIABLE(EZMacProCurrentChannel, U8, EZMAC_PRO_GLOBAL_MSPACE);
 
+// crystal start-up time of the last and of the slowest wake-up in MAC timer ticks
+volatile SEGMENT_VARIABLE(XtalStartTime, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(XtalStartMax, U32, EZMAC_PRO_GLOBAL_MSPACE);
+// MAC timer at XTON, valid if XtalStartPending is set
+volatile SEGMENT_VARIABLE(XtalStartStamp, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(XtalStartPending, U8, EZMAC_PRO_GLOBAL_MSPACE);
+
 #ifdef EXTENDED_PACKET_FORMAT
 	volatile SEGMENT_VARIABLE(TimeoutACK, U32, EZMAC_PRO_GLOBAL_MSPACE);
+	// the ACK timeout of a peer is between TimeoutACKMin and TimeoutACK, see EZMacPRO_Ack_Wait_Time()
+	volatile SEGMENT_VARIABLE(TimeoutACKMin, U32, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(AckRttTable[ACK_RTT_TABLE_SIZE], AckRttTableEntry, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(AckRttNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	// entry and DID of the peer of the ongoing transmission and the MAC timer at the end of the transmission
+	volatile SEGMENT_VARIABLE(AckRttEntry, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(AckRttDid, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(AckRttStamp, U32, EZMAC_PRO_GLOBAL_MSPACE);
 	volatile SEGMENT_VARIABLE(EZMacProSequenceNumber, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	// sequence numbers of the destinations, a receiver detects the retransmissions by them
+	volatile SEGMENT_VARIABLE(SequenceTable[SEQUENCE_TABLE_SIZE], SequenceTableEntry, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(SequenceNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	// transmissions of the current packet, see RTCR
+	volatile SEGMENT_VARIABLE(EZMacProTxAttempts, U8, EZMAC_PRO_GLOBAL_MSPACE);
 	volatile SEGMENT_VARIABLE(PreamRegValue, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	// bulk transfer: the payload, the first frame and the frames of the window, see EZMacPRO_Bulk_Transmit()
+	SEGMENT_VARIABLE_SEGMENT_POINTER(BulkTxBuf, U8, BUFFER_MSPACE, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(BulkTxLength, U16, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(BulkTxBase, U16, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(BulkTxCount, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(BulkTxNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(BulkTxPending, U16, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(BulkTxToggle, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(BulkTxMessage, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	// frames sent by the bulk transfers, the retransmitted frames included
+	volatile SEGMENT_VARIABLE(BulkTxFrames, U32, EZMAC_PRO_GLOBAL_MSPACE);
 #endif
 
 #ifndef TRANSMITTER_ONLY_OPERATION
 	volatile BIT fHeaderErrorOccurred;
-	SEGMENT_VARIABLE(RxBuffer[RECEIVED_BUFFER_SIZE], U8 , BUFFER_MSPACE);
+	volatile SEGMENT_VARIABLE(RxFrame, U8 , EZMAC_PRO_GLOBAL_MSPACE);
+	// receive metadata, two copies selected by the low bit of the sequence counter
+	volatile SEGMENT_VARIABLE(RxMetaSeq, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(RxMeta[2], EZMacProRxMeta, BUFFER_MSPACE);
 	#ifdef EXTENDED_PACKET_FORMAT
 		volatile SEGMENT_VARIABLE(AckBufSize, U8 , EZMAC_PRO_GLOBAL_MSPACE);
-		volatile SEGMENT_VARIABLE(AckBuffer[ACK_BUFFER_SIZE], U8 , BUFFER_MSPACE);
+		volatile SEGMENT_VARIABLE(AckFrame, U8 , EZMAC_PRO_GLOBAL_MSPACE);
+		// last sequence number of the senders, the duplicates are counted and not published
+		volatile SEGMENT_VARIABLE(DuplicateCache[DUPLICATE_CACHE_SIZE], DuplicateCacheEntry, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(DuplicateCacheNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(RxDuplicate, U8, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(RxDuplicateCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+		// window of the bulk transfer being received and the bitmap of its received frames
+		volatile SEGMENT_VARIABLE(BulkRxSid, U8, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(BulkRxToggle, U8, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(BulkRxMap, U16, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(BulkRxStamp, U32, EZMAC_PRO_GLOBAL_MSPACE);
+		// the message being reassembled from the fragments
+		volatile SEGMENT_VARIABLE(BulkRxMessage, U8, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(BulkRxLength, U16, EZMAC_PRO_GLOBAL_MSPACE);
+		volatile SEGMENT_VARIABLE(BulkRxReceived, U16, EZMAC_PRO_GLOBAL_MSPACE);
+		SEGMENT_VARIABLE(BulkRxBuf[BULK_MESSAGE_SIZE], U8, BUFFER_MSPACE);
 	#endif
 	volatile SEGMENT_VARIABLE(EZMacProReceiveStatus, U8, EZMAC_PRO_GLOBAL_MSPACE);
 	volatile SEGMENT_VARIABLE(EZMacProRSSIvalue, U8, EZMAC_PRO_GLOBAL_MSPACE);
@@ -57,12 +115,25 @@ volatile SEGMENT_VARIABLE(EZMacProCurrentChannel, U8, EZMAC_PRO_GLOBAL_MSPACE);
 #ifdef TRANSCEIVER_OPERATION
 	volatile SEGMENT_VARIABLE(TimeoutLBTI, U32, EZMAC_PRO_GLOBAL_MSPACE);
 	volatile SEGMENT_VARIABLE(BusyLBT, U8, EZMAC_PRO_GLOBAL_MSPACE);
-	volatile SEGMENT_VARIABLE(EZMacProRandomNumber, U8, EZMAC_PRO_GLOBAL_MSPACE);
 	volatile SEGMENT_VARIABLE(EZMacProLBT_Retrys, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(CsmaBE, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	#ifdef EXTENDED_PACKET_FORMAT
+	// data rate and TX power of the peers, the entry of the ongoing exchange and the data rate
+	// and TX power of the radio
+	volatile SEGMENT_VARIABLE(LinkTable[LINK_TABLE_SIZE], LinkTableEntry, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(LinkNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(LinkEntry, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(LinkRate, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(LinkPower, U8, EZMAC_PRO_GLOBAL_MSPACE);
+	#endif
 #endif
 
+// state of the random number generator, seeded by EZMacPRO_Init()
+volatile SEGMENT_VARIABLE(EZMacProRandomNumber, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
 #ifdef PACKET_FORWARDING_SUPPORTED
 	volatile SEGMENT_VARIABLE(ForwardedPacketTable[FORWARDED_PACKET_TABLE_SIZE], ForwardedPacketTableEntry, FORWARDED_PACKET_TABLE_MSPACE);
+	volatile SEGMENT_VARIABLE(ForwardedPacketNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
 #endif
 
 #ifdef ANTENNA_DIVERSITY_ENABLED
@@ -74,6 +145,26 @@ volatile SEGMENT_VARIABLE(EZMacProCurrentChannel, U8, EZMAC_PRO_GLOBAL_MSPACE);
 	volatile SEGMENT_VARIABLE(maxChannelNumber, U8, EZMAC_PRO_GLOBAL_MSPACE);
 #endif //MORE_CHANNEL_IS_USED
 
+#ifdef FAST_SCAN_ENABLED
+	volatile SEGMENT_VARIABLE(TimeoutFastScan, U32, EZMAC_PRO_GLOBAL_MSPACE);
+	volatile SEGMENT_VARIABLE(FastScanDwell, U8, EZMAC_PRO_GLOBAL_MSPACE);
+#endif
+
+#ifdef CHANNEL_QUALITY_ENABLED
+	volatile SEGMENT_VARIABLE(ChannelQuality[CHANNEL_QUALITY_SIZE], ChannelQualityEntry, EZMAC_PRO_GLOBAL_MSPACE);
+#endif
+#endif //EZMACPRO_CONTEXT
+
+// MAC timer ticks since TimersInit() at the boot phases, see EZMacPRO_Boot_Mark()
+volatile SEGMENT_VARIABLE(BootTime[EZMAC_BOOT_PHASES], U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+// bit n is set if the n-th column of RfSettingsB1 differs between the two data rates
+volatile SEGMENT_VARIABLE(LinkRateDelta[4][4], U16, EZMAC_PRO_GLOBAL_MSPACE);
+	#endif
+#endif
+
 /* ======================================= *
  *	 P U B L I C	F U N C T I O N S		*
  * ======================================= */
@@ -83,10 +174,16 @@ volatile SEGMENT_VARIABLE(EZMacProCurrentChannel, U8, EZMAC_PRO_GLOBAL_MSPACE);
 //						Initializes the EZRadioPRO device. The function has to be called in the power-on routine.
 // Return Values :	MAC_OK: if the MAC recognized the used chip
 //						CHIPTYPE_ERROR: if the MAC didn't recognize the used chip
+// Notes:				With FAST_BOOT the software reset is skipped if the radio has just been
+//						powered up (the POR interrupt is pending), and the registers are not
+//						written with their reset values (rev B1).
 //------------------------------------------------------------------------------------------------
 MacParams EZMacPRO_Init(void)
 {
 	U8 temp8;
+#ifdef FAST_BOOT
+	U8 intStatus2;
+#endif
 
 	DISABLE_MAC_INTERRUPTS();
 
@@ -122,9 +219,50 @@ MacParams EZMacPRO_Init(void)
 	EZMacProReg.name.LBDR	= 0x14;
 	EZMacProReg.name.LFTMR2 = 0x40;
 
+#ifdef EZMACPRO_CONTEXT
+	// the shared services are initialized with the default context only
+	if (EZMacProCtx == &EZMacProDefaultContext)
+#endif
+	{
+		// release all frames of the pool
+		EZMacPRO_FramePool_Init();
+		// empty the event queue
+		EZMacPRO_Event_Init();
+		// stop the software timers
+		EZMacPRO_Timer_Init();
+		// drop the messages being aggregated
+		EZMacPRO_Aggregate_Init();
+#ifdef FLASH_ENABLED
+		// find the active page of the record store
+		EZMacPRO_Nvm_Init();
+#endif
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+		// compare the modem settings of the data rates
+		macLinkRateDelta();
+	#endif
+#endif
+	}
+#ifndef TRANSMITTER_ONLY_OPERATION
+	RxFrame = FRAME_POOL_INVALID;
+	RxMetaSeq = 0;
+	for (temp8 = 0; temp8 < sizeof(EZMacProRxMeta); temp8++)
+	{
+		((volatile U8 *)&RxMeta[0])[temp8] = 0;
+		((volatile U8 *)&RxMeta[1])[temp8] = 0;
+	}
+	#ifdef EXTENDED_PACKET_FORMAT
+	AckFrame = FRAME_POOL_INVALID;
+	#endif
+#endif
+
 	// read Si443x interrupts to clear
 	macSpiReadReg(SI4432_INTERRUPT_STATUS_1);
+#ifdef FAST_BOOT
+	intStatus2 = macSpiReadReg(SI4432_INTERRUPT_STATUS_2);
+#else
 	macSpiReadReg(SI4432_INTERRUPT_STATUS_2);
+#endif
 
 	CLEAR_MAC_EXT_INTERRUPT();
 
@@ -132,21 +270,40 @@ MacParams EZMacPRO_Init(void)
 	macSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, 0x00);
 	macSpiWriteReg(SI4432_INTERRUPT_ENABLE_2, SI4432_ENCHIPRDY);
 
+	// the software reset is not a crystal start-up measurement
+	XtalStartPending = 0;
+
 	// EZMac state Software Reset
 	EZMacProReg.name.MSR = EZMAC_PRO_WAKE_UP;
 	// Call the wake-up state entered callback.
 	EZMacPRO_StateWakeUpEntered();
 
-	// set time out to XTAL start-up time
-	macTimeout(TIMEOUT_XTAL_START);
+#ifdef FAST_BOOT
+	if ((intStatus2 & (SI4432_IPOR | SI4432_ICHIPRDY)) == (SI4432_IPOR | SI4432_ICHIPRDY))
+	{	// the radio has been powered up in BoardInit() and its crystal runs already
+		EZMacProReg.name.MSR = EZMAC_PRO_IDLE;
+		EZMacPRO_StateIdleEntered();
+		ENABLE_MAC_INTERRUPTS();
+	}
+	else
+#endif
+	{
+		// set time out to XTAL start-up time
+		macTimeout(TIMEOUT_XTAL_START);
 
-	// Send the Software Reset Command to the radio
-	// use direct write since LBD and WUT initially disabled
-	ENABLE_MAC_INTERRUPTS();
-	macSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_1, (SI4432_SWRES | SI4432_XTON));
+		// Send the Software Reset Command to the radio
+		// use direct write since LBD and WUT initially disabled
+		ENABLE_MAC_INTERRUPTS();
+#ifdef FAST_BOOT
+		// after the power-on reset only the chip ready interrupt is waited for
+		if (!(intStatus2 & SI4432_IPOR))
+#endif
+		macSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_1, (SI4432_SWRES | SI4432_XTON));
 
-	// wait until the MAC goes to Idle State
-	while (EZMacProReg.name.MSR == EZMAC_PRO_WAKE_UP);
+		// wait until the MAC goes to Idle State
+		while (EZMacProReg.name.MSR == EZMAC_PRO_WAKE_UP);
+	}
+	EZMacPRO_Boot_Mark(EZMAC_BOOT_CHIP_READY);
 
 	// clear Chip ready and POR interrupts
 	macSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, 0);
@@ -175,8 +332,10 @@ MacParams EZMacPRO_Init(void)
 #endif //EXTENDED_PACKET_FORMAT
 
 	macSpiWriteReg(SI4432_HEADER_CONTROL_1, 0x00);	// Clear the Header Control Register
-	macSpiWriteReg(SI4432_SYNC_WORD_3, 0x2D);		// Set the SYNC WORD
+#ifndef FAST_BOOT
+	macSpiWriteReg(SI4432_SYNC_WORD_3, 0x2D);		// Set the SYNC WORD (reset value)
 	macSpiWriteReg(SI4432_SYNC_WORD_2, 0xD4);
+#endif
 
 	SetRfParameters(EZMacProReg.name.MCR);			// Set the modem, frequency parameters and
 													// preamble length according to the init register value
@@ -186,22 +345,45 @@ MacParams EZMacPRO_Init(void)
 	macSpiWriteReg(SI4432_GPIO1_CONFIGURATION, GPIO1_FUNCTION);
 	macSpiWriteReg(SI4432_GPIO2_CONFIGURATION, GPIO2_FUNCTION);
 
-	macSpiWriteReg(									//enable packet handler & CRC16
+#ifndef FAST_BOOT
+	macSpiWriteReg(									//enable packet handler & CRC16 (reset value)
 		SI4432_DATA_ACCESS_CONTROL,
 		SI4432_ENPACTX | SI4432_ENPACRX | SI4432_ENCRC | SI4432_CRC_16
 		);
+#endif
 
 	macSpiWriteReg(									// FIFO mode, GFSK modulation,
 		SI4432_MODULATION_MODE_CONTROL_2,			//	TX Data Clk is available via the GPIO
 		SI4432_MODTYP_GFSK | SI4432_FIFO_MODE | SI4432_TX_DATA_CLK_GPIO
 		);
 
+#ifndef FAST_BOOT
 	macSpiWriteReg(SI4432_DIGITAL_TEST_BUS, 0x00);	// reset digital testbus, disable scan test
+#endif
 	macSpiWriteReg(SI4432_ANALOG_TEST_BUS, 0x0B);	// select nothing to the Analog Testbus
 
 #ifdef PACKET_FORWARDING_SUPPORTED
 	initForwardedPacketTable ();
 #endif
+#ifdef EXTENDED_PACKET_FORMAT
+	initAckRttTable ();
+	initSequenceTable ();
+	initBulkTransfer ();
+	#ifndef TRANSMITTER_ONLY_OPERATION
+	initDuplicateCache ();
+	#endif
+#endif
+#ifdef CHANNEL_QUALITY_ENABLED
+	initChannelQuality ();
+#endif
+#ifdef TRANSCEIVER_OPERATION
+	CsmaBE = CSMA_MIN_BE;
+	#ifdef EXTENDED_PACKET_FORMAT
+	initLinkTable ();
+	// the TX power is set by the first TCR write
+	LinkPower = 0xFF;
+	#endif
+#endif
 
 #ifndef B1_ONLY
 	temp8 = macSpiReadReg (SI4432_DEVICE_VERSION);			// read out the device type register
@@ -231,12 +413,16 @@ MacParams EZMacPRO_Init(void)
 	);
 #endif
 
+	// seed the random number generator from the RSSI noise
+	macRandomSeed();
+
 	// stop Si443x xtal, clear TX, RX , PLL
 	// use direct write since LBD and WUT initially disabled
 	macSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_1, 0x00);
 
 	EZMacProReg.name.MSR = EZMAC_PRO_SLEEP;		// after EZMAC init the next state is SLEEP
 	EZMacPRO_StateSleepEntered();				// Call the Sleep state entered callback.
+	EZMacPRO_Boot_Mark(EZMAC_BOOT_INIT_DONE);
 
 #ifndef B1_ONLY
 	if (temp8 == 0)				// if the MAC recognize the chip type
@@ -255,7 +441,7 @@ MacParams EZMacPRO_Init(void)
 // Return Values :	MAC_OK: the operation was successful.
 //							STATE_ERROR: the operation is ignored because the MAC was not in IDLE mode
 //-----------------------------------------------------------------------------------------------
-MacParams EZMacPRO_Sleep(void)
+static MacParams macSleep(void)
 {
 	if (EZMacProReg.name.MSR == EZMAC_PRO_IDLE)
 	{
@@ -279,46 +465,150 @@ MacParams EZMacPRO_Sleep(void)
 		return STATE_ERROR;
 }
 
+MacParams EZMacPRO_Sleep(void)
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macSleep();
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
+
 //------------------------------------------------------------------------------------------------
 // Function Name :	EZMacPRO_Wake_Up
 //							Switches the MAC from SLEEP mode into IDLE mode. Turns on the crystal oscillator
 //							of the radio, so the current consumption increases.The MAC has to be in SLEEP mode
-//							when calling the function.
+//							when calling the function. The function waits until the crystal is started,
+//							EZMacPRO_Wake_Up_Start() returns immediately.
 // Return Values : 	MAC_OK: the operation was successful.
 //							STATE_ERROR: the operation is ignored because the MAC was not in SLEEP mode.
 //------------------------------------------------------------------------------------------------
 MacParams EZMacPRO_Wake_Up(void)
 {
-	if (EZMacProReg.name.MSR == EZMAC_PRO_SLEEP)
+	if (EZMacPRO_Wake_Up_Start() == MAC_OK)
 	{
-		DISABLE_MAC_INTERRUPTS();		// disable MAC interrupts, just in case
+		// wait until the MAC goes to Idle State
+		while (EZMacProReg.name.MSR == EZMAC_PRO_WAKE_UP);
+		if (EZMacProReg.name.MSR == EZMAC_PRO_IDLE)
+			return MAC_OK;
+	}
+	return STATE_ERROR;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name :	EZMacPRO_Wake_Up_Start
+//							Starts the crystal oscillator of the radio and returns. The chip ready
+//							interrupt puts the MAC into IDLE mode and calls EZMacPRO_StateIdleEntered(),
+//							if the crystal does not start within TIMEOUT_XTAL_START the MAC goes to
+//							WAKE_UP_ERROR and EZMacPRO_StateErrorEntered() is called.
+// Return Values : 	MAC_OK: the crystal is starting.
+//							STATE_ERROR: the operation is ignored because the MAC was not in SLEEP mode.
+//------------------------------------------------------------------------------------------------
+static MacParams macWakeUpStart(void)
+{
+	if (EZMacProReg.name.MSR != EZMAC_PRO_SLEEP)
+		return STATE_ERROR;
 
-		macSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, 0x00);	// disable Si443x interrupt 2 sources except ENLBDI & SI4432_ENWUT
-		macSetEnable2(SI4432_ENCHIPRDY);					// enable chip ready interrupt
+	DISABLE_MAC_INTERRUPTS();		// disable MAC interrupts, just in case
 
-		// clear interrupts
-		macSpiReadReg(SI4432_INTERRUPT_STATUS_1);
-		macSpiReadReg(SI4432_INTERRUPT_STATUS_2);
-		CLEAR_MAC_EXT_INTERRUPT();
+	macSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, 0x00);	// disable Si443x interrupt 2 sources except ENLBDI & SI4432_ENWUT
+	macSetEnable2(SI4432_ENCHIPRDY);					// enable chip ready interrupt
 
-		DELAY_uS(TIMEOUT_XTAL_START);
+	// clear interrupts
+	macSpiReadReg(SI4432_INTERRUPT_STATUS_1);
+	macSpiReadReg(SI4432_INTERRUPT_STATUS_2);
+	CLEAR_MAC_EXT_INTERRUPT();
 
-		EZMacProReg.name.MSR = EZMAC_PRO_WAKE_UP;	// next state is WAKE UP state
-		EZMacPRO_StateWakeUpEntered();				// Call the wake-up state entered callback.
-		// start timer with XTAL startup timeout
-		macTimeout(TIMEOUT_XTAL_START);
-		ENABLE_MAC_INTERRUPTS();
+	EZMacProReg.name.MSR = EZMAC_PRO_WAKE_UP;	// next state is WAKE UP state
+	EZMacPRO_StateWakeUpEntered();				// Call the wake-up state entered callback.
+	// start timer with XTAL startup timeout
+	macTimeout(TIMEOUT_XTAL_START);
 
-		// start Si443x XTAL
-		macSetFunction1(SI4432_XTON);
+	// start Si443x XTAL, the start-up time is measured until the chip ready interrupt
+	XtalStartStamp = MAC_TIMER_NOW();
+	XtalStartPending = 1;
+	ENABLE_MAC_INTERRUPTS();
+	macSetFunction1(SI4432_XTON);
 
-		// wait until the MAC goes to Idle State
-		while (EZMacProReg.name.MSR == EZMAC_PRO_WAKE_UP);
-		if (EZMacProReg.name.MSR == EZMAC_PRO_IDLE)
-			return MAC_OK;
+	return MAC_OK;
+}
+
+MacParams EZMacPRO_Wake_Up_Start(void)
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macWakeUpStart();
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name :	EZMacPRO_Wake_Up_Time
+//							The application can start the wake-up this much earlier than the radio
+//							is needed.
+// Return Values : 	the longest crystal start-up time measured so far in MAC timer ticks (the
+//							unit of TIMEOUT_US()), TIMEOUT_XTAL_START if there is no measurement.
+//------------------------------------------------------------------------------------------------
+U32 EZMacPRO_Wake_Up_Time(void)
+{
+	return (XtalStartMax != 0) ? XtalStartMax : TIMEOUT_XTAL_START;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name :	EZMacPRO_Random
+//							Returns the next number of the random number generator of the MAC. The
+//							generator is seeded by EZMacPRO_Init(), the nodes started together get
+//							different sequences. The LBT and the retransmission backoffs draw from
+//							the same sequence.
+// Return Values : 	32-bit random number, never 0
+//------------------------------------------------------------------------------------------------
+U32 EZMacPRO_Random(void)
+{
+	U8 critical;
+	U32 value;
+
+	MAC_CRITICAL_ENTER(critical);
+	RANDOM_NEXT(EZMacProRandomNumber);
+	value = EZMacProRandomNumber;
+	MAC_CRITICAL_EXIT(critical);
+	return value;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name :	EZMacPRO_Ack_Wait_Time
+//							The ACK timeout of the next transmission to the peer. It is the smoothed
+//							round-trip time plus four times its mean deviation, limited between the
+//							quarter of the fixed timeout and the fixed timeout.
+// Return Values : 	the ACK timeout in MAC timer ticks (the unit of TIMEOUT_US()), the fixed
+//							timeout calculated from the MCR and MPL if the peer has no measurement.
+// Parameters	 :	did - destination ID of the peer
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+U32 EZMacPRO_Ack_Wait_Time(U8 did)
+{
+	U8 i;
+	U32 timeout;
+
+	for (i = 0; i < ACK_RTT_TABLE_SIZE; i++)
+	{
+		if (AckRttTable[i].srtt != 0 && AckRttTable[i].did == did)
+		{
+			timeout = AckRttTable[i].srtt + 4 * AckRttTable[i].rttvar;
+			if (timeout < TimeoutACKMin)
+				return TimeoutACKMin;
+			if (timeout < TimeoutACK)
+				return timeout;
+			break;
+		}
 	}
-	return STATE_ERROR;
+	return TimeoutACK;
 }
+#endif
+
 //------------------------------------------------------------------------------------------------
 // Function Name	:	EZMacPRO_Idle()
 //							This is the only function that aborts the ongoing reception and transmission.
@@ -328,7 +618,7 @@ MacParams EZMacPRO_Wake_Up(void)
 // Return Values	: 	MAC_OK: the MAC is set into IDLE mode, and no transmission or reception was aborted.
 //							STATE_ERROR: the MAC is set into IDLE mode, and transmission or reception was aborted
 //------------------------------------------------------------------------------------------------
-MacParams EZMacPRO_Idle(void)
+static MacParams macIdle(void)
 {
 	// if the MAC in sleep state
 	if (EZMacProReg.name.MSR == EZMAC_PRO_SLEEP)
@@ -345,6 +635,10 @@ MacParams EZMacPRO_Idle(void)
 	macSpiReadReg(SI4432_INTERRUPT_STATUS_2);
 
 	STOP_MAC_TIMER();
+#ifdef EXTENDED_PACKET_FORMAT
+	// the ongoing bulk transfer is aborted
+	BulkTxLength = 0;
+#endif
 
 #ifndef B1_ONLY
 	if (EZMacProReg.name.DTR == 0x00)	// if the rev V2 chip is used
@@ -369,6 +663,17 @@ MacParams EZMacPRO_Idle(void)
 		return MAC_OK;
 	}
 }
+
+MacParams EZMacPRO_Idle(void)
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macIdle();
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
 //------------------------------------------------------------------------------------------------
 // Function Name:	EZMacPRO_Transmit()
 //						It starts to transmit a packet.All the parameters have to be set before calling
@@ -379,9 +684,15 @@ MacParams EZMacPRO_Idle(void)
 //						EZMAC PRO was not in IDLE mode.
 //------------------------------------------------------------------------------------------------
 #ifndef RECEIVER_ONLY_OPERATION
-MacParams EZMacPRO_Transmit(void)
+static MacParams macTransmit(void)
 {
 	U8 temp8;
+	#ifdef EXTENDED_PACKET_FORMAT
+		#ifdef TRANSCEIVER_OPERATION
+	U8 lacr;
+	U8 rate;
+		#endif
+	#endif
 	// if the MAC is not in Idle state
 	if (EZMacProReg.name.MSR != EZMAC_PRO_IDLE)
 		 return STATE_ERROR;
@@ -433,6 +744,10 @@ MacParams EZMacPRO_Transmit(void)
 		temp8 = EZMacProReg.name.FSR;
 		//in case of four channel is only for channel is allowed
 		if (temp8 > 3) temp8 = 0;
+		#ifdef CHANNEL_QUALITY_ENABLED
+		// avoid the blacklisted channel
+		temp8 = macChannelSelect(temp8);
+		#endif
 		SpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT, EZMacProReg.array[FR0 + temp8]);
 		EZMacProCurrentChannel = temp8;
 	}
@@ -440,37 +755,66 @@ MacParams EZMacPRO_Transmit(void)
 	#ifdef MORE_CHANNEL_IS_USED
 	// select the proper frequency register according to FSR register
 	temp8 = EZMacProReg.name.FSR;
+		#ifdef CHANNEL_QUALITY_ENABLED
+	// avoid the blacklisted channel
+	temp8 = macChannelSelect(temp8);
+		#endif
 	SpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT, EZMacProReg.array[FR0+temp8]);
 	EZMacProCurrentChannel = temp8;
 	#endif
 
-	#ifdef EXTENDED_PACKET_FORMAT
-	// Assemble the CTRL byte
-	// set radius field
-	temp8 = (EZMacProReg.name.MCR >> 3) & 0x03;
-	if (EZMacProReg.name.TCR & 0x80)
-		temp8 |= 0x04;		//ACK request
-	// set the Sequence number
-	if (EZMacProSequenceNumber < 15)
-		EZMacProSequenceNumber++;
+	#ifdef STANDARD_PACKET_FORMAT
+	// set the destination header, DID can be changed while the packet is sent
+	if (EZMacProReg.name.MCR & 0x80)	// if CID is used
+		SpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.DID);
 	else
-		EZMacProSequenceNumber = 0;
-
-	temp8 |= (EZMacProSequenceNumber << 4);
+		SpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.DID);
+	#endif
 
-	// set the transmit headers
-	if (EZMacProReg.name.MCR & 0x80)
-	{	// if CID is used
-		SpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8); // CTRL
-		SpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SCID);
-		SpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.SFID);
-		SpiWriteReg(SI4432_TRANSMIT_HEADER_0, EZMacProReg.name.DID);
-	}
+	#ifdef EXTENDED_PACKET_FORMAT
+	// the retransmissions of the MAC use the same sequence number
+	EZMacProTxAttempts = 1;
+	// DID can be changed while the packet is sent, the ACK belongs to this peer
+	AckRttDid = EZMacProReg.name.DID;
+		#ifdef TRANSCEIVER_OPERATION
+	// the radio is set to the data rate and the TX power of the link to DID
+	lacr = EZMacProReg.name.LACR;
+	if (lacr)
+		rate = macLinkTransmit();
 	else
-	{	// if CID is not used
-		SpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8); // CTRL
-		SpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SFID);
-		SpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.DID);
+		rate = 0;
+		#endif
+	// the headers of the bulk transfer frames are set by macBulkLoad()
+	if (BulkTxLength == 0)
+	{
+		// Assemble the CTRL byte
+		#ifdef TRANSCEIVER_OPERATION
+		// the requested data rate is sent instead of the radius
+		if (lacr & LACR_RATE)
+			temp8 = rate;
+		else
+		#endif
+			// set radius field
+			temp8 = (EZMacProReg.name.MCR >> 3) & 0x03;
+		if (EZMacProReg.name.TCR & 0x80)
+			temp8 |= 0x04;		//ACK request
+		// set the Sequence number of the destination
+		temp8 |= (macSequenceNext(EZMacProReg.name.DID) << 4);
+
+		// set the transmit headers
+		if (EZMacProReg.name.MCR & 0x80)
+		{	// if CID is used
+			SpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8); // CTRL
+			SpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SCID);
+			SpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.SFID);
+			SpiWriteReg(SI4432_TRANSMIT_HEADER_0, EZMacProReg.name.DID);
+		}
+		else
+		{	// if CID is not used
+			SpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8); // CTRL
+			SpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SFID);
+			SpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.DID);
+		}
 	}
 	#endif
 
@@ -490,6 +834,7 @@ MacParams EZMacPRO_Transmit(void)
 		macSetEnable2(SI4432_ENRSSI);		// enable RSSI interrupt
 		EZMacProLBT_Retrys = 0;				//clear the LBT variable
 		BusyLBT = 0;
+		CsmaBE = CSMA_MIN_BE;				// a new packet starts from the minimum contention window
 											// go to next state
 		EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_LBT_START_LISTEN;
 		EZMacPRO_StateTxEntered();			// Call the TX state entered callback.
@@ -516,8 +861,94 @@ MacParams EZMacPRO_Transmit(void)
 	macSetFunction1 (SI4432_TXON | SI4432_XTON);	// enable TX
 	return MAC_OK;
 }
+
+MacParams EZMacPRO_Transmit(void)
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macTransmit();
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
 #endif // RECEIVER_ONLY_OPERATION not defined
 //------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Bulk_Transmit()
+//						It starts a bulk transfer of the message to DID. The message is cut into
+//						fragments, a frame is MPL bytes (PLEN bytes in static payload length mode) and it
+//						starts with the fragment header (BULK_FRAGMENT_HEADER_SIZE bytes: the number of the
+//						message, the offset of the fragment and the length of the message). The frames of a window (BULK_WINDOW_SIZE
+//						frames) are sent back-to-back without ACK, only the last one requests an ACK.
+//						The receiver answers with a block ACK, its payload is the bitmap of the received
+//						frames of the window (2 bytes, LSB first). The missing frames are sent again in
+//						the next round, a window is given up after the RTCR retransmissions (rounds) like
+//						a single packet.
+//						The frames are marked by the ACK and ACKREQ bits of the control byte, the sequence
+//						number is the index of the frame in the window. The receiver reassembles the
+//						message and calls the BulkReceived callback, see EZMacPRO_Bulk_Read(). It has to
+//						go back to RX after a packet (SECR).
+//						The message has to be kept until the PacketSent or the AckTimeout callback, the
+//						parameter of the callbacks is the number of the rounds of the last window.
+//						EZMAC PRO has to be in IDLE mode when calling this function.
+//
+// Return Values:	MAC_OK: the transfer started correctly.
+//					STATE_ERROR: the operation ignored, because the EZMAC PRO was not in IDLE mode.
+//					VALUE_ERROR: the message is empty or longer than BULK_MESSAGE_SIZE, or the frame
+//								 size is too small for the fragment header.
+//					INCONSISTENT_SETTING: the AFCH is enabled in TCR.
+//
+// Parameters:		length: payload length
+//					payload: payload content
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+static MacParams macBulkTransmit(U16 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	U8 size;
+	U16 frames;
+
+	// if the MAC is not in Idle state
+	if (EZMacProReg.name.MSR != EZMAC_PRO_IDLE)
+		 return STATE_ERROR;
+
+	size = (EZMacProReg.name.MCR & 0x04) ? EZMacProReg.name.MPL : EZMacProReg.name.PLEN;
+	if (length == 0 || length > BULK_MESSAGE_SIZE || size <= BULK_FRAGMENT_HEADER_SIZE)
+		return VALUE_ERROR;
+	// the message bytes of a frame
+	size -= BULK_FRAGMENT_HEADER_SIZE;
+	#ifdef FOUR_CHANNEL_IS_USED
+	// the frames are not repeated on the four channels
+	if (EZMacProReg.name.TCR & 0x04)
+		return INCONSISTENT_SETTING;
+	#endif
+
+	BulkTxBuf = payload;
+	BulkTxLength = length;
+	// the first window, the toggle changes with every window
+	frames = (length + size - 1) / size;
+	BulkTxBase = 0;
+	BulkTxCount = (frames < BULK_WINDOW_SIZE) ? (U8)frames : BULK_WINDOW_SIZE;
+	BulkTxPending = (U16)(((U32)1 << BulkTxCount) - 1);
+	BulkTxNext = 0;
+	BulkTxToggle ^= BULK_CTRL_TOGGLE;
+	BulkTxMessage++;
+
+	macBulkLoad();
+	return macTransmit();
+}
+
+MacParams EZMacPRO_Bulk_Transmit(U16 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macBulkTransmit(length, payload);
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
+#endif //EXTENDED_PACKET_FORMAT
+//------------------------------------------------------------------------------------------------
 // Function Name : EZMacPRO_Receive()
 //						 It starts searching for a new packet on the defined frequencies. If the receiver finds
 //						 RF activity on a channel, it tries to receive and process the packet.
@@ -530,7 +961,7 @@ MacParams EZMacPRO_Transmit(void)
 //											EZMAC PRO was not in IDLE mode.
 //-----------------------------------------------------------------------------------------------
 #ifndef TRANSMITTER_ONLY_OPERATION
-MacParams EZMacPRO_Receive(void)
+static MacParams macReceive(void)
 {
 	U8 temp8;
 	if (EZMacProReg.name.MSR != EZMAC_PRO_IDLE)
@@ -572,12 +1003,23 @@ MacParams EZMacPRO_Receive(void)
 	}
 	#endif
 
+	#ifdef TRANSCEIVER_OPERATION
+		#ifdef EXTENDED_PACKET_FORMAT
+	// listen at the data rate of the last peer
+	if (EZMacProReg.name.LACR & LACR_RATE)
+		macLinkReceive();
+		#endif
+	#endif
+
 	SpiWriteReg (SI4432_INTERRUPT_ENABLE_1, 0x00);	// disable Interrupt Enable 1
 	macSetEnable2(SI4432_ENPREAVAL);					// enable preamble valid interrupt
 
 	#ifdef MORE_CHANNEL_IS_USED
 	SelectedChannel = 0;
 	SpiWriteReg(SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0 + SelectedChannel]);
+		#ifdef FAST_SCAN_ENABLED
+	FastScanDwell = 0;
+		#endif
 	#endif
 
 	// clear interrupt status
@@ -596,11 +1038,22 @@ MacParams EZMacPRO_Receive(void)
 	//Call the RX state entered callback.
 	EZMacPRO_StateRxEntered();
 	
-	macTimeout(TimeoutChannelSearch);			// start timer with channel search timeout
+	macTimeout(SEARCH_TIMEOUT);					// start timer with channel search timeout
 	ENABLE_MAC_INTERRUPTS();
 	macSetFunction1(SI4432_RXON | SI4432_XTON);	// enable RX
 	return MAC_OK;
 }
+
+MacParams EZMacPRO_Receive(void)
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macReceive();
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
 #endif // TRANSMITTER_ONLY_OPERATION
 
 //------------------------------------------------------------------------------------------------
@@ -624,7 +1077,7 @@ MacParams EZMacPRO_Receive(void)
 // Parameters	:	name: MAC register name
 //			 		value: MAC register value
 //-----------------------------------------------------------------------------------------------
-MacParams EZMacPRO_Reg_Write(MacRegs name, U8 value)
+static MacParams macRegWrite(MacRegs name, U8 value)
 {
 	U8 temp8;
 	U8 temp8_2;
@@ -712,6 +1165,12 @@ MacParams EZMacPRO_Reg_Write(MacRegs name, U8 value)
 #else
 			macSpiWriteReg(SI4432_TX_POWER,(temp8 | 0x18));		// revB1
 #endif//B1_ONLY
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+			// the maximum TX power of the links
+			LinkPower = temp8 & 0x07;
+	#endif
+#endif
 			break;
 		case RCR:	// Receiver Control Register
 			if ((value & 0x78) == 0x78)
@@ -834,12 +1293,7 @@ MacParams EZMacPRO_Reg_Write(MacRegs name, U8 value)
 		case RSID:	// Received Sender ID
 			return NAME_ERROR;
 		case DID:	// Destination ID
-			if (EZMacProReg.name.MCR & 0x80)	//if CID is used
-				//save the DID to the Transmit Header1 register of the radio
-				macSpiWriteReg(SI4432_TRANSMIT_HEADER_1, value);
-			else
-				//save the DID to the Transmit Header2 register of the radio
-				macSpiWriteReg(SI4432_TRANSMIT_HEADER_2, value);
+			// the transmit header is set by macTransmit(), the packet being sent is not changed
 			break;
 		case PLEN:	// Payload Length
 			//set the payload length
@@ -857,6 +1311,36 @@ MacParams EZMacPRO_Reg_Write(MacRegs name, U8 value)
 			break;
 		case LBTLR:	// Listen Before Talk Limit Register
 			break;
+	#ifdef EXTENDED_PACKET_FORMAT
+		case RTCR:	// Retransmission Control Register
+			if (value & ~(RTCR_RETRIES | RTCR_BACKOFF))
+				return VALUE_ERROR;
+			break;
+		case LACR:	// Link Adaptation Control Register
+			if (value & ~(LACR_RATE | LACR_POWER))
+				return VALUE_ERROR;
+		#ifdef MAC_TIMER_NO_CLOCK
+			// the data rate of a link would be held for ever without the MAC clock
+			if (value & LACR_RATE)
+				return VALUE_ERROR;
+		#endif
+		#ifdef PACKET_FORWARDING_SUPPORTED
+			// the forwarding needs the radius field, and the ACK can come over other nodes
+			if (value)
+				return VALUE_ERROR;
+		#endif
+		#ifndef B1_ONLY
+			// the data rates and the TX power are switched with the settings of rev B1
+			if (value && (EZMacProReg.name.DTR != 0x02))
+				return VALUE_ERROR;
+		#endif
+			// the links start again at the base data rate and the maximum TX power
+			initLinkTable();
+			macSetLinkRate((EZMacProReg.name.MCR >> 5) & 0x03);
+			if ((value | EZMacProReg.name.LACR) & LACR_POWER)
+				macSetLinkPower((EZMacProReg.name.TCR >> 4) & 0x07);
+			break;
+	#endif
 #endif
 		case LFTMR0:	// Low Frequency Timer Setting Register 0
 			macSpiWriteReg(SI4432_WAKE_UP_TIMER_PERIOD_3, value); //Set Wake-Up-Timer Mantissa
@@ -942,10 +1426,23 @@ MacParams EZMacPRO_Reg_Write(MacRegs name, U8 value)
 	EZMacProReg.array[name] = value;
 	return MAC_OK;
 }
+
+MacParams EZMacPRO_Reg_Write(MacRegs name, U8 value)
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macRegWrite(name, value);
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
 //------------------------------------------------------------------------------------------------
 // Function Name:	EZMacPRO_Reg_Read
 // 						Gives back the value (over value pointer) of the register identified by name.
 //							MacRegs type is predefined. This function may also be called in SLEEP mode.
+//							The receive registers are read one by one, EZMacPRO_Rx_Snapshot() gives
+//							a consistent copy of them.
 // Return Value :	MAC_OK: The operation was succesfull
 //			 		NAME_ERROR: The register name is invalid
 //
@@ -954,7 +1451,7 @@ MacParams EZMacPRO_Reg_Write(MacRegs name, U8 value)
 //
 //
 //-----------------------------------------------------------------------------------------------
-MacParams EZMacPRO_Reg_Read (MacRegs name, U8 *value)
+static MacParams macRegRead(MacRegs name, U8 *value)
 {
 	// This 3 registers are write only
 	if (name > EZ_LASTREG || name == LFTMR0 || name == LFTMR1 || name == LFTMR2)
@@ -985,6 +1482,17 @@ MacParams EZMacPRO_Reg_Read (MacRegs name, U8 *value)
 	return MAC_OK;
 }
 
+MacParams EZMacPRO_Reg_Read(MacRegs name, U8 *value)
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macRegRead(name, value);
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
+
 //------------------------------------------------------------------------------------------------
 // Function Name: EZMacPRO_TxBuf_Write
 //						The function copies length number of payload bytes into the transmit FIFO of the radio chip.
@@ -1008,7 +1516,7 @@ MacParams EZMacPRO_Reg_Read (MacRegs name, U8 *value)
 //
 //-----------------------------------------------------------------------------------------------
 #ifndef RECEIVER_ONLY_OPERATION
-MacParams EZMacPRO_TxBuf_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+static MacParams macTxBufWrite(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
 {
 	U8 temp8;
 
@@ -1053,16 +1561,27 @@ MacParams EZMacPRO_TxBuf_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8,
 	}
 	return MAC_OK;
 }
+
+MacParams EZMacPRO_TxBuf_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macTxBufWrite(length, payload);
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
 #endif //RECEIVER_ONLY_OPERATION not defined
 
 //------------------------------------------------------------------------------------------------
 // Function Name: EZMacPRO_RxBuf_Read
 //						After a successful packet reception EZMAC PRO copies the received data bytes into
-//						the receive data buffer. The receive data buffer is declared in the EZMacPro.c file as
-//						SEGMENT_VARIABLE(RxBuffer[RECEIVED_BUFFER_SIZE], U8, BUFFER_MSPACE);
-//						The length of the receive buffer is defined by the RECEIVED_BUFFER_SIZE definition in the
+//						a frame taken from the frame pool (see EZMacPro_FramePool.c), the handle of the frame
+//						is kept in RxFrame until the next packet is received.
+//						The length of the frames is defined by the RECEIVED_BUFFER_SIZE definition in the
 //						EZMacPro_defs.h. It can be adjusted for the application needs, but it can not be greater than 64bytes.
-//						The receive buffer is declared to be placed into the XDATA memory, it also can be adjusted by
+//						The frames are declared to be placed into the XDATA memory, it also can be adjusted by
 //						changing the BUFFER_MSPACE definition. Upon calling the EZMacPRO_RxBuf_Read() function, it
 //						copies received data from the receive data buffer to payload. Also it gives back the number of
 //						received bytes by length.
@@ -1076,48 +1595,155 @@ MacParams EZMacPRO_TxBuf_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8,
 //
 //-----------------------------------------------------------------------------------------------
 #ifndef TRANSMITTER_ONLY_OPERATION
-MacParams EZMacPRO_RxBuf_Read(VARIABLE_SEGMENT_POINTER(length, U8, BUFFER_MSPACE), VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+static MacParams macRxBufRead(VARIABLE_SEGMENT_POINTER(length, U8, BUFFER_MSPACE), VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
 {
 	U8 temp8 = 0;
+	U8 frame = RxFrame;
+
+	// nothing has been received yet
+	if (frame == FRAME_POOL_INVALID)
+	{
+		*length = 0;
+		return MAC_OK;
+	}
+
 	*length = EZMacProReg.name.PLEN;
 	while (temp8 < EZMacProReg.name.PLEN)
 	{
-		*payload++ = RxBuffer[temp8];
+		*payload++ = FRAME_POOL_BUFFER(frame)[temp8];
 		temp8++;
 	}
 	return MAC_OK;
 }
+
+MacParams EZMacPRO_RxBuf_Read(VARIABLE_SEGMENT_POINTER(length, U8, BUFFER_MSPACE), VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macRxBufRead(length, payload);
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
 #endif // TRANSMITTER_ONLY_OPERATION not defined
 
 //------------------------------------------------------------------------------------------------
-// Function Name:	EZMacPRO_Ack_Write()
+// Function Name: EZMacPRO_Bulk_Read
+//						It copies the last complete message of a bulk transfer (see EZMacPRO_Bulk_Transmit())
+//						to payload and gives back its length. The fragments are reassembled in a buffer of
+//						BULK_MESSAGE_SIZE bytes, the message is kept until the first fragment of the next
+//						message is received, the BulkReceived callback signals a new one. A message
+//						without a fragment for BULK_REASSEMBLY_TIMEOUT_MS is dropped. The fragments of
+//						another sender are not acknowledged while a message is being reassembled.
+//						The payload has to be BULK_MESSAGE_SIZE bytes long.
 //
-//					The function copies length number of bytes into the Acknowledgement buffer.
-//					Length should not be greater than ACK_BUFFER_SIZE otherwise STATE_ERROR is returned.
-//					In dynamic packet length mode the payload size is set to length.
-//					In fixed packet length mode, if length is smaller than PLEN, then the remaining bytes
-//					are filled with zeros. Otherwise only PLEN number of bytes are copied.
-//					The function should exclusively be used in the EZMacPRO_AckSending() callback to
-//					put custom data in the AckBuffer just before its content is pushed into the transmit
-//					FIFO.
+// Return Values:	MAC_OK: The operation was succesfull, length is 0 if no complete message is kept.
 //
-// Return Values:	MAC_OK: The operation performed correctly.
-//					STATE_ERROR: The operation is ignored as the statemachine is not in receive state.
+// Parameters:		length: message length
+//					payload: message content
 //
-// Parameters:		length: payload length
+//-----------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+#ifndef TRANSMITTER_ONLY_OPERATION
+static MacParams macBulkRead(VARIABLE_SEGMENT_POINTER(length, U16, BUFFER_MSPACE), VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	U16 i;
+
+	// nothing has been received yet or the message is incomplete
+	if (BulkRxLength == 0 || BulkRxReceived != BulkRxLength)
+	{
+		*length = 0;
+		return MAC_OK;
+	}
+
+	*length = BulkRxLength;
+	for (i = 0; i < BulkRxLength; i++)
+		*payload++ = BulkRxBuf[i];
+	return MAC_OK;
+}
+
+MacParams EZMacPRO_Bulk_Read(VARIABLE_SEGMENT_POINTER(length, U16, BUFFER_MSPACE), VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macBulkRead(length, payload);
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
+#endif // TRANSMITTER_ONLY_OPERATION not defined
+#endif //EXTENDED_PACKET_FORMAT
+
+//------------------------------------------------------------------------------------------------
+// Function Name: EZMacPRO_Rx_Snapshot
+//						Gives back a consistent copy of the metadata of the last received packet and
+//						the MAC status. It does not disable the interrupts and does not access the radio,
+//						the RSSI is the value latched at the reception. It can be called from the main
+//						thread and from the callbacks.
+//
+// Return Values:	None
+//
+// Parameters:		meta: the copy
+//
+// Notes:
+//
+// The MAC interrupts publish the metadata with a latched sequence counter: the counter is
+// incremented, the copy not selected by its low bit is written, then the same is done for the
+// other copy. The reader takes the copy selected by the counter and retries if the counter
+// changed meanwhile. A reader never waits for the writer, even if it has interrupted it.
+//
+//-----------------------------------------------------------------------------------------------
+#ifndef TRANSMITTER_ONLY_OPERATION
+void EZMacPRO_Rx_Snapshot(VARIABLE_SEGMENT_POINTER(meta, EZMacProRxMeta, APPLICATION_MSPACE))
+{
+	U8 seq;
+
+	do
+	{
+		seq = RxMetaSeq;
+		*meta = RxMeta[seq & 0x01];
+		meta->msr = EZMacProReg.name.MSR;
+	} while (seq != RxMetaSeq);
+}
+#endif // TRANSMITTER_ONLY_OPERATION not defined
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Ack_Write()
+//
+//					The function copies length number of bytes into the Acknowledgement buffer.
+//					Length should not be greater than ACK_BUFFER_SIZE otherwise STATE_ERROR is returned.
+//					In dynamic packet length mode the payload size is set to length.
+//					In fixed packet length mode, if length is smaller than PLEN, then the remaining bytes
+//					are filled with zeros. Otherwise only PLEN number of bytes are copied.
+//					The function should exclusively be used in the EZMacPRO_AckSending() callback to
+//					put custom data in the AckFrame just before its content is pushed into the transmit
+//					FIFO.
+//
+// Return Values:	MAC_OK: The operation performed correctly.
+//					STATE_ERROR: The operation is ignored as the statemachine is not in receive state.
+//
+// Parameters:		length: payload length
 //			 		payload: payload content
 //
 //-----------------------------------------------------------------------------------------------
 #ifdef TRANSCEIVER_OPERATION
 #ifdef EXTENDED_PACKET_FORMAT
-MacParams EZMacPRO_Ack_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+static MacParams macAckWrite(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
 {
 	U8 temp8 = 0;
+	VARIABLE_SEGMENT_POINTER(ackBuffer, U8, BUFFER_MSPACE);
 
 	// state check: if not in RX state -> error
 	if (!(EZMacProReg.name.MSR & RX_STATE_BIT))
 		return STATE_ERROR;
 
+	// the ACK frame is allocated only while the EZMacPRO_AckSending() callback is running
+	if (AckFrame == FRAME_POOL_INVALID)
+		return STATE_ERROR;
+	ackBuffer = FRAME_POOL_BUFFER(AckFrame);
+
 	// if length is bigger than the ACK_BUFFER_SIZE
 	if (length > ACK_BUFFER_SIZE)
 		return VALUE_ERROR;
@@ -1126,46 +1752,119 @@ MacParams EZMacPRO_Ack_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BU
 	if (EZMacProReg.name.MCR & 0x04)
 	{	// set the transmit packet length
 		macSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH,length);
+		AckBufSize = length;
 
-		// load AckBuffer
+		// load ACK frame
 		for (temp8 = 0; temp8 < length; temp8++)
-			AckBuffer[temp8] = payload[temp8];
+			ackBuffer[temp8] = payload[temp8];
 	}
 	else
 	{	// if static payload length mode is set
 		// if fix packet length is greater than ack buffer size
 		if (EZMacProReg.name.PLEN > ACK_BUFFER_SIZE)
-		{	// load AckBuffer
+		{	// load ACK frame
 			for (temp8 = 0; temp8 < length; temp8++)
-				AckBuffer[temp8] = payload[temp8];
+				ackBuffer[temp8] = payload[temp8];
 			// fill the remaining bytes with zero
 			for (temp8 = length; temp8 < ACK_BUFFER_SIZE; temp8++)
-				AckBuffer[temp8] = 0x00;
+				ackBuffer[temp8] = 0x00;
 		}
 		else
 		{	// if fix packet length is smaller or equal than ack buffer size
 			// if payload length smaller than the fix payload length
 			if (length < EZMacProReg.name.PLEN)
-			{	// load AckBuffer
+			{	// load ACK frame
 				for (temp8 = 0; temp8 < length; temp8++)
-					AckBuffer[temp8] = payload[temp8];
+					ackBuffer[temp8] = payload[temp8];
 				// fill the remaining bytes with zero
 				for (temp8 = length; temp8 < EZMacProReg.name.PLEN; temp8++)
-					AckBuffer[temp8] = 0x00;
+					ackBuffer[temp8] = 0x00;
 			}
 			else
 			{	// if the payload length equal or bigger than the fix payload length
-				// load AckBuffer
+				// load ACK frame
 				for (temp8 = 0; temp8 < EZMacProReg.name.PLEN; temp8++)
-					AckBuffer[temp8] = payload[temp8];
+					ackBuffer[temp8] = payload[temp8];
 			}
 		}
 	}
 	return MAC_OK;
 }
+
+MacParams EZMacPRO_Ack_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	MacParams status;
+	U8 critical;
+
+	MAC_CRITICAL_ENTER(critical);
+	status = macAckWrite(length, payload);
+	MAC_CRITICAL_EXIT(critical);
+	return status;
+}
 #endif
 #endif
 
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Boot_Mark()
+//					Records the MAC timer when a boot phase is reached for the first time. The
+//					time from reset to the first packet is BootTime[EZMAC_BOOT_FIRST_TX] plus the
+//					start-up code before BoardInit(). A phase not reached yet is 0, it stays 0 if
+//					the port has no free running MAC timer.
+//
+// Return Value :	None
+// Parameters	:	phase - EZMacProBootPhase
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Boot_Mark(U8 phase)
+{
+	if (BootTime[phase] == 0)
+		BootTime[phase] = MAC_TIMER_NOW();
+}
+
+#ifdef EZMACPRO_CONTEXT
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Context_Init()
+//						Clears a stack context. EZMacPRO_Init() has to be called with the context
+//						selected before it is used.
+//
+// Return Value :	None
+// Parameters	:	ctx - the context
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Context_Init(volatile EZMacProContext *ctx)
+{
+	volatile U8 *p = (volatile U8 *)ctx;
+	U16 i;
+
+	for (i = 0; i < sizeof(EZMacProContext); i++)
+		p[i] = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Context_Select()
+//						Selects the context the API functions and the MAC interrupts work on. The
+//						interrupt handler of a radio selects its context on entry and restores the
+//						previous one on exit, the main thread selects it before the API calls.
+//						The frame pool, the event queue, the tasks and the software timers are
+//						shared by the contexts.
+//
+// Return Value :	the previously selected context
+// Parameters	:	ctx - the context, NULL selects the default context
+//------------------------------------------------------------------------------------------------
+volatile EZMacProContext *EZMacPRO_Context_Select(volatile EZMacProContext *ctx)
+{
+	volatile EZMacProContext *prev;
+	U8 critical;
+
+	if (ctx == NULL)
+		ctx = &EZMacProDefaultContext;
+
+	MAC_CRITICAL_ENTER(critical);
+	prev = EZMacProCtx;
+	EZMacProCtx = ctx;
+	MAC_CRITICAL_EXIT(critical);
+	return prev;
+}
+#endif //EZMACPRO_CONTEXT
+
 				/* ======================================= *
 				 *		L O C A L	F U N C T I O N S		*
 				 * ======================================= */
@@ -1301,6 +2000,12 @@ void SetRfParameters(U8 mcr)
 	macSpiWriteReg(SI4432_HEADER_CONTROL_2, (temp8 | Parameters[dataRate][PREAMBLE_LENGTH_REG_VALUE1]));
 	macSpiWriteReg(SI4432_PREAMBLE_LENGTH, Parameters[dataRate][PREAMBLE_LENGTH_REG_VALUE2]);
 #endif
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+	// the modem runs at the base data rate
+	LinkRate = dataRate;
+	#endif
+#endif
 }
 
 //------------------------------------------------------------------------------------------------
@@ -1402,6 +2107,9 @@ void macUpdateDynamicTimeouts(U8 mcr, U8 mpl)
 	#endif
 	#ifdef MORE_CHANNEL_IS_USED
 	TimeoutChannelSearch = (byteTime/8) * Parameters[n][SEARCH_TIME];
+		#ifdef FAST_SCAN_ENABLED
+	TimeoutFastScan = FAST_SCAN_TIMEOUT(byteTime);
+		#endif
 	#endif
 
 	// calculate TimeoutRX_Packet using mpl
@@ -1434,6 +2142,15 @@ void macUpdateDynamicTimeouts(U8 mcr, U8 mpl)
 	if (n)
 		TimeoutACK = ((n + 1) * TimeoutACK) + (n * TimeoutTX_Packet) + (n * MAX_LBT_WAITING_TIME * MAX_LBT_RETRIES);
 	#endif
+	// the measured round-trip times can shorten the wait to the quarter of the fixed timeout,
+	// the times measured with the old settings are not valid
+	TimeoutACKMin = TimeoutACK / 4;
+	initAckRttTable();
+	#ifdef TRANSCEIVER_OPERATION
+	// the timeouts belong to the base data rate, the links start again from it
+	initLinkTable();
+	macSetLinkRate((mcr >> 5) & 0x03);
+	#endif
 #endif
 }
 
@@ -1453,8 +2170,450 @@ void initForwardedPacketTable (void)
 		ForwardedPacketTable[i].seq = 0xFF;
 		ForwardedPacketTable[i].chan = 0xFF;
 	}
+	ForwardedPacketNext = 0;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------
+// Function Name: initChannelQuality
+//						This function forgets the quality of the frequency channels.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+#ifdef CHANNEL_QUALITY_ENABLED
+void initChannelQuality (void)
+{
+	U8 i;
+	for (i = 0; i < CHANNEL_QUALITY_SIZE; i++)
+	{
+		ChannelQuality[i].noise = 0;
+		ChannelQuality[i].crc = 0;
+		ChannelQuality[i].ok = 0;
+		ChannelQuality[i].score = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macChannelSelect
+//						This function replaces a blacklisted TX channel with the channel of the lowest
+//						score, the receivers find it by the channel search. In FOUR_CHANNEL mode the
+//						masked channels are not used, and the channel is kept if the search is
+//						disabled in RCR.
+// Return Value : U8 - index of the frequency register of the transmission
+// Parameters	: ch - index of the frequency register selected by FSR
+//------------------------------------------------------------------------------------------------
+U8 macChannelSelect (U8 ch)
+{
+	U8 i;
+	U8 count;
+	U8 best;
+
+	if (ChannelQuality[ch].score < CHANNEL_BLACKLIST)
+		return ch;
+#ifdef FOUR_CHANNEL_IS_USED
+	if (!(EZMacProReg.name.RCR & 0x04))
+		return ch;
+	count = 4;
+#endif
+#ifdef MORE_CHANNEL_IS_USED
+	count = maxChannelNumber;
+#endif
+
+	best = ch;
+	for (i = 0; i < count; i++)
+	{
+#ifdef FOUR_CHANNEL_IS_USED
+		if (EZMacProReg.name.RCR & (0x08 << i))
+			continue;
+#endif
+		if (ChannelQuality[i].score < ChannelQuality[best].score)
+			best = i;
+	}
+	return best;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------
+// Function Name: initAckRttTable
+//						This function forgets the measured ACK round-trip times.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+void initAckRttTable (void)
+{
+	U8 i;
+	for (i = 0; i < ACK_RTT_TABLE_SIZE; i++)
+	{
+		AckRttTable[i].srtt = 0;
+		AckRttTable[i].rttvar = 0;
+	}
+	AckRttNext = 0;
+	AckRttEntry = ACK_RTT_TABLE_SIZE;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------
+// Function Name: initSequenceTable
+//						This function forgets the sequence numbers of the destinations.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+void initSequenceTable (void)
+{
+	U8 i;
+	for (i = 0; i < SEQUENCE_TABLE_SIZE; i++)
+		SequenceTable[i].seq = 0xFF;
+	SequenceNext = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macSequenceNext
+//						This function returns the next sequence number of the packets sent to
+//						the destination. The receivers keep the last sequence number of every
+//						sender and destination, so a packet to another node does not make the
+//						next packet to this destination look like a retransmission. A new
+//						destination replaces the entries in turn, it starts from the common
+//						EZMacProSequenceNumber counter.
+// Return Value : U8 seq - sequence number (0-15)
+// Parameters	: U8 did - destination ID
+//------------------------------------------------------------------------------------------------
+U8 macSequenceNext (U8 did)
+{
+	U8 i;
+
+	for (i = 0; i < SEQUENCE_TABLE_SIZE; i++)
+	{
+		if (SequenceTable[i].seq != 0xFF && SequenceTable[i].did == did)
+		{
+			SequenceTable[i].seq = (SequenceTable[i].seq + 1) & 0x0F;
+			return SequenceTable[i].seq;
+		}
+	}
+
+	// the first packet to the destination
+	EZMacProSequenceNumber = (EZMacProSequenceNumber + 1) & 0x0F;
+	i = SequenceNext;
+	if (++SequenceNext >= SEQUENCE_TABLE_SIZE)
+		SequenceNext = 0;
+	SequenceTable[i].did = did;
+	SequenceTable[i].seq = EZMacProSequenceNumber;
+	return EZMacProSequenceNumber;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------
+// Function Name: initLinkTable
+//						This function forgets the data rates of the peers.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+void initLinkTable (void)
+{
+	U8 i;
+	for (i = 0; i < LINK_TABLE_SIZE; i++)
+		LinkTable[i].rate = 0xFF;
+	LinkNext = 0;
+	LinkEntry = LINK_TABLE_SIZE;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macLinkRateDelta
+//						This function marks the columns of RfSettingsB1 that differ between every
+//						two data rates, a data rate switch writes only these registers.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+void macLinkRateDelta (void)
+{
+	U8 from;
+	U8 to;
+	U8 i;
+	U16 delta;
+
+	for (from = 0; from < 4; from++)
+	{
+		for (to = 0; to < 4; to++)
+		{
+			delta = 0;
+			for (i = 0; i < NUMBER_OF_PARAMETER_B1; i++)
+				if (LinkRateReg[i] != 0 && RfSettingsB1[from][i] != RfSettingsB1[to][i])
+					delta |= (U16)1 << i;
+			LinkRateDelta[from][to] = delta;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macSetLinkRate
+//						This function switches the modem to the data rate of a link. Only the modem
+//						registers that differ from the current data rate are written, plus the
+//						preamble and the search timing of the data rate. The frequency plan and the
+//						packet timeouts of the base data rate (MCR) are kept, they are valid for the
+//						faster data rates too.
+// Return Value : None
+// Parameters	: rate - data rate (MCR bits 6:5 format)
+//------------------------------------------------------------------------------------------------
+void macSetLinkRate (U8 rate)
+{
+	U8 i;
+	U8 preamble;
+	U16 delta;
+
+	if (rate == LinkRate)
+		return;
+
+	delta = LinkRateDelta[LinkRate][rate];
+	for (i = 0; i < NUMBER_OF_PARAMETER_B1; i++)
+		if (delta & ((U16)1 << i))
+			macSpiWriteReg(LinkRateReg[i], RfSettingsB1[rate][i]);
+	macSpiWriteReg(SI4432_PREAMBLE_DETECTION_CONTROL, (Parameters[rate][PREAMBLE_DETECTION_THRESHOLD]<<3)|0x02);
+#ifdef FOUR_CHANNEL_IS_USED
+	preamble = Parameters[rate][PREAMBLE_IF_ONE_CHANNEL + (EZMacProReg.name.MCR & 0x03)];
+	macSpiWriteReg(SI4432_PREAMBLE_LENGTH, preamble<<1);
+	TimeoutChannelSearch = EZMacProByteTime[rate] * Parameters[rate][SEARCH_TIME];
+#endif
+#ifdef MORE_CHANNEL_IS_USED
+	preamble = Parameters[rate][PREAMBLE_LENGTH];
+	macSpiWriteReg(SI4432_PLL_TUNE_TIME, Parameters[rate][PLL_TUNE_TIME_REG_VALUE]);
+	macSpiWriteReg(SI4432_PREAMBLE_LENGTH, Parameters[rate][PREAMBLE_LENGTH_REG_VALUE2]);
+	TimeoutChannelSearch = (EZMacProByteTime[rate]/8) * Parameters[rate][SEARCH_TIME];
+	#ifdef FAST_SCAN_ENABLED
+	TimeoutFastScan = FAST_SCAN_TIMEOUT(EZMacProByteTime[rate]);
+	#endif
+#endif
+	TimeoutSyncWord = (preamble + 2) * (U32)EZMacProByteTime[rate];
+	LinkRate = rate;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macSetLinkPower
+//						This function sets the TX power of the radio (rev B1) if it differs.
+// Return Value : None
+// Parameters	: power - TX power (TCR bits 6:4 format)
+//------------------------------------------------------------------------------------------------
+void macSetLinkPower (U8 power)
+{
+	if (power == LinkPower)
+		return;
+	macSpiWriteReg(SI4432_TX_POWER, (power | 0x18));
+	LinkPower = power;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macLinkEntry
+//						This function returns the link entry of a peer. A new peer replaces the
+//						entries in turn, it starts at the base data rate.
+// Return Value : U8 - index of the entry in LinkTable
+// Parameters	: did - ID of the peer
+//------------------------------------------------------------------------------------------------
+U8 macLinkEntry (U8 did)
+{
+	U8 i;
+
+	for (i = 0; i < LINK_TABLE_SIZE; i++)
+		if (LinkTable[i].rate != 0xFF && LinkTable[i].did == did)
+			return i;
+
+	i = LinkNext;
+	if (++LinkNext >= LINK_TABLE_SIZE)
+		LinkNext = 0;
+	LinkTable[i].did = did;
+	LinkTable[i].rate = (EZMacProReg.name.MCR >> 5) & 0x03;
+	LinkTable[i].rssi = 0;
+	LinkTable[i].acks = 0;
+	LinkTable[i].fails = 0;
+	LinkTable[i].power = (EZMacProReg.name.TCR >> 4) & 0x07;
+	// the modems of the peers are not switched yet
+	LinkTable[i].stamp = MAC_TIMER_NOW() - LINK_RATE_HOLD;
+	return i;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macLinkTransmit
+//						This function sets the modem to the data rate of the link to DID before a
+//						transmission. The peer listens at the data rate of the link for LINK_RATE_HOLD
+//						after the last exchange, the packet is sent at it in the first half of this
+//						time and at the base data rate after it. The broadcast packets and the bulk
+//						transfer frames are sent at the base data rate. With LACR_POWER the TX power of
+//						the link is set too, limited by TCR, the broadcast packets and the bulk transfer
+//						frames are sent at the TCR power.
+// Return Value : U8 - the data rate requested from the peer: the next one after
+//						LINK_RATE_UP_ACKS acknowledged packets, the one of the link otherwise
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+U8 macLinkTransmit (void)
+{
+	U8 rate;
+	U8 power;
+
+	rate = (EZMacProReg.name.MCR >> 5) & 0x03;
+	power = (EZMacProReg.name.TCR >> 4) & 0x07;
+	if ((EZMacProReg.name.DID == 255) || (BulkTxLength != 0))
+	{
+		LinkEntry = LINK_TABLE_SIZE;
+		macSetLinkRate(rate);
+		if (EZMacProReg.name.LACR & LACR_POWER)
+			macSetLinkPower(power);
+		return rate;
+	}
+
+	LinkEntry = macLinkEntry(EZMacProReg.name.DID);
+	if (EZMacProReg.name.LACR & LACR_POWER)
+	{
+		if (LinkTable[LinkEntry].power < power)
+			power = LinkTable[LinkEntry].power;
+		macSetLinkPower(power);
+	}
+	if ((MAC_TIMER_NOW() - LinkTable[LinkEntry].stamp) < LINK_RATE_HOLD / 2)
+		rate = LinkTable[LinkEntry].rate;
+	macSetLinkRate(rate);
+	rate = LinkTable[LinkEntry].rate;
+	if ((rate < 3) && (LinkTable[LinkEntry].acks >= LINK_RATE_UP_ACKS))
+		rate++;
+	return rate;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macLinkReceive
+//						This function sets the modem to the data rate of the last peer before a
+//						reception, to the base data rate if there is no peer or its link has expired.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+void macLinkReceive (void)
+{
+	if ((LinkEntry < LINK_TABLE_SIZE) && ((MAC_TIMER_NOW() - LinkTable[LinkEntry].stamp) < LINK_RATE_HOLD))
+		macSetLinkRate(LinkTable[LinkEntry].rate);
+	else
+		macSetLinkRate((EZMacProReg.name.MCR >> 5) & 0x03);
+}
+	#endif //EXTENDED_PACKET_FORMAT
+#endif //TRANSCEIVER_OPERATION
+
+//------------------------------------------------------------------------------------------------
+// Function Name: initBulkTransfer
+//						This function cancels the bulk transfers, drops the message being reassembled
+//						and clears the frame counter.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+void initBulkTransfer (void)
+{
+	BulkTxLength = 0;
+	BulkTxToggle = 0;
+	BulkTxMessage = 0;
+	BulkTxFrames = 0;
+	#ifndef TRANSMITTER_ONLY_OPERATION
+	BulkRxSid = 0xFF;
+	BulkRxToggle = 0xFF;
+	BulkRxMap = 0;
+	BulkRxMessage = 0;
+	BulkRxLength = 0;
+	BulkRxReceived = 0;
+	#endif
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name: macBulkLoad
+//						This function writes the next unacknowledged frame of the bulk transfer
+//						window to the TX FIFO and sets the headers. The last unacknowledged frame of
+//						the window requests the block ACK.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+void macBulkLoad (void)
+{
+	U8 index;
+	U8 ctrl;
+	U8 size;
+	U8 temp8;
+	U16 offset;
+
+	for (index = BulkTxNext; (BulkTxPending & ((U16)1 << index)) == 0; index++);
+
+	ctrl = (index << 4) | BULK_CTRL_MARK | BulkTxToggle;
+	if ((BulkTxPending >> index) == 1)
+	{	// no more frames in this round
+		ctrl |= BULK_CTRL_LAST;
+		BulkTxNext = BULK_WINDOW_SIZE;
+	}
+	else
+		BulkTxNext = index + 1;
+
+	size = ((EZMacProReg.name.MCR & 0x04) ? EZMacProReg.name.MPL : EZMacProReg.name.PLEN) - BULK_FRAGMENT_HEADER_SIZE;
+	offset = (BulkTxBase + index) * size;
+
+	// clear TX FIFO
+	temp8 = macSpiReadReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2);
+	temp8 |= SI4432_FFCLRTX;
+	macSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+	temp8 &= ~SI4432_FFCLRTX;
+	macSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+
+	// set the transmit headers
+	if (EZMacProReg.name.MCR & 0x80)
+	{	// if CID is used
+		macSpiWriteReg(SI4432_TRANSMIT_HEADER_3, ctrl);
+		macSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SCID);
+		macSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.SFID);
+		macSpiWriteReg(SI4432_TRANSMIT_HEADER_0, EZMacProReg.name.DID);
+	}
+	else
+	{	// if CID is not used
+		macSpiWriteReg(SI4432_TRANSMIT_HEADER_3, ctrl);
+		macSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SFID);
+		macSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.DID);
+	}
+
+	// the last fragment of the message can be shorter
+	temp8 = ((BulkTxLength - offset) < size) ? (U8)(BulkTxLength - offset) : size;
+	if (EZMacProReg.name.MCR & 0x04)
+		// if dynamic payload length mode is set
+		macSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH, temp8 + BULK_FRAGMENT_HEADER_SIZE);
+	// the fragment header
+	macSpiWriteReg(SI4432_FIFO_ACCESS, BulkTxMessage);
+	macSpiWriteReg(SI4432_FIFO_ACCESS, (U8)offset);
+	macSpiWriteReg(SI4432_FIFO_ACCESS, (U8)(offset >> 8));
+	macSpiWriteReg(SI4432_FIFO_ACCESS, (U8)BulkTxLength);
+	macSpiWriteReg(SI4432_FIFO_ACCESS, (U8)(BulkTxLength >> 8));
+	macSpiWriteFIFO(temp8, BulkTxBuf + offset);
+	if ((EZMacProReg.name.MCR & 0x04) == 0)
+	{	// if static payload length mode is set, fill the remain payload bytes with zero
+		for (; temp8 < size; temp8++)
+			macSpiWriteReg(SI4432_FIFO_ACCESS, 0x00);
+	}
+	BulkTxFrames++;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------
+// Function Name: initDuplicateCache
+//						This function forgets the senders and clears the duplicate counter.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+#ifndef TRANSMITTER_ONLY_OPERATION
+void initDuplicateCache (void)
+{
+	U8 i;
+	for (i = 0; i < DUPLICATE_CACHE_SIZE; i++)
+	{
+		DuplicateCache[i].sid = 0xFF;
+		DuplicateCache[i].did = 0xFF;
+		DuplicateCache[i].seq = 0xFF;
+	}
+	DuplicateCacheNext = 0;
+	RxDuplicate = 0;
+	RxDuplicateCount = 0;
 }
 #endif
+#endif
 
 //------------------------------------------------------------------------------------------------
 // Function Name: macSetEnable2
@@ -1488,6 +2647,40 @@ void macSetFunction1(U8 value)
 	macSpiWriteReg(SI4432_OPERATING_AND_FUNCTION_CONTROL_1, value);
 }
 
+//------------------------------------------------------------------------------------------------
+// Function Name: macRandomSeed
+//						This function seeds the random number generator. The low bits of the RSSI
+//						(receiver noise), the unique ID of the MCU and the timers (crystal start-up
+//						and code timing jitter) are mixed into the state. The crystal has to run.
+// Return Value : None
+// Parameters	: None
+//------------------------------------------------------------------------------------------------
+void macRandomSeed (void)
+{
+	U8 i;
+	U32 seed;
+
+	seed = EZMacProRandomNumber ^ MCU_UNIQUE_ID(0);
+	RANDOM_NEXT(seed);
+	seed ^= MCU_UNIQUE_ID(1);
+	RANDOM_NEXT(seed);
+	seed ^= MCU_UNIQUE_ID(2);
+	RANDOM_NEXT(seed);
+
+	macSpiWriteReg(SI4432_OPERATING_AND_FUNCTION_CONTROL_1, SI4432_RXON | SI4432_XTON);
+	for (i = 0; i < RANDOM_SEED_SAMPLES; i++)
+	{
+		seed ^= macSpiReadReg(SI4432_RECEIVED_SIGNAL_STRENGTH_INDICATOR);
+		seed ^= (MAC_TIMER_NOW() ^ CYCLE_COUNTER()) << 8;
+		if (seed == 0)
+			seed = i + 1;
+		RANDOM_NEXT(seed);
+	}
+	macSpiWriteReg(SI4432_OPERATING_AND_FUNCTION_CONTROL_1, SI4432_XTON);
+
+	EZMacProRandomNumber = seed;
+}
+
 //------------------------------------------------------------------------------------------------
 // Function Name: macUpdateLBTI
 //						This function update the Listen Before Talk timeout.
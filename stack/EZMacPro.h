@@ -33,10 +33,43 @@
 #define LBT_FIXED_TIME_1000US	TIMEOUT_US(1000L)
 // PLL settling time 200us
 #define PLL_SETTLING_TIME		TIMEOUT_US(200L)
+#ifdef FAST_SCAN_ENABLED
+// RSSI screen of a channel: PLL settling and 4 bits of RSSI averaging
+#define FAST_SCAN_TIMEOUT(byteTime)	(PLL_SETTLING_TIME + (U32)(byteTime) / 2)
+// search timeout of a new channel
+#define SEARCH_TIMEOUT			((EZMacProReg.name.RCR & RCR_FAST_SCAN) ? TimeoutFastScan : TimeoutChannelSearch)
+#else
+#define SEARCH_TIMEOUT			TimeoutChannelSearch
+#endif
 //the SW make up the ACK packet(in 4 Mhz ~1.6ms)
 //the ACK packet timeout 5ms
 #define MAKE_UP_THE_ACK_PACKET	TIMEOUT_US(5000L)
 #define MAX_LBT_WAITING_TIME	TIMEOUT_US(12700L)
+// backoff slot of the retransmissions
+#define RETRY_BACKOFF_SLOT		TIMEOUT_US(RETRY_BACKOFF_SLOT_US)
+// lifetime of the duplicate cache entries
+#define DUPLICATE_CACHE_AGE		(TIMEOUT_US(1000L) * DUPLICATE_CACHE_AGE_MS)
+#define LINK_RATE_HOLD				(TIMEOUT_US(1000L) * LINK_RATE_HOLD_MS)
+// RSSI register value of an input power, the register reads about 2 * (dBm + 120)
+#define RSSI_DBM(dbm)				(2 * ((dbm) + 120))
+
+#ifdef CHANNEL_QUALITY_ENABLED
+	// one entry per frequency register (FRn)
+	#ifdef FOUR_CHANNEL_IS_USED
+	#define CHANNEL_QUALITY_SIZE		4
+	#endif
+	#ifdef MORE_CHANNEL_IS_USED
+	#define CHANNEL_QUALITY_SIZE		50
+	#endif
+#define CHANNEL_NOISE_LIMIT			RSSI_DBM(CHANNEL_NOISE_LIMIT_DBM)
+#endif
+#ifdef FAST_SCAN_ENABLED
+#define FAST_SCAN_RSSI_LIMIT		RSSI_DBM(FAST_SCAN_RSSI_DBM)
+#endif
+// gap between the frames of a bulk transfer
+#define BULK_FRAME_GAP			TIMEOUT_US(BULK_FRAME_GAP_US)
+// an incomplete bulk transfer message is dropped after this time without a fragment
+#define BULK_REASSEMBLY_TIMEOUT	(TIMEOUT_US(1000L) * BULK_REASSEMBLY_TIMEOUT_MS)
 //------------------------------------------------------------------------------------------------
 // EZMacProReg.name.MSR states
 //------------------------------------------------------------------------------------------------
@@ -65,6 +98,9 @@ enum
 #ifdef EXTENDED_PACKET_FORMAT
 #ifdef TRANSCEIVER_OPERATION
 	TX_STATE_WAIT_FOR_ACK,
+	TX_STATE_RETRY_BACKOFF,
+	TX_STATE_DEFERRED_BULK,
+	TX_STATE_BULK_GAP,
 //	TX_ERROR_NO_ACK,
 #endif
 #endif
@@ -91,9 +127,11 @@ enum
 	RX_STATE_WAIT_FOR_SYNC,
 	RX_STATE_WAIT_FOR_PACKET,
 #ifdef EXTENDED_PACKET_FORMAT
+	RX_STATE_DEFERRED_ACK,
 	RX_STATE_WAIT_FOR_SEND_ACK,
 #endif
 #ifdef PACKET_FORWARDING_SUPPORTED
+	RX_STATE_DEFERRED_FORWARDING,
 #ifdef TRANSCEIVER_OPERATION
 	RX_STATE_FORWARDING_LBT_START_LISTEN,
 	RX_STATE_FORWARDING_LBT_LISTEN,
@@ -116,6 +154,42 @@ enum
 #define EZMAC_PRO_ERROR_BAD_CID			0x04
 #define EZMAC_PRO_ERROR_CHANNEL_BUSY	0x08
 //------------------------------------------------------------------------------------------------
+// RTCR register bits, retransmission of the unacknowledged packets
+//------------------------------------------------------------------------------------------------
+#define RTCR_RETRIES				0x0F	// maximum number of retransmissions, 0: disabled
+#define RTCR_BACKOFF				0x30	// wait before the n-th retransmission:
+#define RTCR_BACKOFF_NONE			0x00	//	no wait
+#define RTCR_BACKOFF_FIXED			0x10	//	one slot
+#define RTCR_BACKOFF_LINEAR			0x20	//	n slots
+#define RTCR_BACKOFF_EXPONENTIAL	0x30	//	random 1..2^(n-1) slots, maximum 16 slots
+//------------------------------------------------------------------------------------------------
+// LACR register bits, link adaptation per peer (LinkTable)
+// With LACR_RATE the radius field of the control byte carries the data rate (MCR bits 6:5
+// format): the requested one in the packets with ACK request and the granted one in the ACK.
+// LACR_RATE needs a free-running MAC clock for LINK_RATE_HOLD, it is refused on the ports
+// without it (MAC_TIMER_NO_CLOCK).
+// With LACR_POWER the last byte of the ACK payload is the RSSI of the acknowledged packet, it
+// is one more byte in dynamic payload length mode and it replaces the last byte in static mode.
+//------------------------------------------------------------------------------------------------
+#define LACR_RATE					0x01	// the unicast packets use the data rate of the peer
+#define LACR_POWER					0x02	// the unicast packets use the TX power of the peer
+//------------------------------------------------------------------------------------------------
+// RCR register bits
+// With RCR_FAST_SCAN the MORE_CHANNEL search waits on a channel only for the RSSI screen
+// (FAST_SCAN_TIMEOUT), the full search timeout is used only if the RSSI reaches FAST_SCAN_RSSI_DBM.
+//------------------------------------------------------------------------------------------------
+#define RCR_FAST_SCAN				0x01	// RSSI screen of the channels (FAST_SCAN_ENABLED)
+//------------------------------------------------------------------------------------------------
+// control byte of the bulk transfer frames, see EZMacPRO_Bulk_Transmit()
+// The sequence number field (bits 7:4) is the index of the frame in the window.
+//------------------------------------------------------------------------------------------------
+#define BULK_CTRL_MARK				0x0C	// ACK and ACKREQ are both set
+#define BULK_CTRL_TOGGLE			0x02	// changes with every window (instead of the radius)
+#define BULK_CTRL_LAST				0x01	// last frame of the round, the block ACK is requested
+// the payload of the bulk transfer frames starts with the fragment header: the number of the
+// message, the offset of the fragment in the message and the length of the message (2-2 bytes, LSB first)
+#define BULK_FRAGMENT_HEADER_SIZE	5
+//------------------------------------------------------------------------------------------------
 // MAC register definition
 //------------------------------------------------------------------------------------------------
 #define EZ_LASTREG		ADCTSV
@@ -127,6 +201,10 @@ enum
 // LBT definitions
 #define LBT_FIXED_NUMBER			10
 #define LBT_FIXED_BUSY_NUMBER 		2
+// random number generator: xorshift32 (Marsaglia), the state must never be zero
+#define RANDOM_NEXT(x)				do { (x) ^= (x) << 13; (x) ^= (x) >> 17; (x) ^= (x) << 5; } while (0)
+// RSSI samples of the seed
+#define RANDOM_SEED_SAMPLES			32
 
 //------------------------------------------------------------------------------------------------
 // Debug Trap defined only for debug
@@ -241,6 +319,10 @@ typedef enum
 #ifdef TRANSCEIVER_OPERATION
  	LBTIR,						// Listen Before Talk	Interval Register
 	LBTLR,						// Listen Before Talk Limit Register
+#ifdef EXTENDED_PACKET_FORMAT
+	RTCR,						// Retransmission Control Register
+	LACR,						// Link Adaptation Control Register
+#endif
 #endif
 	LFTMR0,						// Low Frequency Timer Setting Register 0
 	LFTMR1,						// Low Frequency Timer Setting Register 1
@@ -343,6 +425,10 @@ typedef struct EZMacProRegStruct
 #ifdef TRANSCEIVER_OPERATION
 	volatile U8	LBTIR;						// Listen Before Talk	Interval Register
 	volatile U8	LBTLR;						// Listen Before Talk Limit Register
+#ifdef EXTENDED_PACKET_FORMAT
+	volatile U8	RTCR;						// Retransmission Control Register
+	volatile U8	LACR;						// Link Adaptation Control Register
+#endif
 #endif//TRANSCEIVER_OPERATION
 	volatile U8	LFTMR0;						// Low Frequency Timer Setting Register 0
 	volatile U8	LFTMR1;						// Low Frequency Timer Setting Register 1
@@ -370,24 +456,324 @@ typedef struct ForwardedPacketTableEntry
 	U8 seq;
 	U8 chan;
 } ForwardedPacketTableEntry;
+//------------------------------------------------------------------------------------------------
+// ACK round-trip time of a peer, from the end of the transmission to the received ACK
+//------------------------------------------------------------------------------------------------
+typedef struct AckRttTableEntry
+{
+	U8 did;
+	U32 srtt;								// smoothed round-trip time, 0: unused entry
+	U32 rttvar;								// mean deviation of the round-trip time
+} AckRttTableEntry;
+//------------------------------------------------------------------------------------------------
+// data rate and TX power of a peer, see LACR
+//------------------------------------------------------------------------------------------------
+typedef struct LinkTableEntry
+{
+	U8 did;
+	U8 rate;								// data rate (MCR bits 6:5 format), 0xFF: unused entry
+	U8 rssi;								// smoothed RSSI of the packets of the peer
+	U8 acks;								// acknowledged packets at this data rate
+	U8 fails;								// unacknowledged packets in a row
+	U8 power;								// TX power (TCR bits 6:4 format)
+	U32 stamp;								// MAC timer at the last exchange
+} LinkTableEntry;
+//------------------------------------------------------------------------------------------------
+// sequence number of the packets sent to a destination
+//------------------------------------------------------------------------------------------------
+typedef struct SequenceTableEntry
+{
+	U8 did;
+	U8 seq;									// last sequence number, 0xFF: unused entry
+} SequenceTableEntry;
+//------------------------------------------------------------------------------------------------
+// last packet of a sender to a destination, a packet with the same sequence number is a retransmission
+//------------------------------------------------------------------------------------------------
+typedef struct DuplicateCacheEntry
+{
+	U8 sid;
+	U8 did;
+	U8 seq;									// sequence number, 0xFF: unused entry
+	U32 stamp;								// MAC timer at the reception
+} DuplicateCacheEntry;
+//------------------------------------------------------------------------------------------------
+// quality of a frequency channel, see CHANNEL_QUALITY_ENABLED
+//------------------------------------------------------------------------------------------------
+typedef struct ChannelQualityEntry
+{
+	U8 noise;								// smoothed RSSI of the idle channel
+	U8 crc;									// received packets with CRC error
+	U8 ok;									// received valid packets
+	U8 score;								// the channel is skipped from CHANNEL_BLACKLIST
+} ChannelQualityEntry;
+//------------------------------------------------------------------------------------------------
+// receive metadata snapshot, see EZMacPRO_Rx_Snapshot()
+//------------------------------------------------------------------------------------------------
+typedef struct EZMacProRxMeta
+{
+	U8 msr;									// MAC status at the time of the snapshot
+	U8 rsr;									// the rest belongs to the last received packet
+	U8 rfsr;
+	U8 rssi;
+	U8 rctrl;
+	U8 rcid;
+	U8 rsid;
+	U8 did;
+	U8 plen;
+	U8 count;								// number of received packets, wraps around
+} EZMacProRxMeta;
+
+//------------------------------------------------------------------------------------------------
+// boot phases, see EZMacPRO_Boot_Mark()
+//------------------------------------------------------------------------------------------------
+typedef enum
+{
+	EZMAC_BOOT_RADIO_ON = 0,				// the radio is released from shutdown
+	EZMAC_BOOT_BOARD_READY,					// BoardInit() is finished
+	EZMAC_BOOT_CHIP_READY,					// the radio crystal runs (EZMacPRO_Init())
+	EZMAC_BOOT_INIT_DONE,					// EZMacPRO_Init() is finished
+	EZMAC_BOOT_FIRST_TX,					// the first packet is sent
+	EZMAC_BOOT_PHASES
+} EZMacProBootPhase;
 
 #ifdef __CC_ARM
 #pragma pack(8)
 #endif
 
+#ifdef EZMACPRO_CONTEXT
+//------------------------------------------------------------------------------------------------
+// stack context: the state of one radio (the MAC registers, the timeouts, the frames in use)
+// The frame pool, the event queue, the tasks and the software timers are shared.
+//------------------------------------------------------------------------------------------------
+typedef struct EZMacProContext
+{
+	EZMacProUnion EZMacProReg;
+	U8 EZMacProCurrentChannel;
+	U32 XtalStartTime;
+	U32 XtalStartMax;
+	U32 XtalStartStamp;
+	U8 XtalStartPending;
+#ifdef EXTENDED_PACKET_FORMAT
+	U32 TimeoutACK;
+	U32 TimeoutACKMin;
+	AckRttTableEntry AckRttTable[ACK_RTT_TABLE_SIZE];
+	U8 AckRttNext;
+	U8 AckRttEntry;
+	U8 AckRttDid;
+	U32 AckRttStamp;
+	U8 EZMacProSequenceNumber;
+	SequenceTableEntry SequenceTable[SEQUENCE_TABLE_SIZE];
+	U8 SequenceNext;
+	U8 EZMacProTxAttempts;
+	U8 PreamRegValue;
+	U8 * BulkTxBuf;
+	U16 BulkTxLength;
+	U16 BulkTxBase;
+	U8 BulkTxCount;
+	U8 BulkTxNext;
+	U16 BulkTxPending;
+	U8 BulkTxToggle;
+	U8 BulkTxMessage;
+	U32 BulkTxFrames;
+#endif
+#ifndef TRANSMITTER_ONLY_OPERATION
+	U8 fHeaderErrorOccurred;
+	U8 RxFrame;
+	U8 RxMetaSeq;
+	EZMacProRxMeta RxMeta[2];
+	#ifdef EXTENDED_PACKET_FORMAT
+	U8 AckBufSize;
+	U8 AckFrame;
+	DuplicateCacheEntry DuplicateCache[DUPLICATE_CACHE_SIZE];
+	U8 DuplicateCacheNext;
+	U8 RxDuplicate;
+	U32 RxDuplicateCount;
+	U8 BulkRxSid;
+	U8 BulkRxToggle;
+	U16 BulkRxMap;
+	U32 BulkRxStamp;
+	U8 BulkRxMessage;
+	U16 BulkRxLength;
+	U16 BulkRxReceived;
+	U8 BulkRxBuf[BULK_MESSAGE_SIZE];
+	#endif
+	U8 EZMacProReceiveStatus;
+	U8 EZMacProRSSIvalue;
+	U32 TimeoutSyncWord;
+	U32 TimeoutRX_Packet;
+	#ifndef B1_ONLY
+	U8 RX_Freq_dev;
+	#endif
+	U32 TimeoutChannelSearch;
+#endif
+#ifndef RECEIVER_ONLY_OPERATION
+	U32 TimeoutTX_Packet;
+	#ifndef B1_ONLY
+	U8 TX_Freq_dev;
+	#endif
+#endif
+#ifdef TRANSCEIVER_OPERATION
+	U32 TimeoutLBTI;
+	U8 BusyLBT;
+	U8 EZMacProLBT_Retrys;
+	U8 CsmaBE;
+	#ifdef EXTENDED_PACKET_FORMAT
+	LinkTableEntry LinkTable[LINK_TABLE_SIZE];
+	U8 LinkNext;
+	U8 LinkEntry;
+	U8 LinkRate;
+	U8 LinkPower;
+	#endif
+#endif
+	U32 EZMacProRandomNumber;
+	U8 ChannelOccupiedInStartPeriod;
+	U8 ChannelOccupiedCounter;
+#ifdef PACKET_FORWARDING_SUPPORTED
+	ForwardedPacketTableEntry ForwardedPacketTable[FORWARDED_PACKET_TABLE_SIZE];
+	U8 ForwardedPacketNext;
+#endif
+#ifdef ANTENNA_DIVERSITY_ENABLED
+	U8 Selected_Antenna;
+#endif
+#ifdef MORE_CHANNEL_IS_USED
+	U8 SelectedChannel;
+	U8 maxChannelNumber;
+#endif
+#ifdef FAST_SCAN_ENABLED
+	U32 TimeoutFastScan;
+	U8 FastScanDwell;
+#endif
+#ifdef CHANNEL_QUALITY_ENABLED
+	ChannelQualityEntry ChannelQuality[CHANNEL_QUALITY_SIZE];
+#endif
+} EZMacProContext;
+#endif //EZMACPRO_CONTEXT
+
 /* ==================================== *
  *	 G L O B A L	V A R I A B L E S	*
  * ==================================== */
 
+#ifdef EZMACPRO_CONTEXT
+// the default context is used until EZMacPRO_Context_Select() selects another one
+extern volatile EZMacProContext EZMacProDefaultContext;
+extern volatile EZMacProContext * volatile EZMacProCtx;
+
+// the global names of the state address the selected context
+#define EZMacProReg					(EZMacProCtx->EZMacProReg)
+#define EZMacProCurrentChannel		(EZMacProCtx->EZMacProCurrentChannel)
+#define XtalStartTime				(EZMacProCtx->XtalStartTime)
+#define XtalStartMax				(EZMacProCtx->XtalStartMax)
+#define XtalStartStamp				(EZMacProCtx->XtalStartStamp)
+#define XtalStartPending			(EZMacProCtx->XtalStartPending)
+#define TimeoutACK					(EZMacProCtx->TimeoutACK)
+#define TimeoutACKMin				(EZMacProCtx->TimeoutACKMin)
+#define AckRttTable					(EZMacProCtx->AckRttTable)
+#define AckRttNext					(EZMacProCtx->AckRttNext)
+#define AckRttEntry					(EZMacProCtx->AckRttEntry)
+#define AckRttDid					(EZMacProCtx->AckRttDid)
+#define AckRttStamp					(EZMacProCtx->AckRttStamp)
+#define EZMacProSequenceNumber		(EZMacProCtx->EZMacProSequenceNumber)
+#define SequenceTable				(EZMacProCtx->SequenceTable)
+#define SequenceNext				(EZMacProCtx->SequenceNext)
+#define EZMacProTxAttempts			(EZMacProCtx->EZMacProTxAttempts)
+#define PreamRegValue				(EZMacProCtx->PreamRegValue)
+#define BulkTxBuf					(EZMacProCtx->BulkTxBuf)
+#define BulkTxLength				(EZMacProCtx->BulkTxLength)
+#define BulkTxBase					(EZMacProCtx->BulkTxBase)
+#define BulkTxCount					(EZMacProCtx->BulkTxCount)
+#define BulkTxNext					(EZMacProCtx->BulkTxNext)
+#define BulkTxPending				(EZMacProCtx->BulkTxPending)
+#define BulkTxToggle				(EZMacProCtx->BulkTxToggle)
+#define BulkTxMessage				(EZMacProCtx->BulkTxMessage)
+#define BulkTxFrames				(EZMacProCtx->BulkTxFrames)
+#define fHeaderErrorOccurred		(EZMacProCtx->fHeaderErrorOccurred)
+#define RxFrame						(EZMacProCtx->RxFrame)
+#define RxMetaSeq					(EZMacProCtx->RxMetaSeq)
+#define RxMeta						(EZMacProCtx->RxMeta)
+#define AckBufSize					(EZMacProCtx->AckBufSize)
+#define AckFrame					(EZMacProCtx->AckFrame)
+#define DuplicateCache				(EZMacProCtx->DuplicateCache)
+#define DuplicateCacheNext			(EZMacProCtx->DuplicateCacheNext)
+#define RxDuplicate					(EZMacProCtx->RxDuplicate)
+#define RxDuplicateCount			(EZMacProCtx->RxDuplicateCount)
+#define BulkRxSid					(EZMacProCtx->BulkRxSid)
+#define BulkRxToggle				(EZMacProCtx->BulkRxToggle)
+#define BulkRxMap					(EZMacProCtx->BulkRxMap)
+#define BulkRxStamp					(EZMacProCtx->BulkRxStamp)
+#define BulkRxMessage				(EZMacProCtx->BulkRxMessage)
+#define BulkRxLength				(EZMacProCtx->BulkRxLength)
+#define BulkRxReceived				(EZMacProCtx->BulkRxReceived)
+#define BulkRxBuf					(EZMacProCtx->BulkRxBuf)
+#define EZMacProReceiveStatus		(EZMacProCtx->EZMacProReceiveStatus)
+#define EZMacProRSSIvalue			(EZMacProCtx->EZMacProRSSIvalue)
+#define TimeoutSyncWord				(EZMacProCtx->TimeoutSyncWord)
+#define TimeoutRX_Packet			(EZMacProCtx->TimeoutRX_Packet)
+#define RX_Freq_dev					(EZMacProCtx->RX_Freq_dev)
+#define TimeoutChannelSearch		(EZMacProCtx->TimeoutChannelSearch)
+#define TimeoutTX_Packet			(EZMacProCtx->TimeoutTX_Packet)
+#define TX_Freq_dev					(EZMacProCtx->TX_Freq_dev)
+#define TimeoutLBTI					(EZMacProCtx->TimeoutLBTI)
+#define BusyLBT						(EZMacProCtx->BusyLBT)
+#define EZMacProRandomNumber		(EZMacProCtx->EZMacProRandomNumber)
+#define EZMacProLBT_Retrys			(EZMacProCtx->EZMacProLBT_Retrys)
+#define CsmaBE						(EZMacProCtx->CsmaBE)
+#define LinkTable					(EZMacProCtx->LinkTable)
+#define LinkNext					(EZMacProCtx->LinkNext)
+#define LinkEntry					(EZMacProCtx->LinkEntry)
+#define LinkRate					(EZMacProCtx->LinkRate)
+#define LinkPower					(EZMacProCtx->LinkPower)
+#define ChannelOccupiedInStartPeriod	(EZMacProCtx->ChannelOccupiedInStartPeriod)
+#define ChannelOccupiedCounter		(EZMacProCtx->ChannelOccupiedCounter)
+#define ForwardedPacketTable		(EZMacProCtx->ForwardedPacketTable)
+#define ForwardedPacketNext			(EZMacProCtx->ForwardedPacketNext)
+#define Selected_Antenna			(EZMacProCtx->Selected_Antenna)
+#define SelectedChannel				(EZMacProCtx->SelectedChannel)
+#define maxChannelNumber			(EZMacProCtx->maxChannelNumber)
+#define ChannelQuality				(EZMacProCtx->ChannelQuality)
+#define TimeoutFastScan				(EZMacProCtx->TimeoutFastScan)
+#define FastScanDwell				(EZMacProCtx->FastScanDwell)
+#else
 extern volatile SEGMENT_VARIABLE(EZMacProReg, EZMacProUnion, REGISTER_MSPACE);
 extern volatile BIT fHeaderErrorOccurred;
-extern SEGMENT_VARIABLE(RxBuffer[RECEIVED_BUFFER_SIZE], U8 , BUFFER_MSPACE);
+extern volatile SEGMENT_VARIABLE(RxFrame, U8 , EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(RxMetaSeq, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(RxMeta[2], EZMacProRxMeta, BUFFER_MSPACE);
 extern volatile SEGMENT_VARIABLE(ForwardedPacketTable[FORWARDED_PACKET_TABLE_SIZE], ForwardedPacketTableEntry, FORWARDED_PACKET_TABLE_MSPACE);
 extern volatile SEGMENT_VARIABLE(AckBufSize, U8 , EZMAC_PRO_GLOBAL_MSPACE);
-extern volatile SEGMENT_VARIABLE(AckBuffer[ACK_BUFFER_SIZE], U8 , BUFFER_MSPACE);
+extern volatile SEGMENT_VARIABLE(AckFrame, U8 , EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(DuplicateCache[DUPLICATE_CACHE_SIZE], DuplicateCacheEntry, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(DuplicateCacheNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(RxDuplicate, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(RxDuplicateCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkRxSid, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkRxToggle, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkRxMap, U16, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkRxStamp, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkRxMessage, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkRxLength, U16, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkRxReceived, U16, EZMAC_PRO_GLOBAL_MSPACE);
+extern SEGMENT_VARIABLE(BulkRxBuf[BULK_MESSAGE_SIZE], U8, BUFFER_MSPACE);
 extern volatile SEGMENT_VARIABLE(EZMacProLBT_Retrys, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(CsmaBE, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(LinkTable[LINK_TABLE_SIZE], LinkTableEntry, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(LinkNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(LinkEntry, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(LinkRate, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(LinkPower, U8, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(BusyLBT, U8, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(EZMacProSequenceNumber, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(SequenceTable[SEQUENCE_TABLE_SIZE], SequenceTableEntry, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(SequenceNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(EZMacProTxAttempts, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern SEGMENT_VARIABLE_SEGMENT_POINTER(BulkTxBuf, U8, BUFFER_MSPACE, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxLength, U16, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxBase, U16, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxCount, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxPending, U16, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxToggle, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxMessage, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(BulkTxFrames, U32, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(EZMacProCurrentChannel, U8, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(EZMacProRSSIvalue, U8, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(EZMacProReceiveStatus, U8, EZMAC_PRO_GLOBAL_MSPACE);
@@ -398,13 +784,42 @@ extern volatile SEGMENT_VARIABLE(TimeoutSyncWord, U32, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(TimeoutRX_Packet, U32, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(TimeoutTX_Packet, U32, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(TimeoutACK, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(TimeoutACKMin, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(AckRttTable[ACK_RTT_TABLE_SIZE], AckRttTableEntry, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(AckRttNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(AckRttEntry, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(AckRttDid, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(AckRttStamp, U32, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(TimeoutChannelSearch, U32, EZMAC_PRO_GLOBAL_MSPACE);
-extern volatile SEGMENT_VARIABLE(EZMacProRandomNumber, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(EZMacProRandomNumber, U32, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(TimeoutLBTI, U32, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(Selected_Antenna, U8, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(SelectedChannel, U8, EZMAC_PRO_GLOBAL_MSPACE);
 extern volatile SEGMENT_VARIABLE(maxChannelNumber, U8, EZMAC_PRO_GLOBAL_MSPACE);
+#ifdef CHANNEL_QUALITY_ENABLED
+extern volatile SEGMENT_VARIABLE(ChannelQuality[CHANNEL_QUALITY_SIZE], ChannelQualityEntry, EZMAC_PRO_GLOBAL_MSPACE);
+#endif
+#ifdef FAST_SCAN_ENABLED
+extern volatile SEGMENT_VARIABLE(TimeoutFastScan, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(FastScanDwell, U8, EZMAC_PRO_GLOBAL_MSPACE);
+#endif
 extern volatile SEGMENT_VARIABLE(PreamRegValue, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(XtalStartTime, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(XtalStartMax, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(XtalStartStamp, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(XtalStartPending, U8, EZMAC_PRO_GLOBAL_MSPACE);
+#ifdef PACKET_FORWARDING_SUPPORTED
+extern volatile SEGMENT_VARIABLE(ForwardedPacketNext, U8, EZMAC_PRO_GLOBAL_MSPACE);
+#endif
+#endif //EZMACPRO_CONTEXT
+// MAC timer at the boot phases, shared by the contexts
+extern volatile SEGMENT_VARIABLE(BootTime[EZMAC_BOOT_PHASES], U32, EZMAC_PRO_GLOBAL_MSPACE);
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+// the modem registers that differ between two data rates, shared by the contexts
+extern volatile SEGMENT_VARIABLE(LinkRateDelta[4][4], U16, EZMAC_PRO_GLOBAL_MSPACE);
+	#endif
+#endif
 
 /* ==================================== *
  *	F U N C T I O N	P R O T O T Y P E S	*
@@ -412,6 +827,16 @@ extern volatile SEGMENT_VARIABLE(PreamRegValue, U8, EZMAC_PRO_GLOBAL_MSPACE);
 
 MacParams EZMacPRO_Init(void);
 MacParams EZMacPRO_Wake_Up(void);
+MacParams EZMacPRO_Wake_Up_Start(void);
+U32 EZMacPRO_Wake_Up_Time(void);
+U32 EZMacPRO_Random(void);
+#ifdef EXTENDED_PACKET_FORMAT
+U32 EZMacPRO_Ack_Wait_Time(U8 did);
+MacParams EZMacPRO_Bulk_Transmit(U16 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE));
+	#ifndef TRANSMITTER_ONLY_OPERATION
+MacParams EZMacPRO_Bulk_Read(VARIABLE_SEGMENT_POINTER(length, U16, BUFFER_MSPACE), VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE));
+	#endif
+#endif
 MacParams EZMacPRO_Sleep(void);
 MacParams EZMacPRO_Idle(void);
 MacParams EZMacPRO_Transmit(void);
@@ -422,6 +847,14 @@ MacParams EZMacPRO_Reg_Read (MacRegs name, U8 *value);
 MacParams EZMacPRO_TxBuf_Write(U8, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE));
 MacParams EZMacPRO_RxBuf_Read(VARIABLE_SEGMENT_POINTER(length, U8, BUFFER_MSPACE), VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE));
 MacParams EZMacPRO_Ack_Write(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE));
+#ifndef TRANSMITTER_ONLY_OPERATION
+void EZMacPRO_Rx_Snapshot(VARIABLE_SEGMENT_POINTER(meta, EZMacProRxMeta, APPLICATION_MSPACE));
+#endif
+void EZMacPRO_Boot_Mark(U8 phase);
+#ifdef EZMACPRO_CONTEXT
+void EZMacPRO_Context_Init(volatile EZMacProContext *ctx);
+volatile EZMacProContext *EZMacPRO_Context_Select(volatile EZMacProContext *ctx);
+#endif
 
 void SetRfParameters(U8);
 void macSpecialRegisterSettings(U8);
@@ -429,10 +862,34 @@ void macUpdateDynamicTimeouts (U8, U8);
 #ifdef PACKET_FORWARDING_SUPPORTED
 	void initForwardedPacketTable (void);
 #endif
+#ifdef EXTENDED_PACKET_FORMAT
+	void initAckRttTable (void);
+	void initSequenceTable (void);
+	U8 macSequenceNext (U8);
+	void initBulkTransfer (void);
+	void macBulkLoad (void);
+	#ifndef TRANSMITTER_ONLY_OPERATION
+	void initDuplicateCache (void);
+	#endif
+#endif
+#ifdef CHANNEL_QUALITY_ENABLED
+	void initChannelQuality (void);
+	U8 macChannelSelect (U8);
+#endif
 void macSetEnable2(U8);
 void macSetFunction1(U8);
+void macRandomSeed (void);
 #ifdef TRANSCEIVER_OPERATION
 	void macUpdateLBTI (U8);
+	#ifdef EXTENDED_PACKET_FORMAT
+	void initLinkTable (void);
+	void macLinkRateDelta (void);
+	void macSetLinkRate (U8);
+	void macSetLinkPower (U8);
+	U8 macLinkEntry (U8);
+	U8 macLinkTransmit (void);
+	void macLinkReceive (void);
+	#endif
 #endif
 
 #endif //_EZMACPRO_H_
@@ -0,0 +1,252 @@
+/*!\file EZMacPro_Aggregate.c
+ * \brief Aggregation of short messages to the same destination into one frame.
+ *
+ * \n The messages given to EZMacPRO_Aggregate_Put() are collected in a frame
+ * \n buffer. The frame is sent when the next message does not fit or goes to
+ * \n another DID, or when the latency budget (AGGREGATE_LATENCY_MS from the
+ * \n first message of the frame) expires. Every message is stored as a length
+ * \n byte and the message bytes, a zero length or the end of the payload ends
+ * \n the frame, so the zero padding of the static payload length mode is not
+ * \n delivered.
+ *
+ * \n The frame is an ordinary packet for the MAC, it is acknowledged and
+ * \n retransmitted as a whole. The receiver splits it by EZMacPRO_Aggregate_Split(),
+ * \n both sides have to know that the frames of the peer are aggregated.
+ *
+ * \n The latency budget runs on the software timer wheel, without a tick
+ * \n source the frame is sent only when it is full or flushed.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+/* ======================================= *
+ *				I N C L U D E				*
+ * ======================================= */
+
+#include "stack.h"
+
+/* ======================================= *
+ *	 G L O B A L	V A R I A B L E S	 *
+ * ======================================= */
+
+#ifndef RECEIVER_ONLY_OPERATION
+// the frame being collected
+SEGMENT_VARIABLE(AggregateBuf[RECEIVED_BUFFER_SIZE], U8, BUFFER_MSPACE);
+SEGMENT_VARIABLE(AggregateLength, U8, APPLICATION_MSPACE);
+SEGMENT_VARIABLE(AggregateDid, U8, APPLICATION_MSPACE);
+SEGMENT_VARIABLE(AggregateTimer, EZMacProTimer, APPLICATION_MSPACE);
+// ticks until the next try while the MAC is busy
+SEGMENT_VARIABLE(AggregateRetry, U32, APPLICATION_MSPACE);
+#endif
+
+// statistics: messages put or split, and the aggregate frames sent or received
+SEGMENT_VARIABLE(AggregateMessages, U32, APPLICATION_MSPACE);
+SEGMENT_VARIABLE(AggregateFrames, U32, APPLICATION_MSPACE);
+
+/* ======================================= *
+ *		L O C A L	F U N C T I O N S		*
+ * ======================================= */
+
+#ifndef RECEIVER_ONLY_OPERATION
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	aggregateFrameSize()
+//
+// Return Value : U8 - payload size of a frame, MPL (PLEN in static payload length mode)
+// Parameters	: None
+//
+//------------------------------------------------------------------------------------------------
+static U8 aggregateFrameSize(void)
+{
+	U8 mcr;
+	U8 size;
+
+	EZMacPRO_Reg_Read(MCR, &mcr);
+	if (mcr & 0x04)
+		EZMacPRO_Reg_Read(MPL, &size);
+	else
+		EZMacPRO_Reg_Read(PLEN, &size);
+	return size;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	aggregateExpired()
+//
+// Return Value : None
+// Parameters	: timer - AggregateTimer
+//
+// Notes:
+//
+// The latency budget of the frame is used up. If the MAC is busy the frame is tried again, the
+// interval is doubled after every try up to AGGREGATE_LATENCY, so a long reception or a bulk
+// transfer is not polled at every tick.
+//
+//------------------------------------------------------------------------------------------------
+static void aggregateExpired(EZMacProTimer *timer)
+{
+	if (EZMacPRO_Aggregate_Flush() != STATE_ERROR)
+		return;
+
+	EZMacPRO_Timer_Start(timer, AggregateRetry, 0, aggregateExpired);
+	AggregateRetry *= 2;
+	if (AggregateRetry > AGGREGATE_LATENCY)
+		AggregateRetry = AGGREGATE_LATENCY;
+}
+#endif //RECEIVER_ONLY_OPERATION not defined
+
+/* ======================================= *
+ *	 P U B L I C	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Aggregate_Init()
+//					Drops the frame being collected and clears the statistics. It is called by
+//					EZMacPRO_Init() after the software timers are stopped.
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Aggregate_Init(void)
+{
+#ifndef RECEIVER_ONLY_OPERATION
+	EZMacPRO_Timer_Stop(&AggregateTimer);
+	AggregateLength = 0;
+#endif
+	AggregateMessages = 0;
+	AggregateFrames = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Aggregate_Put()
+//					Queues a short message to did. The frame collected so far is sent first if the
+//					message goes to another DID or does not fit, and a full frame is sent at once.
+//					The first message of a frame starts the latency budget. The PacketSent,
+//					AckTimeout and LBTTimeout callbacks are called once per frame. It is called
+//					from the main loop, the MAC has to be in IDLE mode when a frame is sent.
+//
+// Return Value :	MAC_OK: the message is queued.
+//					VALUE_ERROR: the message is empty or does not fit into a frame with its length byte.
+//					STATE_ERROR: the previous frame could not be sent, the MAC is not in IDLE mode.
+//					Other values: EZMacPRO_Transmit() failed, the previous frame is dropped.
+//
+// Parameters	:	did - destination ID
+//					length - message length
+//					payload - message content
+//------------------------------------------------------------------------------------------------
+#ifndef RECEIVER_ONLY_OPERATION
+MacParams EZMacPRO_Aggregate_Put(U8 did, U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE))
+{
+	MacParams status;
+	U8 size;
+
+	size = aggregateFrameSize();
+	if (size > RECEIVED_BUFFER_SIZE)
+		size = RECEIVED_BUFFER_SIZE;
+	if ((length == 0) || ((U16)length + 1 > size))
+		return VALUE_ERROR;
+
+	if ((AggregateLength != 0) && ((did != AggregateDid) || (AggregateLength + 1 + length > size)))
+	{	// the frame is closed by this message
+		status = EZMacPRO_Aggregate_Flush();
+		if (status != MAC_OK)
+			return status;
+	}
+
+	if (AggregateLength == 0)
+	{	// the first message of the frame
+		AggregateDid = did;
+		AggregateRetry = 1;
+		EZMacPRO_Timer_Start(&AggregateTimer, AGGREGATE_LATENCY, 0, aggregateExpired);
+	}
+	AggregateBuf[AggregateLength++] = length;
+	while (length--)
+		AggregateBuf[AggregateLength++] = *payload++;
+	AggregateMessages++;
+
+	// no room for another message
+	if (AggregateLength + 2 > size)
+	{
+		status = EZMacPRO_Aggregate_Flush();
+		// if the MAC is busy the timer sends the frame later
+		if (status != STATE_ERROR)
+			return status;
+	}
+	return MAC_OK;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Aggregate_Flush()
+//					Sends the frame collected so far to its DID without waiting for the latency
+//					budget. The frame is copied to the TX FIFO, the next messages can be queued
+//					while it is sent. DID is restored after the frame is started.
+//
+// Return Value :	MAC_OK: the frame is being sent or there is nothing to send.
+//					STATE_ERROR: the MAC is not in IDLE mode, the frame is kept.
+//					Other values: EZMacPRO_Transmit() failed, the frame is dropped.
+//
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+MacParams EZMacPRO_Aggregate_Flush(void)
+{
+	MacParams status;
+	U8 msr;
+	U8 did;
+
+	if (AggregateLength == 0)
+		return MAC_OK;
+
+	EZMacPRO_Reg_Read(MSR, &msr);
+	if (msr != EZMAC_PRO_IDLE)
+		return STATE_ERROR;
+
+	EZMacPRO_Timer_Stop(&AggregateTimer);
+	EZMacPRO_Reg_Read(DID, &did);
+	EZMacPRO_Reg_Write(DID, AggregateDid);
+	status = EZMacPRO_TxBuf_Write(AggregateLength, AggregateBuf);
+	if (status == MAC_OK)
+		status = EZMacPRO_Transmit();
+	EZMacPRO_Reg_Write(DID, did);
+	AggregateLength = 0;
+	if (status == MAC_OK)
+		AggregateFrames++;
+	return status;
+}
+#endif //RECEIVER_ONLY_OPERATION not defined
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Aggregate_Split()
+//					Calls the handler for every message of a received aggregate frame, in the order
+//					they were queued. A message running over the end of the frame is dropped.
+//
+// Return Value :	U8 - the number of the messages
+// Parameters	:	length - frame length (from EZMacPRO_RxBuf_Read())
+//					payload - frame content
+//					handler - called for every message
+//------------------------------------------------------------------------------------------------
+#ifndef TRANSMITTER_ONLY_OPERATION
+U8 EZMacPRO_Aggregate_Split(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE), EZMacProAggregateHandler handler)
+{
+	U8 offset = 0;
+	U8 count = 0;
+
+	while ((offset < length) && (payload[offset] != 0))
+	{
+		if (payload[offset] >= length - offset)
+			break;
+		handler(payload[offset], payload + offset + 1);
+		offset += payload[offset] + 1;
+		count++;
+	}
+	AggregateMessages += count;
+	AggregateFrames++;
+	return count;
+}
+#endif //TRANSMITTER_ONLY_OPERATION not defined
@@ -0,0 +1,54 @@
+/*!\file EZMacPro_Aggregate.h
+ * \brief Header of EZMacPro_Aggregate.c.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+#ifndef _EZMACPRO_AGGREGATE_H_
+#define _EZMACPRO_AGGREGATE_H_
+
+
+                /* ======================================= *
+                 *          D E F I N I T I O N S          *
+                 * ======================================= */
+
+// timer ticks of the latency budget of the first queued message
+#define AGGREGATE_LATENCY               TIMER_MS(AGGREGATE_LATENCY_MS)
+
+//------------------------------------------------------------------------------------------------
+// handler of the messages split from a received aggregate frame
+// length: message length, payload: message content (points into the frame)
+//------------------------------------------------------------------------------------------------
+typedef void (*EZMacProAggregateHandler)(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE));
+
+
+                /* ======================================= *
+                 *     G L O B A L   V A R I A B L E S     *
+                 * ======================================= */
+
+extern SEGMENT_VARIABLE(AggregateMessages, U32, APPLICATION_MSPACE);
+extern SEGMENT_VARIABLE(AggregateFrames, U32, APPLICATION_MSPACE);
+
+
+                /* ======================================= *
+                 *  F U N C T I O N   P R O T O T Y P E S  *
+                 * ======================================= */
+
+void EZMacPRO_Aggregate_Init(void);
+#ifndef RECEIVER_ONLY_OPERATION
+MacParams EZMacPRO_Aggregate_Put(U8 did, U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE));
+MacParams EZMacPRO_Aggregate_Flush(void);
+#endif
+#ifndef TRANSMITTER_ONLY_OPERATION
+U8 EZMacPRO_Aggregate_Split(U8 length, VARIABLE_SEGMENT_POINTER(payload, U8, BUFFER_MSPACE), EZMacProAggregateHandler handler);
+#endif
+
+
+#endif //_EZMACPRO_AGGREGATE_H_
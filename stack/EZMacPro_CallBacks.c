@@ -41,6 +41,7 @@ BIT fEZMacPRO_PacketSent = 0;
 BIT fEZMacPRO_LBTTimeout = 0;
 BIT fEZMacPRO_AckTimeout = 0;
 BIT fEZMacPRO_AckSending = 0;
+BIT fEZMacPRO_BulkReceived = 0;
 
 
                 /* ======================================= *
@@ -53,6 +54,7 @@ BIT fEZMacPRO_AckSending = 0;
 void EZMacPRO_StateWakeUpEntered(void)
 {
     fEZMacPRO_StateWakeUpEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_WAKE_UP, 0);
 }
 
 /*!
@@ -61,6 +63,7 @@ void EZMacPRO_StateWakeUpEntered(void)
 void EZMacPRO_StateSleepEntered(void)
 {
     fEZMacPRO_StateSleepEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_SLEEP, 0);
 }
 
 /*!
@@ -69,6 +72,7 @@ void EZMacPRO_StateSleepEntered(void)
 void EZMacPRO_StateIdleEntered(void)
 {
     fEZMacPRO_StateIdleEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_IDLE, 0);
 }
 
 /*!
@@ -77,6 +81,7 @@ void EZMacPRO_StateIdleEntered(void)
 void EZMacPRO_StateRxEntered(void)
 {
     fEZMacPRO_StateRxEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_RX, 0);
 }
 
 /*!
@@ -85,6 +90,7 @@ void EZMacPRO_StateRxEntered(void)
 void EZMacPRO_StateTxEntered(void)
 {
     fEZMacPRO_StateTxEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_TX, 0);
 }
 
 /*!
@@ -93,18 +99,21 @@ void EZMacPRO_StateTxEntered(void)
 void EZMacPRO_StateErrorEntered(void)
 {
     fEZMacPRO_StateErrorEntered = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_STATE_ERROR, 0);
 }
 
 
 void EZMacPRO_LFTimerExpired(void)
 {
     fEZMacPRO_LFTimerExpired = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_LF_TIMER_EXPIRED, 0);
 }
 
 
 void EZMacPRO_LowBattery(void)
 {
     fEZMacPRO_LowBattery = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_LOW_BATTERY, 0);
 }
 
 
@@ -112,6 +121,7 @@ void EZMacPRO_LowBattery(void)
 void EZMacPRO_SyncWordReceived(void)
 {
     fEZMacPRO_SyncWordReceived = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_SYNC_WORD_RECEIVED, 0);
 }
 #endif //TRANSMITTER_ONLY_OPERATION not defined
 
@@ -120,6 +130,7 @@ void EZMacPRO_SyncWordReceived(void)
 void EZMacPRO_PacketDiscarded(void)
 {
     fEZMacPRO_PacketDiscarded = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_DISCARDED, 0);
 }
 #endif //TRANSMITTER_ONLY_OPERATION not defined
 
@@ -127,10 +138,8 @@ void EZMacPRO_PacketDiscarded(void)
 #ifndef TRANSMITTER_ONLY_OPERATION
 void EZMacPRO_PacketReceived(U8 rssi)
 {
-    U8 rssiVal;
-
-    rssiVal = rssi; // touch rssi to eliminate warning
     fEZMacPRO_PacketReceived = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_RECEIVED, rssi);
 }
 #endif //TRANSMITTER_ONLY_OPERATION not defined
 
@@ -139,14 +148,16 @@ void EZMacPRO_PacketReceived(U8 rssi)
 void EZMacPRO_PacketForwarding(void)
 {
     fEZMacPRO_PacketForwarding = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_FORWARDING, 0);
 }
 #endif //PACKET_FORWARDING_SUPPORTED
 
 
 #ifndef RECEIVER_ONLY_OPERATION
-void EZMacPRO_PacketSent(void)
+void EZMacPRO_PacketSent(U8 attempts)
 {
     fEZMacPRO_PacketSent = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_PACKET_SENT, attempts);
 }
 #endif //RECEIVER_ONLY_OPERATION not defined
 
@@ -155,15 +166,28 @@ void EZMacPRO_PacketSent(void)
 void EZMacPRO_LBTTimeout (void)
 {
     fEZMacPRO_LBTTimeout = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_LBT_TIMEOUT, 0);
 }
 #endif //TRANSCEIVER_OPERATION
 
 
 #ifdef EXTENDED_PACKET_FORMAT
 #ifdef TRANSCEIVER_OPERATION
-void EZMacPRO_AckTimeout (void)
+void EZMacPRO_AckTimeout (U8 attempts)
 {
     fEZMacPRO_AckTimeout = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_ACK_TIMEOUT, attempts);
+}
+#endif //TRANSCEIVER_OPERATION
+#endif //EXTENDED_PACKET_FORMAT
+
+
+#ifdef EXTENDED_PACKET_FORMAT
+#ifdef TRANSCEIVER_OPERATION
+void EZMacPRO_BulkReceived (void)
+{
+    fEZMacPRO_BulkReceived = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_BULK_RECEIVED, 0);
 }
 #endif //TRANSCEIVER_OPERATION
 #endif //EXTENDED_PACKET_FORMAT
@@ -172,6 +196,7 @@ void EZMacPRO_AckTimeout (void)
 void EZMacPRO_CRCError(void)
 {
     fEZMacPRO_CRCError = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_CRC_ERROR, 0);
 }
 
 
@@ -182,6 +207,7 @@ void EZMacPRO_AckSending(void)
     U8 BUFFER_MSPACE i;
 
     fEZMacPRO_AckSending = 1;
+    EZMacPRO_Event_Put(EZMAC_EVENT_ACK_SENDING, 0);
     //example: RSSI is sent back in Ack payload
     i = EZMacProRSSIvalue;
     EZMacPRO_Ack_Write(1,&i);
@@ -35,6 +35,7 @@ extern volatile BIT fEZMacPRO_PacketSent;
 extern volatile BIT fEZMacPRO_LBTTimeout;
 extern volatile BIT fEZMacPRO_AckTimeout;
 extern volatile BIT fEZMacPRO_AckSending;
+extern volatile BIT fEZMacPRO_BulkReceived;
 
 /* ======================================= *
  *  F U N C T I O N   P R O T O T Y P E S  *
@@ -52,10 +53,11 @@ void EZMacPRO_SyncWordReceived(void);
 void EZMacPRO_PacketDiscarded(void);
 void EZMacPRO_PacketReceived(U8);
 void EZMacPRO_PacketForwarding(void);
-void EZMacPRO_PacketSent(void);
+void EZMacPRO_PacketSent(U8);
 void EZMacPRO_CRCError(void);
 void EZMacPRO_LBTTimeout(void);
-void EZMacPRO_AckTimeout(void);
+void EZMacPRO_AckTimeout(U8);
 void EZMacPRO_AckSending(void);
+void EZMacPRO_BulkReceived(void);
 
 #endif //_EZMACPRO_CALLBACKS_H_
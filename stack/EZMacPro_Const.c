@@ -130,3 +130,39 @@ const SEGMENT_VARIABLE( EZMacProByteTime[4], U16, SEG_CODE) =
 {
 	BYTE_TIME(2400), BYTE_TIME(9600), BYTE_TIME(50000), BYTE_TIME(128000L)
 };
+
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+// radio registers of the RfSettingsB1 columns, 0: the column is not a register
+const SEGMENT_VARIABLE( LinkRateReg[NUMBER_OF_PARAMETER_B1], U8, SEG_CODE) =
+{
+	SI4432_IF_FILTER_BANDWIDTH, SI4432_CLOCK_RECOVERY_OVERSAMPLING_RATIO,
+	SI4432_CLOCK_RECOVERY_OFFSET_2, SI4432_CLOCK_RECOVERY_OFFSET_1, SI4432_CLOCK_RECOVERY_OFFSET_0,
+	SI4432_CLOCK_RECOVERY_TIMING_LOOP_GAIN_1, SI4432_CLOCK_RECOVERY_TIMING_LOOP_GAIN_0,
+	SI4432_TX_DATA_RATE_1, SI4432_TX_DATA_RATE_0, SI4432_MODULATION_MODE_CONTROL_1,
+	SI4432_FREQUENCY_DEVIATION, 0, SI4432_AFC_LOOP_GEARSHIFT_OVERRIDE, SI4431_AFC_LIMIT,
+	SI4432_AFC_TIMING_CONTROL
+};
+
+// lowest RSSI of the data rates: the sensitivity (2.4k: -117 dBm, 9.6k: -110 dBm,
+// 50k: -103 dBm, 128k: -97 dBm) plus LINK_RATE_MARGIN_DB
+const SEGMENT_VARIABLE( LinkRateRssi[4], U8, SEG_CODE) =
+{
+	RSSI_DBM(-117 + LINK_RATE_MARGIN_DB), RSSI_DBM(-110 + LINK_RATE_MARGIN_DB),
+	RSSI_DBM(-103 + LINK_RATE_MARGIN_DB), RSSI_DBM(-97 + LINK_RATE_MARGIN_DB)
+};
+
+// RSSI the TX power control keeps at the peer: the sensitivity plus LINK_POWER_MARGIN_DB
+const SEGMENT_VARIABLE( LinkPowerRssi[4], U8, SEG_CODE) =
+{
+	RSSI_DBM(-117 + LINK_POWER_MARGIN_DB), RSSI_DBM(-110 + LINK_POWER_MARGIN_DB),
+	RSSI_DBM(-103 + LINK_POWER_MARGIN_DB), RSSI_DBM(-97 + LINK_POWER_MARGIN_DB)
+};
+
+// output power of the TX power settings of the Si4432 in dBm
+const SEGMENT_VARIABLE( LinkPowerDbm[8], U8, SEG_CODE) =
+{
+	1, 2, 5, 8, 11, 14, 17, 20
+};
+	#endif
+#endif
@@ -60,6 +60,14 @@
 
 extern const SEGMENT_VARIABLE (EZMacProByteTime[4], U16, SEG_CODE);
 extern const SEGMENT_VARIABLE (FrequencyTable[50],U8, SEG_CODE);
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+extern const SEGMENT_VARIABLE (LinkRateReg[], U8, SEG_CODE);
+extern const SEGMENT_VARIABLE (LinkRateRssi[4], U8, SEG_CODE);
+extern const SEGMENT_VARIABLE (LinkPowerRssi[4], U8, SEG_CODE);
+extern const SEGMENT_VARIABLE (LinkPowerDbm[8], U8, SEG_CODE);
+	#endif
+#endif
 
 
 #endif //_EZMACPRO_CONST_H_
@@ -49,6 +49,10 @@
 
 //#define ANTENNA_DIVERSITY_ENABLED
 //#define PACKET_FORWARDING_SUPPORTED
+//#define EZMACPRO_CONTEXT					// the state is kept in EZMacProContext objects
+//#define FAST_BOOT						// the radio starts while BoardInit() runs, no reset in EZMacPRO_Init()
+//#define CHANNEL_QUALITY_ENABLED			// the channel search and the TX channel avoid the bad channels
+//#define FAST_SCAN_ENABLED					// RCR_FAST_SCAN: the MORE_CHANNEL search screens the RSSI of the channels
 
 
 /*!
@@ -64,7 +68,54 @@
  */
 #define FORWARDED_PACKET_TABLE_SIZE     8
 
-#define MAX_LBT_RETRIES                 2
+#define ACK_RTT_TABLE_SIZE              4       //peers with a measured ACK round-trip time
+
+#define SEQUENCE_TABLE_SIZE             8       //destinations with an own sequence number
+
+#define DUPLICATE_CACHE_SIZE            8       //senders with a remembered sequence number
+#define DUPLICATE_CACHE_AGE_MS          2000    //a sequence number is a duplicate within this time
+
+#define FRAME_POOL_SIZE                 3       //RX, ACK and one spare frame
+
+#define EVENT_QUEUE_SIZE                16      //has to be power of 2
+
+#define TASK_TABLE_SIZE                 4
+
+#define TIMER_WHEEL_TICK_MS             1
+#define TIMER_WHEEL_BITS                5       //32 slots per level
+#define TIMER_WHEEL_LEVELS              4       //2^20 ticks are placed directly
+
+#define AGGREGATE_LATENCY_MS            50      //a queued short message is sent within this time
+
+#define NVM_KEYS                        16      //record keys 1..15 of the flash store
+
+#define MAX_LBT_RETRIES                 4       //busy channel assessments before the LBTTimeout callback
+#define CSMA_MIN_BE                     2       //contention window of 2^BE LBT slots, doubled when busy
+#define CSMA_MAX_BE                     5
+
+#define RETRY_BACKOFF_SLOT_US           2000    //backoff slot of the retransmissions (RTCR)
+
+#define BULK_WINDOW_SIZE                8       //frames of a bulk transfer per block ACK
+#define BULK_FRAME_GAP_US               500     //the receiver is back in RX before the next frame
+#define BULK_MESSAGE_SIZE               1024    //reassembly buffer of the bulk transfer receiver
+#define BULK_REASSEMBLY_TIMEOUT_MS      1000    //an incomplete message is dropped after this time
+
+#define LINK_TABLE_SIZE                 4       //peers with an own data rate (LACR)
+#define LINK_RATE_MARGIN_DB             10      //RSSI above the sensitivity of a data rate to use it
+#define LINK_RATE_UP_ACKS               8       //acknowledged packets before the next data rate is requested
+#define LINK_RATE_FAILURES              2       //unacknowledged packets before the base data rate
+#define LINK_RATE_HOLD_MS               50      //the receiver returns to the base data rate after this time
+#define LINK_POWER_MARGIN_DB            18      //RSSI above the sensitivity the TX power is set for (LACR)
+#define LINK_POWER_HYSTERESIS_DB        3       //extra margin before the TX power is lowered
+#define LINK_POWER_RECOVERY             2       //TX power steps added at every missing ACK
+
+#define CHANNEL_NOISE_LIMIT_DBM         -90     //an idle channel is noisy above this RSSI (CHANNEL_QUALITY_ENABLED)
+#define CHANNEL_NOISE_PENALTY           4       //score of a noisy search dwell or a busy LBT assessment
+#define CHANNEL_CRC_PENALTY             8       //score of a packet with CRC error
+#define CHANNEL_BLACKLIST               32      //the channels with this score are skipped
+#define CHANNEL_PROBE_SKIPS             16      //a skipped channel is searched again after this many skips
+
+#define FAST_SCAN_RSSI_DBM              -105    //the fast scan waits for the preamble above this RSSI (FAST_SCAN_ENABLED)
 
 #define EZMACPRO_ADC_GAIN               0x00
 
@@ -215,6 +266,22 @@
 #error "maximum FORWARDED_PACKET_TABLE_SIZE is 15 !"
 #endif
 
+#if ((ACK_RTT_TABLE_SIZE < 1) || (ACK_RTT_TABLE_SIZE > 16))
+#error "ACK_RTT_TABLE_SIZE has to be between 1 and 16!"
+#endif
+
+#if ((SEQUENCE_TABLE_SIZE < 1) || (SEQUENCE_TABLE_SIZE > 32))
+#error "SEQUENCE_TABLE_SIZE has to be between 1 and 32!"
+#endif
+
+#if ((DUPLICATE_CACHE_SIZE < 1) || (DUPLICATE_CACHE_SIZE > 32))
+#error "DUPLICATE_CACHE_SIZE has to be between 1 and 32!"
+#endif
+
+#if ((DUPLICATE_CACHE_AGE_MS < 1) || (DUPLICATE_CACHE_AGE_MS > 60000))
+#error "DUPLICATE_CACHE_AGE_MS has to be between 1 and 60000!"
+#endif
+
 #if (RECEIVED_BUFFER_SIZE > 64)
 #error "The maximum size of the Received Data Buffer is 64!"
 #endif
@@ -227,6 +294,100 @@
 #error "ACK_PAYLOAD_DEFAULT_SIZE cannot be greater than ACK_BUFFER_SIZE!"
 #endif
 
+#if ((FRAME_POOL_SIZE < 2) || (FRAME_POOL_SIZE > 32))
+#error "FRAME_POOL_SIZE has to be between 2 and 32!"
+#endif
+
+#if ((EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) || (EVENT_QUEUE_SIZE > 128))
+#error "EVENT_QUEUE_SIZE has to be power of 2 and maximum 128!"
+#endif
+
+#if ((TIMER_WHEEL_BITS > 7) || ((TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS) > 31))
+#error "TIMER_WHEEL_BITS has to be maximum 7 and the wheel maximum 31 bits!"
+#endif
+
+#if ((AGGREGATE_LATENCY_MS < TIMER_WHEEL_TICK_MS) || (AGGREGATE_LATENCY_MS > 60000))
+#error "AGGREGATE_LATENCY_MS has to be between TIMER_WHEEL_TICK_MS and 60000!"
+#endif
+
+#if ((NVM_KEYS < 2) || (NVM_KEYS > 255))
+#error "NVM_KEYS has to be between 2 and 255!"
+#endif
+
+#if ((RETRY_BACKOFF_SLOT_US < 100) || (RETRY_BACKOFF_SLOT_US > 100000))
+#error "RETRY_BACKOFF_SLOT_US has to be between 100 and 100000!"
+#endif
+
+#if ((BULK_WINDOW_SIZE < 1) || (BULK_WINDOW_SIZE > 16))
+#error "BULK_WINDOW_SIZE has to be between 1 and 16!"
+#endif
+
+#if ((BULK_FRAME_GAP_US < 100) || (BULK_FRAME_GAP_US > 10000))
+#error "BULK_FRAME_GAP_US has to be between 100 and 10000!"
+#endif
+
+#if ((BULK_MESSAGE_SIZE < 64) || (BULK_MESSAGE_SIZE > 4096))
+#error "BULK_MESSAGE_SIZE has to be between 64 and 4096!"
+#endif
+
+#if ((BULK_REASSEMBLY_TIMEOUT_MS < 10) || (BULK_REASSEMBLY_TIMEOUT_MS > 60000))
+#error "BULK_REASSEMBLY_TIMEOUT_MS has to be between 10 and 60000!"
+#endif
+
+#if ((MAX_LBT_RETRIES < 1) || (MAX_LBT_RETRIES > 15))
+#error "MAX_LBT_RETRIES has to be between 1 and 15!"
+#endif
+
+#if ((CSMA_MIN_BE > CSMA_MAX_BE) || (CSMA_MAX_BE > 8))
+#error "CSMA_MIN_BE has to be maximum CSMA_MAX_BE and CSMA_MAX_BE maximum 8!"
+#endif
+
+#if ((LINK_TABLE_SIZE < 1) || (LINK_TABLE_SIZE > 16))
+#error "LINK_TABLE_SIZE has to be between 1 and 16!"
+#endif
+
+#if ((LINK_RATE_MARGIN_DB < 0) || (LINK_RATE_MARGIN_DB > 30))
+#error "LINK_RATE_MARGIN_DB has to be between 0 and 30!"
+#endif
+
+#if ((LINK_RATE_UP_ACKS < 1) || (LINK_RATE_UP_ACKS > 255) || (LINK_RATE_FAILURES < 1) || (LINK_RATE_FAILURES > 255))
+#error "LINK_RATE_UP_ACKS and LINK_RATE_FAILURES have to be between 1 and 255!"
+#endif
+
+#if ((LINK_RATE_HOLD_MS < 10) || (LINK_RATE_HOLD_MS > 60000))
+#error "LINK_RATE_HOLD_MS has to be between 10 and 60000!"
+#endif
+
+#ifdef CHANNEL_QUALITY_ENABLED
+#ifdef TRANSMITTER_ONLY_OPERATION
+#error "CHANNEL_QUALITY_ENABLED needs the receiver!"
+#endif
+#if ((CHANNEL_BLACKLIST < 1) || (CHANNEL_PROBE_SKIPS < 1) || (CHANNEL_BLACKLIST + CHANNEL_PROBE_SKIPS > 255))
+#error "CHANNEL_BLACKLIST and CHANNEL_PROBE_SKIPS have to be at least 1 and their sum maximum 255!"
+#endif
+#endif
+
+#ifdef FAST_SCAN_ENABLED
+#ifndef MORE_CHANNEL_IS_USED
+#error "FAST_SCAN_ENABLED needs MORE_CHANNEL_IS_USED!"
+#endif
+#ifdef TRANSMITTER_ONLY_OPERATION
+#error "FAST_SCAN_ENABLED needs the receiver!"
+#endif
+#if ((FAST_SCAN_RSSI_DBM < -120) || (FAST_SCAN_RSSI_DBM > 0))
+#error "FAST_SCAN_RSSI_DBM has to be between -120 and 0!"
+#endif
+#endif
+
+// the RSSI kept by the power control has to reach the next data rate
+#if ((LINK_POWER_MARGIN_DB < LINK_RATE_MARGIN_DB + 7) || (LINK_POWER_MARGIN_DB > 40))
+#error "LINK_POWER_MARGIN_DB has to be between LINK_RATE_MARGIN_DB + 7 and 40!"
+#endif
+
+#if ((LINK_POWER_HYSTERESIS_DB > 10) || (LINK_POWER_RECOVERY < 1) || (LINK_POWER_RECOVERY > 7))
+#error "LINK_POWER_HYSTERESIS_DB has to be maximum 10 and LINK_POWER_RECOVERY between 1 and 7!"
+#endif
+
 
 
 #endif //_EZMACPRO_DEFS_H_
@@ -0,0 +1,416 @@
+/*!\file EZMacPro_Event.c
+ * \brief Event queue between the EZMacPRO callbacks and the application.
+ *
+ * \n The callbacks are called from the MAC interrupts (or from the API functions
+ * \n and the deferred MAC interrupt while the MAC interrupts are disabled), so
+ * \n there is only one producer at a time. The application main loop is the
+ * \n only consumer. The queue is a single producer/single consumer ring: the
+ * \n producer writes only EventHead, the consumer writes only EventTail, no
+ * \n locking is needed.
+ *
+ * \n When the MAC has nothing to time, the port can stop the clocks while the
+ * \n main loop waits (ENTER_STOP_MODE()), see eventStopAllowed().
+ *
+ * \n A signal is an event without parameter which can be raised from any
+ * \n context, e.g. the timer wheel tick. It is a bit in EventSignals, raising
+ * \n it again before it is taken has no effect. The signals are taken after
+ * \n the queued events.
+ *
+ * \n EZMacPRO_Event_WaitFor() takes the first event of one type from the
+ * \n middle of the queue, the events before it stay queued in their order.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+/* ======================================= *
+ *				I N C L U D E				*
+ * ======================================= */
+
+#include "stack.h"
+
+#ifndef STM32_MODULE
+	// the signals can be raised with the interrupts already disabled (interrupts, critical
+	// sections of the caller), EA is restored instead of being enabled
+	#define EVENT_ENTER(save)	do { (save) = EA; EA = 0; } while (0)
+	#define EVENT_EXIT(save)	EA = (save)
+#endif
+
+/* ======================================= *
+ *	 G L O B A L	V A R I A B L E S	 *
+ * ======================================= */
+
+volatile SEGMENT_VARIABLE(EventQueue[EVENT_QUEUE_SIZE], EZMacProEvent, BUFFER_MSPACE);
+volatile SEGMENT_VARIABLE(EventHead, U8, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(EventTail, U8, EZMAC_PRO_GLOBAL_MSPACE);
+// one bit per signal event type
+volatile SEGMENT_VARIABLE(EventSignals, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+// statistics
+volatile SEGMENT_VARIABLE(EventLost, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(EventHighWater, U8, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(EventIdleCycles, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(EventIdleStart, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(EventStopCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+/* ======================================= *
+ *		L O C A L	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	eventTakeSignal()
+//
+// Return Value : U8 - the lowest raised signal of mask, EZMAC_EVENT_NONE if there is none
+// Parameters	: mask - the signals to take, one bit per event type
+//
+// Notes:
+//
+// The signal is cleared with the Cortex-M3 exclusive monitor, a signal raised by an interrupt
+// meanwhile is not lost. The 8051 uses a short critical section, it keeps the EA bit of the caller.
+//
+//------------------------------------------------------------------------------------------------
+static U8 eventTakeSignal(U32 mask)
+{
+	U32 signals;
+	U8 type;
+#ifndef STM32_MODULE
+	U8 ea;
+#endif
+
+#ifdef STM32_MODULE
+	do
+	{
+		signals = __LDREXW((U32 *)&EventSignals);
+		if ((signals & mask) == 0)
+		{
+			__CLREX();
+			return EZMAC_EVENT_NONE;
+		}
+		for (type = 0; (signals & mask & ((U32)1 << type)) == 0; type++);
+		signals &= ~((U32)1 << type);
+	} while (__STREXW(signals, (U32 *)&EventSignals));
+#else
+	EVENT_ENTER(ea);
+	signals = EventSignals;
+	if ((signals & mask) == 0)
+	{
+		EVENT_EXIT(ea);
+		return EZMAC_EVENT_NONE;
+	}
+	for (type = 0; (signals & mask & ((U32)1 << type)) == 0; type++);
+	EventSignals = signals & ~((U32)1 << type);
+	EVENT_EXIT(ea);
+#endif
+
+	return type;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	eventTakeType()
+//
+// Return Value : U8 - 1 if an event of type is copied to event
+// Parameters	: type - event type
+//				  event - pointer to the event
+//
+// Notes:
+//
+// The oldest queued event of type is taken, the older events of other types move one entry
+// towards the head to close the gap. The producer writes only the entry at EventHead, the
+// entries between EventTail and EventHead belong to the consumer, so no locking is needed.
+//
+//------------------------------------------------------------------------------------------------
+static U8 eventTakeType(U8 type, VARIABLE_SEGMENT_POINTER(event, EZMacProEvent, APPLICATION_MSPACE))
+{
+	U8 tail = EventTail;
+	U8 head = EventHead;
+	U8 i;
+	U8 prev;
+
+	for (i = tail; i != head; i = (i + 1) & (EVENT_QUEUE_SIZE - 1))
+	{
+		if (EventQueue[i].type != type)
+			continue;
+
+		event->type = type;
+		event->param = EventQueue[i].param;
+		while (i != tail)
+		{
+			prev = (i - 1) & (EVENT_QUEUE_SIZE - 1);
+			EventQueue[i].type = EventQueue[prev].type;
+			EventQueue[i].param = EventQueue[prev].param;
+			i = prev;
+		}
+		// release the entry after the others are moved
+		EventTail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+		return 1;
+	}
+	return 0;
+}
+
+#ifdef ENTER_STOP_MODE
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	eventStopAllowed()
+//
+// Return Value : U8 - 1 if the clocks can be stopped while waiting
+// Parameters	: None
+//
+// Notes:
+//
+// The MAC timer does not run in STOP mode, so the MCU may only stop if nothing is timed by it:
+// the MAC is in Sleep or Idle state (not waking up, not in the LBT, the ACK wait or any other
+// TX or RX state), no MAC timeout is armed and no software timer is running. The MAC clock
+// stands still during STOP, the timeouts are always started from the current time, so no
+// armed deadline can be shifted by it. Only the radio interrupt (e.g. its wake-up timer) or
+// another wake-up line of the port ends the STOP.
+//
+//------------------------------------------------------------------------------------------------
+static U8 eventStopAllowed(void)
+{
+	U8 msr = EZMacProReg.name.MSR;
+
+	if ((msr != EZMAC_PRO_SLEEP) && (msr != EZMAC_PRO_IDLE))
+		return 0;
+	if (MAC_TIMER_PENDING())
+		return 0;
+	if (EZMacPRO_Timer_Active(NULL))
+		return 0;
+	return 1;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	eventSleep()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Called with the interrupts disabled, the MCU sleeps until an interrupt is pending and the
+// interrupt runs before it returns, with the interrupts disabled again. The time spent in sleep
+// is added to EventIdleCycles.
+//
+//------------------------------------------------------------------------------------------------
+static void eventSleep(void)
+{
+	U32 start;
+
+	start = CYCLE_COUNTER();
+#ifdef ENTER_STOP_MODE
+	if (eventStopAllowed())
+	{
+		ENTER_STOP_MODE();
+		EventStopCount++;
+	}
+	else
+#endif
+		WAIT_FOR_INTERRUPT();
+	EventIdleCycles += CYCLE_COUNTER() - start;
+	// let the pending interrupt run
+	ENABLE_GLOBAL_INTERRUPTS();
+	DISABLE_GLOBAL_INTERRUPTS();
+}
+
+/* ======================================= *
+ *	 P U B L I C	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Event_Init()
+//					Empties the event queue and clears the statistics. It is called by
+//					EZMacPRO_Init() before the first callback.
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Event_Init(void)
+{
+	EventHead = 0;
+	EventTail = 0;
+	EventSignals = 0;
+	EventLost = 0;
+	EventHighWater = 0;
+	EventIdleCycles = 0;
+	EventStopCount = 0;
+	CYCLE_COUNTER_INIT();
+	EventIdleStart = CYCLE_COUNTER();
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Event_Put()
+//					Puts an event into the queue. It should be called from the callbacks only.
+//					If the queue is full the event is dropped and EventLost is incremented, the
+//					events already in the queue are never overwritten.
+//
+// Return Value :	None
+// Parameters	:	type - event type (EZMacProEventType)
+//					param - event parameter, e.g. the RSSI of the received packet
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Event_Put(U8 type, U8 param)
+{
+	U8 head = EventHead;
+	U8 next = (head + 1) & (EVENT_QUEUE_SIZE - 1);
+	U8 used;
+
+	if (next == EventTail)
+	{	// queue full
+		EventLost++;
+		return;
+	}
+
+	EventQueue[head].type = type;
+	EventQueue[head].param = param;
+	// publish the entry after it is written
+	EventHead = next;
+
+	used = (next - EventTail) & (EVENT_QUEUE_SIZE - 1);
+	if (used > EventHighWater)
+		EventHighWater = used;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Event_Signal()
+//					Raises a signal event. It can be called from any interrupt or from the main
+//					loop, the event is taken with parameter 0.
+//
+// Return Value :	None
+// Parameters	:	type - event type (EZMacProEventType)
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Event_Signal(U8 type)
+{
+#ifdef STM32_MODULE
+	U32 signals;
+
+	do
+	{
+		signals = __LDREXW((U32 *)&EventSignals) | ((U32)1 << type);
+	} while (__STREXW(signals, (U32 *)&EventSignals));
+#else
+	U8 ea;
+
+	EVENT_ENTER(ea);
+	EventSignals |= ((U32)1 << type);
+	EVENT_EXIT(ea);
+#endif
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Event_Get()
+//					Takes the oldest event from the queue, or a raised signal if the queue is
+//					empty, without waiting.
+//
+// Return Value :	1: an event is copied to event
+//					0: the queue is empty
+// Parameters	:	event - pointer to the event
+//------------------------------------------------------------------------------------------------
+U8 EZMacPRO_Event_Get(VARIABLE_SEGMENT_POINTER(event, EZMacProEvent, APPLICATION_MSPACE))
+{
+	U8 tail = EventTail;
+
+	if (tail == EventHead)
+	{
+		event->type = eventTakeSignal(0xFFFFFFFF);
+		event->param = 0;
+		return (event->type != EZMAC_EVENT_NONE) ? 1 : 0;
+	}
+
+	event->type = EventQueue[tail].type;
+	event->param = EventQueue[tail].param;
+	// release the entry after it is read
+	EventTail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+	return 1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Event_Wait()
+//					Takes the oldest event or signal, the MCU sleeps until one arrives.
+//					The queue is checked with the interrupts disabled, an interrupt pending at
+//					that time still wakes up the core, so no event can be missed. The time spent
+//					in sleep is added to EventIdleCycles. If the port supports it and the MAC
+//					has nothing to time the MCU enters STOP mode, EventStopCount is incremented.
+//					The cycle counter stops as well, the time spent in STOP is not counted.
+//
+// Return Value :	None
+// Parameters	:	event - pointer to the event
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Event_Wait(VARIABLE_SEGMENT_POINTER(event, EZMacProEvent, APPLICATION_MSPACE))
+{
+	DISABLE_GLOBAL_INTERRUPTS();
+	while ((EventTail == EventHead) && (EventSignals == 0))
+		eventSleep();
+	ENABLE_GLOBAL_INTERRUPTS();
+
+	EZMacPRO_Event_Get(event);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Event_WaitFor()
+//					Sleeps until an event of the given type is taken from the queue. The events
+//					of other types stay queued for EZMacPRO_Event_Get() or EZMacPRO_Event_Wait(),
+//					the queue has to have room for them meanwhile. It replaces the
+//					WAIT_FLAG_TRUE() loops of the callback flags.
+//
+// Return Value :	the parameter of the event
+// Parameters	:	type - event type to wait for
+//------------------------------------------------------------------------------------------------
+U8 EZMacPRO_Event_WaitFor(U8 type)
+{
+	SEGMENT_VARIABLE(event, EZMacProEvent, APPLICATION_MSPACE);
+	U8 head;
+
+	for (;;)
+	{
+		head = EventHead;
+		if (eventTakeType(type, &event))
+			return event.param;
+		if (eventTakeSignal((U32)1 << type) != EZMAC_EVENT_NONE)
+			return 0;
+
+		// sleep until a new event or the signal arrives
+		DISABLE_GLOBAL_INTERRUPTS();
+		while ((EventHead == head) && ((EventSignals & ((U32)1 << type)) == 0))
+			eventSleep();
+		ENABLE_GLOBAL_INTERRUPTS();
+	}
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Event_IdlePercent()
+//					Returns the ratio of the time spent in EZMacPRO_Event_Wait() since the previous
+//					call and starts a new measurement. The cycle counter wraps around in about
+//					one minute at 72MHz, it should be called more often than that.
+//
+// Return Value :	idle time in percent, 0 if there is no cycle counter
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+U8 EZMacPRO_Event_IdlePercent(void)
+{
+	U32 now;
+	U32 total;
+	U32 idle;
+
+	DISABLE_GLOBAL_INTERRUPTS();
+	now = CYCLE_COUNTER();
+	total = now - EventIdleStart;
+	idle = EventIdleCycles;
+	EventIdleCycles = 0;
+	EventIdleStart = now;
+	ENABLE_GLOBAL_INTERRUPTS();
+
+	total /= 100;
+	if (total == 0)
+		return 0;
+	if (idle >= total * 100)
+		return 100;
+	return (U8)(idle / total);
+}
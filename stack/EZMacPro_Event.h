@@ -0,0 +1,82 @@
+/*!\file EZMacPro_Event.h
+ * \brief Header of EZMacPro_Event.c.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+#ifndef _EZMACPRO_EVENT_H_
+#define _EZMACPRO_EVENT_H_
+
+
+                /* ======================================= *
+                 *          D E F I N I T I O N S          *
+                 * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// event types, one for each callback, and the signals
+//------------------------------------------------------------------------------------------------
+typedef enum
+{
+	EZMAC_EVENT_NONE = 0,
+	EZMAC_EVENT_STATE_WAKE_UP,
+	EZMAC_EVENT_STATE_SLEEP,
+	EZMAC_EVENT_STATE_IDLE,
+	EZMAC_EVENT_STATE_RX,
+	EZMAC_EVENT_STATE_TX,
+	EZMAC_EVENT_STATE_ERROR,
+	EZMAC_EVENT_LF_TIMER_EXPIRED,
+	EZMAC_EVENT_LOW_BATTERY,
+	EZMAC_EVENT_SYNC_WORD_RECEIVED,
+	EZMAC_EVENT_CRC_ERROR,
+	EZMAC_EVENT_PACKET_DISCARDED,
+	EZMAC_EVENT_PACKET_RECEIVED,		// param: RSSI of the packet
+	EZMAC_EVENT_PACKET_FORWARDING,
+	EZMAC_EVENT_PACKET_SENT,			// param: number of transmissions
+	EZMAC_EVENT_LBT_TIMEOUT,
+	EZMAC_EVENT_ACK_TIMEOUT,			// param: number of transmissions
+	EZMAC_EVENT_ACK_SENDING,
+	EZMAC_EVENT_BULK_RECEIVED,			// the message is read by EZMacPRO_Bulk_Read()
+	EZMAC_EVENT_TIMER					// signal: a timer wheel slot is reached
+} EZMacProEventType;
+
+//------------------------------------------------------------------------------------------------
+// event queue entry
+//------------------------------------------------------------------------------------------------
+typedef struct EZMacProEvent
+{
+	U8 type;
+	U8 param;
+} EZMacProEvent;
+
+
+                /* ======================================= *
+                 *     G L O B A L   V A R I A B L E S     *
+                 * ======================================= */
+
+extern volatile SEGMENT_VARIABLE(EventLost, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(EventHighWater, U8, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(EventIdleCycles, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(EventStopCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+
+                /* ======================================= *
+                 *  F U N C T I O N   P R O T O T Y P E S  *
+                 * ======================================= */
+
+void EZMacPRO_Event_Init(void);
+void EZMacPRO_Event_Put(U8 type, U8 param);
+void EZMacPRO_Event_Signal(U8 type);
+U8   EZMacPRO_Event_Get(VARIABLE_SEGMENT_POINTER(event, EZMacProEvent, APPLICATION_MSPACE));
+void EZMacPRO_Event_Wait(VARIABLE_SEGMENT_POINTER(event, EZMacProEvent, APPLICATION_MSPACE));
+U8   EZMacPRO_Event_WaitFor(U8 type);
+U8   EZMacPRO_Event_IdlePercent(void);
+
+
+#endif //_EZMACPRO_EVENT_H_
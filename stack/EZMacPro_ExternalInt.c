@@ -21,6 +21,10 @@
  *	 G L O B A L	V A R I A B L E S	 *
  * ======================================= */
 
+// longest run of the external interrupt and of its deferred part in CPU cycles
+volatile SEGMENT_VARIABLE(ExtIntMaxCycles, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(ExtIntDeferredMaxCycles, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
 /* ======================================= *
  *		L O C A L	F U N C T I O N S		*
  * ======================================= */
@@ -51,9 +55,13 @@
 // The external interrupt should not call functions from other modules. This would create cause
 // a multiple call to segment warning and result in poor RAM usage.
 //
+// The application callbacks of the ACK sending and packet forwarding paths and the FIFO writes
+// after them are not done here, see externalIntDeferredISR().
+//
 //-----------------------------------------------------------------------------------------------
 INTERRUPT(externalIntISR, INTERRUPT_INT0)
 {
+	U32 start = CYCLE_COUNTER();
 	U8 state;
 	U8 msr;
 	U8 intStatus1;
@@ -100,6 +108,10 @@ INTERRUPT(externalIntISR, INTERRUPT_INT0)
 		EZMacPRO_LowBattery();
 		//! ENABLE_MAC_EXT_INTERRUPT();
 	}
+
+	start = CYCLE_COUNTER() - start;
+	if (start > ExtIntMaxCycles)
+		ExtIntMaxCycles = start;
 }
 //------------------------------------------------------------------------------------------------
 // Function Name
@@ -125,6 +137,13 @@ void extIntWakeUp(U8 intStatus2)
 	if (intStatus2 & SI4432_ICHIPRDY)
 	{
 		extIntDisableInterrupts();				// disable all interrupts
+		if (XtalStartPending)
+		{	// crystal start-up time of this wake-up
+			XtalStartPending = 0;
+			XtalStartTime = MAC_TIMER_NOW() - XtalStartStamp;
+			if (XtalStartTime > XtalStartMax)
+				XtalStartMax = XtalStartTime;
+		}
 		EZMacProReg.name.MSR = EZMAC_PRO_IDLE;	// go to Idle state
 		EZMacPRO_StateIdleEntered();			// Call the Idle state entered callback function.
 	}
@@ -135,6 +154,8 @@ void extIntWakeUp(U8 intStatus2)
 
 		extIntTimeout (TIMEOUT_XTAL_START);		// set time out
 		ENABLE_MAC_TIMER_INTERRUPT();
+		XtalStartStamp = MAC_TIMER_NOW();		// measure the start-up after the reset
+		XtalStartPending = 1;
 		extIntSetFunction1(SI4432_XTON);		// enable the XTAL
 	}
 	else
@@ -169,6 +190,7 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 	#ifdef EXTENDED_PACKET_FORMAT
 		#ifndef TRANSMITTER_ONLY_OPERATION
 	U8 temp8;
+	U16 map;
 		#endif
 	#endif
 
@@ -188,6 +210,7 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 			// if packet sent interrupt is occured
 			if (intStatus1 & SI4432_IPKSENT)
 			{
+				EZMacPRO_Boot_Mark(EZMAC_BOOT_FIRST_TX);
 	#ifdef FOUR_CHANNEL_IS_USED
 				// if Automatic Frequency Change feature is on then send the same packet on the four channels
 				if (EZMacProReg.name.TCR & 0x04)	// if AFCH==1 && ACKRQ = ignore
@@ -210,7 +233,17 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 				if (!(intStatus2 & SI4432_IWUT))
 				{
 		#ifndef TRANSMITTER_ONLY_OPERATION
-					if ((EZMacProReg.name.TCR & 0x84) == 0x80) // if ACKRQ = 1 && AFCH==0
+					// more frames in the round of the bulk transfer, the deferred part loads the next one
+					if (BulkTxLength && BulkTxNext < BULK_WINDOW_SIZE)
+					{
+						extIntSpiWriteReg (SI4432_INTERRUPT_ENABLE_1, 0x00);
+						DISABLE_MAC_TIMER_INTERRUPT();
+						EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_DEFERRED_BULK;
+						TRIGGER_MAC_DEFERRED_INTERRUPT();
+						break;
+					}
+					// if ACKRQ = 1 && AFCH==0, or the last frame of the bulk transfer round (block ACK)
+					if (BulkTxLength || (EZMacProReg.name.TCR & 0x84) == 0x80)
 					{
 			#ifndef B1_ONLY
 						if (EZMacProReg.name.DTR == 0)//if rev V2 chip is used
@@ -221,8 +254,8 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 						extIntSpiWriteReg (SI4432_INTERRUPT_ENABLE_1, SI4432_ENCRCERROR|SI4432_ENPKVALID);
 						// disable Enable2 interrupts
 						extIntSetEnable2(0x00);
-						// start timer with ACK timeout
-						extIntTimeout(TimeoutACK);
+						// start timer with the ACK timeout of the peer
+						extIntTimeout(extIntAckWaitTime());
 						// go to next state
 						EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_WAIT_FOR_ACK;
 						ENABLE_MAC_INTERRUPTS();
@@ -238,7 +271,11 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 				// Next state after TX
 				// disable PKSENT
 				// call the packet sent callback function
-				EZMacPRO_PacketSent();
+	#ifdef EXTENDED_PACKET_FORMAT
+				EZMacPRO_PacketSent(EZMacProTxAttempts);
+	#else
+				EZMacPRO_PacketSent(1);
+	#endif
 				extIntSpiWriteReg (SI4432_INTERRUPT_ENABLE_1, 0x00);
 				extIntGotoNextStateUsingSECR(1);	// go to the next state
 			}
@@ -261,8 +298,8 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 			{
 				// read out the control byte
 				temp8 = extIntSpiReadReg(SI4432_RECEIVED_HEADER_3);
-				// if the packet is an acknowledgement
-				if (temp8 & 0x08)
+				// if the packet is an acknowledgement (and not a bulk transfer frame)
+				if ((temp8 & BULK_CTRL_MARK) == 0x08)
 				{
 					// disable PKVALID & CRCERROR
 					extIntSpiWriteReg (SI4432_INTERRUPT_ENABLE_1, 0x00);
@@ -275,11 +312,33 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 						EZMacProReg.name.PLEN = extIntSpiReadReg(SI4432_RECEIVED_PACKET_LENGTH);
 					}
 
-					// read out the received payload from the FIFO and save the RxBuffer
-					extIntSpiReadFIFO (EZMacProReg.name.PLEN, RxBuffer);
+					if (BulkTxLength)
+					{	// the block ACK of the bulk transfer, the bitmap of the received frames
+						map = 0;
+						if (EZMacProReg.name.PLEN >= 2)
+						{
+							map = extIntSpiReadReg(SI4432_FIFO_ACCESS);
+							map |= (U16)extIntSpiReadReg(SI4432_FIFO_ACCESS) << 8;
+						}
+						extIntAckRttSample();
+						extIntBulkAck(map);
+						break;
+					}
 
+					// read out the received payload from the FIFO and save it to a frame of the pool
+					if (extIntRxFrameAlloc() != FRAME_POOL_INVALID)
+						extIntSpiReadFIFO (EZMacProReg.name.PLEN, FRAME_POOL_BUFFER(RxFrame));
+
+					// update the round-trip time of the peer
+					extIntAckRttSample();
+					// take the data rate granted by the peer
+					if (EZMacProReg.name.LACR & LACR_RATE)
+						extIntLinkAck(temp8);
+					// set the TX power of the link from the RSSI at the peer
+					if (EZMacProReg.name.LACR & LACR_POWER)
+						extIntLinkPower();
 					//call the packet sent callback function
-					EZMacPRO_PacketSent();
+					EZMacPRO_PacketSent(EZMacProTxAttempts);
 					// go next state
 					extIntGotoNextStateUsingSECR(1);
 					break;
@@ -298,18 +357,14 @@ void	extIntTX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 					break;
 				}
 			}
-			// if received a packet with CRC error
-			else if ((intStatus1 & SI4432_ICRCERROR)== SI4432_ICRCERROR)
+			else
 			{
 			#ifdef FOUR_CHANNEL_IS_USED
-		 		extIntIncrementError (EZMAC_PRO_ERROR_BAD_CRC);
+				// if received a packet with CRC error
+				if ((intStatus1 & SI4432_ICRCERROR)== SI4432_ICRCERROR)
+		 			extIntIncrementError (EZMAC_PRO_ERROR_BAD_CRC);
 			#endif
-				// go next state
-				extIntGotoNextStateUsingSECR(1);
-				break;
-			}
-			else
-			{
+				// keep listening, the ACK timeout ends the wait (and retransmits the packet)
 				// clear RX FIFO
 				temp8 = extIntSpiReadReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2);
 				temp8 |= SI4432_FFCLRRX;
@@ -480,6 +535,9 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 			{
 				//Disable All interrupts
 				extIntDisableInterrupts();
+	#ifdef CHANNEL_QUALITY_ENABLED
+				extIntChannelResult(0);
+	#endif
 				//Disable the receiver
 				extIntSetFunction1(SI4432_XTON);
 
@@ -516,8 +574,8 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 					EZMacProReg.name.DID = extIntSpiReadReg(SI4432_RECEIVED_HEADER_2);
 				}
 	#endif
-				//if received an ACK message and PF is disable then restart the receiving
-				if (((EZMacProReg.name.RCTRL & 0x08) == 0x08) && ((EZMacProReg.name.RCR & 0x80) == 0x00))
+				//if received an ACK message (not a bulk transfer frame) and PF is disable then restart the receiving
+				if (((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == 0x08) && ((EZMacProReg.name.RCR & 0x80) == 0x00))
 				{
 					// clear RX FIFO
 					temp8 = extIntSpiReadReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2);
@@ -543,8 +601,11 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 					//select the first freq. channel
 					SelectedChannel = 0;
 					extIntSpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0+SelectedChannel]);
+		#ifdef FAST_SCAN_ENABLED
+					FastScanDwell = 0;
+		#endif
 					// start timer with channel search timeout
-					extIntTimeout(TimeoutChannelSearch);
+					extIntTimeout(SEARCH_TIMEOUT);
 					ENABLE_MAC_TIMER_INTERRUPT();
 	#endif
 					//go to the next state
@@ -555,27 +616,50 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 					break;
 				}
 
-				//read out the received payload from the FIFO and save to RxBuffer
-				extIntSpiReadFIFO (EZMacProReg.name.PLEN, RxBuffer);
+				//take a frame from the pool for the payload
+				if (extIntRxFrameAlloc() == FRAME_POOL_INVALID)
+				{
+					// clear RX FIFO
+					temp8 = extIntSpiReadReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2);
+					temp8 |= SI4432_FFCLRRX;
+					extIntSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+					temp8 &= ~SI4432_FFCLRRX;
+					extIntSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+					//save the receive status to the RSR Mac register
+					EZMacProReg.name.RSR = EZMacProReceiveStatus;
+					//no free frame, the packet is lost
+					EZMacPRO_PacketDiscarded();
+					// all done use SECR to determine next state
+					extIntGotoNextStateUsingSECR(0);
+					break;
+				}
+
+				//read out the received payload from the FIFO and save to the RX frame
+				extIntSpiReadFIFO (EZMacProReg.name.PLEN, FRAME_POOL_BUFFER(RxFrame));
 
 				/* If the packet is meant to me. */
 				if (!extIntHeaderError())
 				{
 	#ifdef STANDARD_PACKET_FORMAT
-					//save the RSSI value to RSSI Mac register
-					EZMacProReg.name.RSSI = EZMacProRSSIvalue;
-					//save the receive status to the RSR Mac register
-					EZMacProReg.name.RSR = EZMacProReceiveStatus;
-					/* Call PacketReceived callback with RSSI value. */
-					EZMacPRO_PacketReceived(EZMacProRSSIvalue);
+					// publish the packet and call the PacketReceived callback
+					extIntPacketReceived();
 					// all done use SECR to determine next state
 					extIntGotoNextStateUsingSECR(0);
 					break;
 	#endif
 	#ifdef EXTENDED_PACKET_FORMAT
+					// a retransmission of the last packet of the sender (the ACK was lost) is
+					// acknowledged again, but not published
+					if ((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == BULK_CTRL_MARK)
+						RxDuplicate = extIntBulkFrameCheck();
+					else
+						RxDuplicate = extIntDuplicateCheck();
 		#ifndef RECEIVER_ONLY_OPERATION
-					// Is an ACK requested and the Sender ID isn't a broadcast address
-					if (((EZMacProReg.name.RCTRL & 0x04)	== 0x04) && ( EZMacProReg.name.RSID != 255))
+					// Is an ACK requested (the block ACK by the last frame of a bulk transfer round)
+					// and the Sender ID isn't a broadcast address
+					if ((((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == 0x04) ||
+						((EZMacProReg.name.RCTRL & (BULK_CTRL_MARK | BULK_CTRL_LAST)) == (BULK_CTRL_MARK | BULK_CTRL_LAST))) &&
+						( EZMacProReg.name.RSID != 255))
 					{
 			#ifndef B1_ONLY
 						if (EZMacProReg.name.DTR == 0) //if rev V2 chip is used
@@ -624,12 +708,18 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 			#endif
 						//set the ACK packet
 						// the transmit registers are volatile and need to be restored by the transmit function
-						temp8 = (EZMacProReg.name.MCR >>3) & 0x03;
+						// the control byte of the ACK packet (clear ACKREQ bit, set ACK bit)
+						temp8 = (EZMacProReg.name.RCTRL & ~0x04) | 0x08 | ((EZMacProReg.name.MCR >>3) & 0x03);
+			#ifdef TRANSCEIVER_OPERATION
+						// the ACK carries the granted data rate instead of the requested one
+						if ((EZMacProReg.name.LACR & LACR_RATE) && ((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == 0x04))
+							temp8 = (EZMacProReg.name.RCTRL & ~0x07) | 0x08 | extIntLinkGrant();
+			#endif
 
 						if (EZMacProReg.name.MCR & 0x80)
 						{	// if CID is used
-							// set the control byte of the ACK packet( clear ACKREQ bit, set ACK bit)
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, ((EZMacProReg.name.RCTRL & ~0x04) | 0x08 | temp8));
+							// set the control byte of the ACK packet
+							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8);
 							// copy CID from RCID
 							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.RCID);
 							// set Sender ID to Self ID
@@ -639,8 +729,8 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 						}
 						else
 						{
-							//set the control byte of the ACK packet( clear ACKREQ bit, set ACK bit)
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, ((EZMacProReg.name.RCTRL & ~0x04) | 0x08 | temp8));
+							//set the control byte of the ACK packet
+							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8);
 							// set Sender ID to Self ID
 							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SFID);
 							// set DID to the Received SID
@@ -660,17 +750,6 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 							//set the payload length to default
 							AckBufSize = ACK_PAYLOAD_DEFAULT_SIZE;
 							extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH,AckBufSize);
-
-							//clear AckBuffer
-							for (temp8 = 0; temp8 < AckBufSize; temp8++)
-								AckBuffer[temp8] = 0x00;
-
-							//callback to customise Ack Packet payload
-							EZMacPRO_AckSending();
-
-							//Fill FIFO from AckBuffer
-							for (temp8 = 0; temp8 < AckBufSize; temp8++)
-								extIntSpiWriteReg(SI4432_FIFO_ACCESS,AckBuffer[temp8]);
 						}
 						else //if static payload length mode is set
 						{
@@ -678,62 +757,24 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 							//AckBufSize = EZMacProReg.name.PLEN;
 							//extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH,AckBufSize);
 							extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH,EZMacProReg.name.PLEN);
-
-							//if fix packet length is greater than ack buffer size
-							if (EZMacProReg.name.PLEN > ACK_BUFFER_SIZE)
-							{
-								//Clear AckBuffer
-								for (temp8=0; temp8 < ACK_BUFFER_SIZE; temp8++)
-									AckBuffer[temp8] = 0x00;
-
-								//Callback to customise Ack Packet payload
-								EZMacPRO_AckSending();
-
-								//Fill FIFO from AckBuffer
-								for (temp8 = 0; temp8 < ACK_BUFFER_SIZE; temp8++)
-									extIntSpiWriteReg(SI4432_FIFO_ACCESS,AckBuffer[temp8]);
-								for (temp8 = ACK_BUFFER_SIZE; temp8 < EZMacProReg.name.PLEN; temp8++)
-									extIntSpiWriteReg(SI4432_FIFO_ACCESS,0x00);
-
-							}
-							else//if fix packet length is smaller or equal than ack buffer size
-							{
-								//Clear AckBuffer
-								for (temp8=0;temp8 < EZMacProReg.name.PLEN;temp8++)
-									AckBuffer[temp8] = 0x00;
-
-								//Callback to customise Ack Packet payload
-								EZMacPRO_AckSending();
-
-								//Fill FIFO from AckBuffer
-								for (temp8 = 0; temp8 < EZMacProReg.name.PLEN; temp8++)
-									extIntSpiWriteReg(SI4432_FIFO_ACCESS,AckBuffer[temp8]);
-							}
-
 						}
 
-						// enable ENPKSENT bit
-						extIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
-
-						// go to the next state
-						EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_WAIT_FOR_SEND_ACK;
-
-						// start timer with transmit packet timeout
-						extIntTimeout(TimeoutTX_Packet);
-						ENABLE_MAC_INTERRUPTS();
-						// enable transmit
-						extIntSetFunction1(SI4432_TXON | SI4432_XTON);
+						// the payload is filled and the transmission is started by the deferred part
+						EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_DEFERRED_ACK;
+						TRIGGER_MAC_DEFERRED_INTERRUPT();
 						break;
 					}
 					/* No ack requested, or the sender ID is the broadcast address. */
 					else
 					{
-						//save the RSSI value to RSSI Mac register
-						EZMacProReg.name.RSSI = EZMacProRSSIvalue;
-						//save the receive status to the RSR Mac register
-						EZMacProReg.name.RSR = EZMacProReceiveStatus;
-						/* Call PacketReceived callback with RSSI value. */
-						EZMacPRO_PacketReceived(EZMacProRSSIvalue);
+						if (RxDuplicate)
+							extIntPacketDuplicate();
+						else if ((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == BULK_CTRL_MARK)
+							// the fragment is kept, the message is published when complete
+							extIntBulkReceived();
+						else
+							// publish the packet and call the PacketReceived callback
+							extIntPacketReceived();
 						// all done use SECR to determine next state
 						extIntGotoNextStateUsingSECR(0);
 						break;
@@ -777,78 +818,10 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 						}
 				#endif //B1_ONLY
 			#endif //ANTENNA_DIVERSITY_ENABLED
-						// call the forward packet callback function
-						EZMacPRO_PacketForwarding();
-						// decrement radius
-						// already checked for non-zero radius
-						temp8 = EZMacProReg.name.RCTRL;
-						temp8--;
-						// write modified RX Header back to TX
-						// The transmit registers are volatile and need to be restored by transmit function
-						// Only Extended packet format supports forwarding
-						// Set the packet headers
-						if (EZMacProReg.name.MCR & 0x80)
-						{	// if CID is used
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_0, EZMacProReg.name.DID);
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.RSID);
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.RCID);
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8);
-						}
-						else
-						{
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.DID);
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.RSID);
-							extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8);
-						}
-
-						// write the transmit packet length back
-						extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH, EZMacProReg.name.PLEN);
-						// write RX packet back to FIFO
-						extIntSpiWriteFIFO (EZMacProReg.name.PLEN, RxBuffer);
-
-						// save the RSSI value to RSSI Mac register
-						EZMacProReg.name.RSSI = EZMacProRSSIvalue;
-						// save the receive status to the RSR Mac register
-						EZMacProReg.name.RSR = EZMacProReceiveStatus;
-						// Call PacketReceived callback with RSSI value.
-						EZMacPRO_PacketReceived(EZMacProRSSIvalue);
-
-						if (EZMacProReg.name.TCR & 0x08)
-						{	// LBT enabled
-							// Set Listen Before Talk Limit to RSSI threshold register
-							extIntSpiWriteReg(SI4432_RSSI_THRESHOLD, EZMacProReg.name.LBTLR);
-
-							// disable all Si443x interrupt enable 1 sources
-							extIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, 0x00);
-							// enable RSSI interrupt
-							extIntSetEnable2(SI4432_ENRSSI);
-
-							EZMacProLBT_Retrys = 0;
-							BusyLBT = 0;
-							//go to the next state
-							EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_FORWARDING_LBT_START_LISTEN;
-							//wait for the fix 0.5ms
-							//start timer with fix ETSI LBT timeout
-							extIntTimeout(TIMEOUT_LBTI_ETSI);
-
-							//start receiver
-							extIntSetFunction1(SI4432_RXON|SI4432_XTON);
-							ENABLE_MAC_TIMER_INTERRUPT();
-							break;
-						}
-						else
-						{
-							// enable ENPKSENT bit
-							extIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
-							// enable TX
-							extIntSetFunction1(SI4432_TXON|SI4432_XTON);
-							// start timer with transmit packet timeout
-							extIntTimeout(TimeoutTX_Packet);
-							// go to the next state
-							EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_FORWARDING_WAIT_FOR_TX;
-							ENABLE_MAC_TIMER_INTERRUPT();
-							break;
-						}
+						// the packet is written back and sent by the deferred part
+						EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_DEFERRED_FORWARDING;
+						TRIGGER_MAC_DEFERRED_INTERRUPT();
+						break;
 					}
 				}
 	#endif //PACKET_FORWARDING_SUPPORTED
@@ -870,6 +843,9 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 			{
 	#ifdef FOUR_CHANNEL_IS_USED
 				extIntIncrementError(EZMAC_PRO_ERROR_BAD_CRC);
+	#endif
+	#ifdef CHANNEL_QUALITY_ENABLED
+				extIntChannelResult(1);
 	#endif
 				EZMacProReg.name.RSR = EZMacProReceiveStatus;
 				EZMacPRO_CRCError();
@@ -900,8 +876,11 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 				//select the nex channel
 				SelectedChannel = 0;
 				extIntSpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0+SelectedChannel]);
+		#ifdef FAST_SCAN_ENABLED
+				FastScanDwell = 0;
+		#endif
 				// start timer with channel search timeout
-				extIntTimeout(TimeoutChannelSearch);
+				extIntTimeout(SEARCH_TIMEOUT);
 				ENABLE_MAC_TIMER_INTERRUPT();
 	#endif
 				//go to the next state
@@ -922,12 +901,14 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 				extIntSpiWriteReg (SI4432_INTERRUPT_ENABLE_1, 0x00);
 				// cancel timeout
 				DISABLE_MAC_TIMER_INTERRUPT();
-				//save the RSSI value to RSSI Mac register
-				EZMacProReg.name.RSSI = EZMacProRSSIvalue;
-				//save the receive status to the RSR Mac register
-				EZMacProReg.name.RSR = EZMacProReceiveStatus;
-				//call Packet received call back function
-				EZMacPRO_PacketReceived(EZMacProRSSIvalue);
+				if (RxDuplicate)
+					extIntPacketDuplicate();
+				else if ((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == BULK_CTRL_MARK)
+					// the fragment is kept, the message is published when complete
+					extIntBulkReceived();
+				else
+					// publish the packet and call the PacketReceived callback
+					extIntPacketReceived();
 			#ifdef ANTENNA_DIVERSITY_ENABLED
 				#ifndef B1_ONLY
 				//if revision V2 or A0 chip is used
@@ -953,6 +934,11 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 				extIntSpiWriteReg(SI4432_HEADER_CONTROL_2, (temp8 | 0x01));
 				extIntSpiWriteReg(SI4432_PREAMBLE_LENGTH, PreamRegValue);
 				#endif
+			#endif
+			#ifdef TRANSCEIVER_OPERATION
+				// the next packets of the peer come at the granted data rate
+				if ((EZMacProReg.name.LACR & LACR_RATE) && ((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == 0x04) && (LinkEntry < LINK_TABLE_SIZE))
+					extIntSetLinkRate(LinkTable[LinkEntry].rate);
 			#endif
 				// all done use SECR to determine next state
 				extIntGotoNextStateUsingSECR(0);
@@ -1021,8 +1007,11 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 				//select the next channel
 				SelectedChannel = 0;
 				extIntSpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0+SelectedChannel]);
+		#ifdef FAST_SCAN_ENABLED
+				FastScanDwell = 0;
+		#endif
 				// start timer with channel search timeout
-				extIntTimeout(TimeoutChannelSearch);
+				extIntTimeout(SEARCH_TIMEOUT);
 				ENABLE_MAC_TIMER_INTERRUPT();
 		#endif
 				//go to the next state
@@ -1056,6 +1045,280 @@ void	extIntRX_StateMachine(U8 msr, U8 intStatus1, U8 intStatus2)
 }
 #endif // TRANSMITTER_ONLY_OPERATION
 
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	externalIntDeferredISR()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Deferred part of the external interrupt. The external interrupt prepares the radio, sets one of
+// the RX_STATE_DEFERRED_xxx states and triggers this interrupt. On the STM32 it is the PendSV
+// exception at the lowest priority, so the UART and the other interrupts are not blocked while
+// the application callbacks run and the FIFO is written. The 8051 has no free software interrupt,
+// it is called at the end of the external interrupt there.
+//
+// The MAC interrupts are disabled while it runs, the SPI is not shared with them. The API
+// functions can not run between the external interrupt and this one, the PendSV is taken before
+// returning to the thread mode.
+//
+//------------------------------------------------------------------------------------------------
+void externalIntDeferredISR(void)
+{
+	U32 start = CYCLE_COUNTER();
+#ifdef EXTENDED_PACKET_FORMAT
+	// the forwarding needs the extended packet format as well
+	U8 msr = EZMacProReg.name.MSR;
+#endif
+
+#ifdef EXTENDED_PACKET_FORMAT
+	if (msr == (RX_STATE_BIT | RX_STATE_DEFERRED_ACK))
+	{
+		DISABLE_MAC_INTERRUPTS();
+		extIntDeferredAck();
+	}
+	if (msr == (TX_STATE_BIT | TX_STATE_DEFERRED_BULK))
+	{
+		DISABLE_MAC_INTERRUPTS();
+		extIntDeferredBulk();
+	}
+#endif
+#ifdef PACKET_FORWARDING_SUPPORTED
+	if (msr == (RX_STATE_BIT | RX_STATE_DEFERRED_FORWARDING))
+	{
+		DISABLE_MAC_INTERRUPTS();
+		extIntDeferredForwarding();
+	}
+#endif
+
+	start = CYCLE_COUNTER() - start;
+	if (start > ExtIntDeferredMaxCycles)
+		ExtIntDeferredMaxCycles = start;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntDeferredAck()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Calls the ACK sending callback, fills the TX FIFO with the ACK payload and starts the ACK
+// transmission. The headers and the packet length are already set by the external interrupt.
+// The block ACK of a bulk transfer carries the bitmap of the received frames, the callback is not
+// called for it. Another sender (its frames are refused while a message is being reassembled)
+// gets an empty bitmap, so it sends the frames again.
+//
+// This function is included only in the Extended packet format configuration.
+//
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+void extIntDeferredAck(void)
+{
+	U8 temp8;
+	U8 rssi;
+	U16 map;
+
+	// the RSSI of the packet is the last byte of the ACK payload
+	rssi = (EZMacProReg.name.LACR & LACR_POWER) ? 1 : 0;
+
+	//the block ACK of a bulk transfer holds the bitmap of the received frames of the window
+	if ((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == BULK_CTRL_MARK)
+	{
+		map = (EZMacProReg.name.RSID == BulkRxSid) ? BulkRxMap : 0;
+		if (EZMacProReg.name.MCR & 0x04)
+			extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH, 2);
+		extIntSpiWriteReg(SI4432_FIFO_ACCESS, (U8)map);
+		extIntSpiWriteReg(SI4432_FIFO_ACCESS, (U8)(map >> 8));
+		if ((EZMacProReg.name.MCR & 0x04) == 0)
+			for (temp8 = 2; temp8 < EZMacProReg.name.PLEN; temp8++)
+				extIntSpiWriteReg(SI4432_FIFO_ACCESS,0x00);
+	}
+	//if dynamic payload length mode is set
+	else if (EZMacProReg.name.MCR & 0x04)
+	{
+		//clear ACK frame
+		extIntAckFrameAlloc(AckBufSize);
+
+		//callback to customise Ack Packet payload
+		EZMacPRO_AckSending();
+
+		//Fill FIFO from ACK frame
+		extIntAckFrameWriteFIFO(AckBufSize);
+		if (rssi)
+		{
+			extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH, AckBufSize + 1);
+			extIntSpiWriteReg(SI4432_FIFO_ACCESS, EZMacProRSSIvalue);
+		}
+	}
+	//if fix packet length is greater than ack buffer size
+	else if (EZMacProReg.name.PLEN > ACK_BUFFER_SIZE)
+	{
+		//Clear ACK frame
+		extIntAckFrameAlloc(ACK_BUFFER_SIZE);
+
+		//Callback to customise Ack Packet payload
+		EZMacPRO_AckSending();
+
+		//Fill FIFO from ACK frame
+		extIntAckFrameWriteFIFO(ACK_BUFFER_SIZE);
+		for (temp8 = ACK_BUFFER_SIZE; temp8 < EZMacProReg.name.PLEN - rssi; temp8++)
+			extIntSpiWriteReg(SI4432_FIFO_ACCESS,0x00);
+		if (rssi)
+			extIntSpiWriteReg(SI4432_FIFO_ACCESS, EZMacProRSSIvalue);
+	}
+	else//if fix packet length is smaller or equal than ack buffer size
+	{
+		//Clear ACK frame
+		extIntAckFrameAlloc(EZMacProReg.name.PLEN);
+
+		//Callback to customise Ack Packet payload
+		EZMacPRO_AckSending();
+
+		//Fill FIFO from ACK frame
+		extIntAckFrameWriteFIFO(EZMacProReg.name.PLEN - rssi);
+		if (rssi)
+			extIntSpiWriteReg(SI4432_FIFO_ACCESS, EZMacProRSSIvalue);
+	}
+
+	// enable ENPKSENT bit
+	extIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+
+	// go to the next state
+	EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_WAIT_FOR_SEND_ACK;
+
+	// start timer with transmit packet timeout
+	extIntTimeout(TimeoutTX_Packet);
+	ENABLE_MAC_INTERRUPTS();
+	// enable transmit
+	extIntSetFunction1(SI4432_TXON | SI4432_XTON);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntDeferredBulk()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Loads the next frame of the bulk transfer to the TX FIFO. The transmission is started by the
+// timer interrupt after BULK_FRAME_GAP, the receiver has to get back to RX after the previous
+// frame (or after sending the block ACK).
+//
+// This function is included only in the Extended packet format configuration.
+//
+//------------------------------------------------------------------------------------------------
+void extIntDeferredBulk(void)
+{
+	#ifndef B1_ONLY
+	if (EZMacProReg.name.DTR == 0) //if rev V2 chip is used
+		//set the TX deviation(only V2)
+		extIntSpiWriteReg (SI4432_FREQUENCY_DEVIATION, TX_Freq_dev);
+	#endif
+	extIntBulkLoad();
+
+	// go to the next state
+	EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_BULK_GAP;
+	// start timer with the gap between the frames
+	extIntTimeout(BULK_FRAME_GAP);
+	ENABLE_MAC_TIMER_INTERRUPT();
+}
+#endif //EXTENDED_PACKET_FORMAT
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntDeferredForwarding()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Calls the packet forwarding callback, writes the received packet back to the TX FIFO with the
+// decremented radius and starts the LBT or the transmission.
+//
+// This function is included only if packet forwarding is supported.
+//
+//------------------------------------------------------------------------------------------------
+#ifdef PACKET_FORWARDING_SUPPORTED
+void extIntDeferredForwarding(void)
+{
+	U8 temp8;
+
+	// call the forward packet callback function
+	EZMacPRO_PacketForwarding();
+	// decrement radius
+	// already checked for non-zero radius
+	temp8 = EZMacProReg.name.RCTRL;
+	temp8--;
+	// write modified RX Header back to TX
+	// The transmit registers are volatile and need to be restored by transmit function
+	// Only Extended packet format supports forwarding
+	// Set the packet headers
+	if (EZMacProReg.name.MCR & 0x80)
+	{	// if CID is used
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_0, EZMacProReg.name.DID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.RSID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.RCID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8);
+	}
+	else
+	{
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.DID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.RSID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, temp8);
+	}
+
+	// write the transmit packet length back
+	extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH, EZMacProReg.name.PLEN);
+	// write RX packet back to FIFO
+	extIntSpiWriteFIFO (EZMacProReg.name.PLEN, FRAME_POOL_BUFFER(RxFrame));
+
+	// publish the packet and call the PacketReceived callback
+	extIntPacketReceived();
+
+	if (EZMacProReg.name.TCR & 0x08)
+	{	// LBT enabled
+		// Set Listen Before Talk Limit to RSSI threshold register
+		extIntSpiWriteReg(SI4432_RSSI_THRESHOLD, EZMacProReg.name.LBTLR);
+
+		// disable all Si443x interrupt enable 1 sources
+		extIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, 0x00);
+		// enable RSSI interrupt
+		extIntSetEnable2(SI4432_ENRSSI);
+
+		EZMacProLBT_Retrys = 0;
+		BusyLBT = 0;
+		//go to the next state
+		EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_FORWARDING_LBT_START_LISTEN;
+		//wait for the fix 0.5ms
+		//start timer with fix ETSI LBT timeout
+		extIntTimeout(TIMEOUT_LBTI_ETSI);
+
+		//start receiver
+		extIntSetFunction1(SI4432_RXON|SI4432_XTON);
+	}
+	else
+	{
+		// enable ENPKSENT bit
+		extIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+		// enable TX
+		extIntSetFunction1(SI4432_TXON|SI4432_XTON);
+		// start timer with transmit packet timeout
+		extIntTimeout(TimeoutTX_Packet);
+		// go to the next state
+		EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_FORWARDING_WAIT_FOR_TX;
+	}
+	ENABLE_MAC_INTERRUPTS();
+}
+#endif //PACKET_FORWARDING_SUPPORTED
+
 //------------------------------------------------------------------------------------------------
 // Function Name
 //	extIntDisableInterrupts()
@@ -1093,6 +1356,9 @@ void extIntNextRX_Channel (void)
 {
 	U8	mask;
 	U8	n;
+#ifdef CHANNEL_QUALITY_ENABLED
+	U8	tries = 0;
+#endif
 
 	n = EZMacProCurrentChannel;
 
@@ -1108,7 +1374,12 @@ void extIntNextRX_Channel (void)
 		if (mask == 0x80) mask = 0x08;	// wrap mask to bits 3-6
 
 		// continue until unmasked bit is found
+#ifndef CHANNEL_QUALITY_ENABLED
 	} while ((EZMacProReg.name.RCR & mask) == mask);
+#else
+		// and skip the blacklisted channels, the fourth one is taken anyway
+	} while (((EZMacProReg.name.RCR & mask) == mask) || ((++tries < 4) && extIntChannelSkip(n)));
+#endif
 
 	extIntSpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0+n]);
 	EZMacProCurrentChannel = n;
@@ -1197,8 +1468,11 @@ void extIntGotoNextStateUsingSECR(U8 tx)
 		//select the nex channel
 		SelectedChannel = 0;
 		extIntSpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0+SelectedChannel]);
+		#ifdef FAST_SCAN_ENABLED
+		FastScanDwell = 0;
+		#endif
 		// start timer with channel search timeout
-		extIntTimeout(TimeoutChannelSearch);
+		extIntTimeout(SEARCH_TIMEOUT);
 		ENABLE_MAC_TIMER_INTERRUPT();
 	#endif
 		//go to the next state
@@ -1272,6 +1546,82 @@ void extIntIncrementError (U8 m)
 }
 	#endif
 #endif
+
+#ifdef CHANNEL_QUALITY_ENABLED
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntChannelPenalty()
+//
+// Return Value : None
+// Parameters	: U8 ch - index of the frequency register, U8 penalty - score to add
+//
+// Notes:
+//
+// A channel reaching CHANNEL_BLACKLIST is skipped CHANNEL_PROBE_SKIPS times by the search
+// before it is searched again (probed).
+//
+//------------------------------------------------------------------------------------------------
+void extIntChannelPenalty(U8 ch, U8 penalty)
+{
+	if ((U16)ChannelQuality[ch].score + penalty >= CHANNEL_BLACKLIST)
+		ChannelQuality[ch].score = CHANNEL_BLACKLIST + CHANNEL_PROBE_SKIPS - 1;
+	else
+		ChannelQuality[ch].score += penalty;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntChannelSkip()
+//
+// Return Value : U8 - 1 if the search skips the channel
+// Parameters	: U8 ch - index of the frequency register
+//
+// Notes:
+//
+// Every skip lowers the score of a blacklisted channel, it is probed when the score is below
+// CHANNEL_BLACKLIST again.
+//
+//------------------------------------------------------------------------------------------------
+U8 extIntChannelSkip(U8 ch)
+{
+	if (ChannelQuality[ch].score < CHANNEL_BLACKLIST)
+		return 0;
+	ChannelQuality[ch].score--;
+	return 1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntChannelResult()
+//
+// Return Value : None
+// Parameters	: U8 crcError - the packet has CRC error
+//
+// Notes:
+//
+// Called when a packet is received on the channel of RFSR. A CRC error adds CHANNEL_CRC_PENALTY to
+// the score, a valid packet halves it.
+//
+//------------------------------------------------------------------------------------------------
+void extIntChannelResult(U8 crcError)
+{
+	U8 ch;
+
+	ch = EZMacProReg.name.RFSR;
+	if (crcError)
+	{
+		if (ChannelQuality[ch].crc < 255)
+			ChannelQuality[ch].crc++;
+		extIntChannelPenalty(ch, CHANNEL_CRC_PENALTY);
+	}
+	else
+	{
+		if (ChannelQuality[ch].ok < 255)
+			ChannelQuality[ch].ok++;
+		ChannelQuality[ch].score /= 2;
+	}
+}
+#endif //CHANNEL_QUALITY_ENABLED
 //------------------------------------------------------------------------------------------------
 // Function Name
 //
@@ -1299,8 +1649,6 @@ void extIntIncrementError (U8 m)
 #ifdef PACKET_FORWARDING_SUPPORTED
 U8 extIntPacketNeedsForwarding (void)
 {
-
-	static U8 nextFree = 0;
 	U8 i;
 	U8 seq;
 
@@ -1311,6 +1659,10 @@ U8 extIntPacketNeedsForwarding (void)
 		if ((EZMacProReg.name.RCTRL & 0x03) == 0)
 		 return 0;
 
+		// the bulk transfer frames have no radius
+		if ((EZMacProReg.name.RCTRL & BULK_CTRL_MARK) == BULK_CTRL_MARK)
+		 return 0;
+
 		seq = EZMacProReg.name.RCTRL >> 4;
 
 		// search table for sid
@@ -1333,14 +1685,14 @@ U8 extIntPacketNeedsForwarding (void)
 
 		// entry not found in table
 		// add to FIFO and forward
-		ForwardedPacketTable[nextFree].sid = EZMacProReg.name.RSID;
-		ForwardedPacketTable[nextFree].seq = seq;
-		ForwardedPacketTable[nextFree].chan = EZMacProCurrentChannel;
+		ForwardedPacketTable[ForwardedPacketNext].sid = EZMacProReg.name.RSID;
+		ForwardedPacketTable[ForwardedPacketNext].seq = seq;
+		ForwardedPacketTable[ForwardedPacketNext].chan = EZMacProCurrentChannel;
 
-		if (nextFree < (FORWARDED_PACKET_TABLE_SIZE - 1))
-		 nextFree++;
+		if (ForwardedPacketNext < (FORWARDED_PACKET_TABLE_SIZE - 1))
+		 ForwardedPacketNext++;
 		else
-		 nextFree = 0;
+		 ForwardedPacketNext = 0;
 
 		return 1;
 	}
@@ -1576,3 +1928,757 @@ U8 extIntBadAddrError(void)
 }
 #endif
 
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntRxMetaWrite()
+//
+// Return Value : None
+// Parameters	: meta - one copy of the receive metadata
+//
+//------------------------------------------------------------------------------------------------
+#ifndef TRANSMITTER_ONLY_OPERATION
+static void extIntRxMetaWrite(volatile EZMacProRxMeta * meta)
+{
+	meta->rsr = EZMacProReg.name.RSR;
+	meta->rfsr = EZMacProReg.name.RFSR;
+	meta->rssi = EZMacProReg.name.RSSI;
+	meta->rctrl = EZMacProReg.name.RCTRL;
+	meta->rcid = EZMacProReg.name.RCID;
+	meta->rsid = EZMacProReg.name.RSID;
+	meta->did = EZMacProReg.name.DID;
+	meta->plen = EZMacProReg.name.PLEN;
+	// the same for both copies
+	meta->count = (RxMetaSeq + 1) >> 1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntPacketReceived()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Saves the RSSI and the receive status into the MAC registers, publishes the metadata for
+// EZMacPRO_Rx_Snapshot() and calls the PacketReceived callback. The copy selected by the odd
+// counter is written first, the readers meanwhile take the other one, then the same is done
+// with the even counter.
+//
+// This function is not included for the Transmitter only configuration.
+//
+//------------------------------------------------------------------------------------------------
+void extIntPacketReceived(void)
+{
+	//save the RSSI value to RSSI Mac register
+	EZMacProReg.name.RSSI = EZMacProRSSIvalue;
+	//save the receive status to the RSR Mac register
+	EZMacProReg.name.RSR = EZMacProReceiveStatus;
+
+	RxMetaSeq++;
+	extIntRxMetaWrite(&RxMeta[0]);
+	RxMetaSeq++;
+	extIntRxMetaWrite(&RxMeta[1]);
+
+	EZMacPRO_PacketReceived(EZMacProRSSIvalue);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntDuplicateCheck()
+//
+// Return Value : U8 duplicate - (1 duplicate, 0 new packet)
+// Parameters	: None
+//
+// Notes:
+//
+// The duplicate cache keeps the sequence number (RCTRL bits 7:4) of the last packet of every
+// sender (RSID) to every destination (DID), the sender counts the sequence numbers per destination
+// (see macSequenceNext()). The packet is a duplicate if it has the same sequence number as the last
+// one and DUPLICATE_CACHE_AGE has not passed since that. The age is needed because a reset sender
+// starts the sequence numbers again. Without a free-running MAC timer (MAC_TIMER_NOW() is 0)
+// the entries do not age. A new sender or destination replaces the entries in turn.
+//
+// This function is included only in the Extended packet format configurations.
+//
+//------------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+U8 extIntDuplicateCheck(void)
+{
+	U8 i;
+	U8 seq;
+	U32 now;
+
+	seq = EZMacProReg.name.RCTRL >> 4;
+	now = MAC_TIMER_NOW();
+
+	for (i = 0; i < DUPLICATE_CACHE_SIZE; i++)
+	{
+		if (DuplicateCache[i].seq != 0xFF && DuplicateCache[i].sid == EZMacProReg.name.RSID &&
+			DuplicateCache[i].did == EZMacProReg.name.DID)
+		{
+			if (DuplicateCache[i].seq == seq && (now - DuplicateCache[i].stamp) < DUPLICATE_CACHE_AGE)
+				return 1;
+			DuplicateCache[i].seq = seq;
+			DuplicateCache[i].stamp = now;
+			return 0;
+		}
+	}
+
+	// the first packet of the sender to the destination
+	i = DuplicateCacheNext;
+	if (++DuplicateCacheNext >= DUPLICATE_CACHE_SIZE)
+		DuplicateCacheNext = 0;
+	DuplicateCache[i].sid = EZMacProReg.name.RSID;
+	DuplicateCache[i].did = EZMacProReg.name.DID;
+	DuplicateCache[i].seq = seq;
+	DuplicateCache[i].stamp = now;
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntBulkFrameCheck()
+//
+// Return Value : U8 duplicate - (1 duplicate, 0 new frame)
+// Parameters	: None
+//
+// Notes:
+//
+// The received frames of the bulk transfer window are kept in the BulkRxMap bitmap, it is sent
+// back in the block ACK. A frame from another sender, with the other window toggle or after
+// DUPLICATE_CACHE_AGE starts a new window. A frame already in the bitmap is a duplicate.
+//
+// The fragment is copied to its offset in BulkRxBuf. A fragment from another sender, with another
+// message number or length, or after BULK_REASSEMBLY_TIMEOUT starts a new message. A fragment which can
+// not be kept (wrong header, another sender while a message is being reassembled) is handled like
+// a duplicate, it is not set in the bitmap, so the sender sends it again.
+//
+// This function is included only in the Extended packet format configurations.
+//
+//------------------------------------------------------------------------------------------------
+U8 extIntBulkFrameCheck(void)
+{
+	U16 mask;
+	U16 offset;
+	U16 length;
+	U8 size;
+	U8 fresh;
+	U32 now;
+
+	now = MAC_TIMER_NOW();
+	fresh = ((BulkRxSid != EZMacProReg.name.RSID) || ((now - BulkRxStamp) >= BULK_REASSEMBLY_TIMEOUT)) ? 1 : 0;
+	// another sender has to wait for the end of the message
+	if ((BulkRxReceived != BulkRxLength) && (BulkRxSid != EZMacProReg.name.RSID) && ((now - BulkRxStamp) < BULK_REASSEMBLY_TIMEOUT))
+		return 1;
+
+	if (BulkRxSid != EZMacProReg.name.RSID ||
+		BulkRxToggle != (EZMacProReg.name.RCTRL & BULK_CTRL_TOGGLE) ||
+		(now - BulkRxStamp) >= DUPLICATE_CACHE_AGE)
+	{	// the first frame of a new window
+		BulkRxSid = EZMacProReg.name.RSID;
+		BulkRxToggle = EZMacProReg.name.RCTRL & BULK_CTRL_TOGGLE;
+		BulkRxMap = 0;
+	}
+
+	mask = (U16)1 << (EZMacProReg.name.RCTRL >> 4);
+	if (BulkRxMap & mask)
+		return 1;
+
+	// the fragment header
+	if (EZMacProReg.name.PLEN <= BULK_FRAGMENT_HEADER_SIZE)
+		return 1;
+	offset = FRAME_POOL_BUFFER(RxFrame)[1] | ((U16)FRAME_POOL_BUFFER(RxFrame)[2] << 8);
+	length = FRAME_POOL_BUFFER(RxFrame)[3] | ((U16)FRAME_POOL_BUFFER(RxFrame)[4] << 8);
+	if (length == 0 || length > BULK_MESSAGE_SIZE || offset >= length)
+		return 1;
+	// the padding of the static payload length mode is not the part of the message
+	size = EZMacProReg.name.PLEN - BULK_FRAGMENT_HEADER_SIZE;
+	if ((length - offset) < size)
+		size = (U8)(length - offset);
+
+	if (fresh || BulkRxMessage != FRAME_POOL_BUFFER(RxFrame)[0] || BulkRxLength != length)
+	{	// the first fragment of a new message
+		BulkRxMessage = FRAME_POOL_BUFFER(RxFrame)[0];
+		BulkRxLength = length;
+		BulkRxReceived = 0;
+	}
+	if ((BulkRxReceived + size) > BulkRxLength)
+		return 1;
+
+	for (length = 0; length < size; length++)
+		BulkRxBuf[offset + length] = FRAME_POOL_BUFFER(RxFrame)[BULK_FRAGMENT_HEADER_SIZE + length];
+	BulkRxReceived += size;
+	BulkRxStamp = now;
+	BulkRxMap |= mask;
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntBulkReceived()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Called after a new fragment of a bulk transfer. If the message is complete, it calls the
+// BulkReceived callback, the message can be read by EZMacPRO_Bulk_Read().
+//
+//------------------------------------------------------------------------------------------------
+void extIntBulkReceived(void)
+{
+	//save the RSSI value to RSSI Mac register
+	EZMacProReg.name.RSSI = EZMacProRSSIvalue;
+	//save the receive status to the RSR Mac register
+	EZMacProReg.name.RSR = EZMacProReceiveStatus;
+
+	if (BulkRxReceived == BulkRxLength)
+		EZMacPRO_BulkReceived();
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntPacketDuplicate()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Counts the duplicate packet in RxDuplicateCount and calls the PacketDiscarded callback
+// instead of the PacketReceived callback.
+//
+//------------------------------------------------------------------------------------------------
+void extIntPacketDuplicate(void)
+{
+	RxDuplicateCount++;
+	//save the receive status to the RSR Mac register
+	EZMacProReg.name.RSR = EZMacProReceiveStatus;
+	//call the packet discarded callback
+	EZMacPRO_PacketDiscarded();
+}
+#endif //EXTENDED_PACKET_FORMAT
+#endif
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntRxFrameAlloc()
+//
+// Return Value : U8 - handle of the frame for the received payload, FRAME_POOL_INVALID if none
+// Parameters	: None
+//
+// Notes:
+//
+// A new frame is taken from the pool for every received packet, and the frame of the previous
+// packet is released only after the allocation succeeded. If the pool is empty the packet is
+// dropped (counted by FramePoolAllocFail), the frame of the previous packet is not overwritten,
+// so a consumer still reading it sees it unchanged.
+//
+// This function is not included for the Transmitter only configuration.
+//
+//------------------------------------------------------------------------------------------------
+#ifndef TRANSMITTER_ONLY_OPERATION
+U8 extIntRxFrameAlloc(void)
+{
+	U8 frame;
+
+	frame = EZMacPRO_Frame_Alloc();
+	if (frame == FRAME_POOL_INVALID)
+		return FRAME_POOL_INVALID;
+
+	EZMacPRO_Frame_Free(RxFrame);
+	RxFrame = frame;
+	return RxFrame;
+}
+#endif //TRANSMITTER_ONLY_OPERATION not defined
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntAckFrameAlloc()
+//
+// Return Value : None
+// Parameters	: length - number of the payload bytes to be cleared
+//
+// Notes:
+//
+// Takes the frame for the ACK payload from the pool and clears it. The frame is held only while
+// the EZMacPRO_AckSending() callback is running, EZMacPRO_Ack_Write() writes into it.
+//
+// This function is included only in the Extended packet format Transceiver configuration.
+//
+//------------------------------------------------------------------------------------------------
+#ifdef TRANSCEIVER_OPERATION
+#ifdef EXTENDED_PACKET_FORMAT
+void extIntAckFrameAlloc(U8 length)
+{
+	U8 temp8;
+
+	AckFrame = EZMacPRO_Frame_Alloc();
+	if (AckFrame == FRAME_POOL_INVALID)
+		return;
+
+	for (temp8 = 0; temp8 < length; temp8++)
+		FRAME_POOL_BUFFER(AckFrame)[temp8] = 0x00;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntAckFrameWriteFIFO()
+//
+// Return Value : None
+// Parameters	: length - number of the payload bytes
+//
+// Notes:
+//
+// Writes the ACK payload to the TX FIFO and gives the ACK frame back to the pool. If there was
+// no free frame an all zero payload is sent, the ACK itself is never suppressed.
+//
+//------------------------------------------------------------------------------------------------
+void extIntAckFrameWriteFIFO(U8 length)
+{
+	U8 temp8;
+
+	if (AckFrame == FRAME_POOL_INVALID)
+	{
+		for (temp8 = 0; temp8 < length; temp8++)
+			extIntSpiWriteReg(SI4432_FIFO_ACCESS, 0x00);
+		return;
+	}
+
+	for (temp8 = 0; temp8 < length; temp8++)
+		extIntSpiWriteReg(SI4432_FIFO_ACCESS, FRAME_POOL_BUFFER(AckFrame)[temp8]);
+	EZMacPRO_Frame_Free(AckFrame);
+	AckFrame = FRAME_POOL_INVALID;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntAckWaitTime()
+//
+// Return Value : U32 ACK timeout in MAC timer ticks
+// Parameters	: None
+//
+// Notes:
+//
+// Called at the end of the transmission when the ACK is requested. It selects the round-trip
+// time entry of the destination and stamps the end of the transmission. The timeout is the
+// smoothed round-trip time plus four times its mean deviation, limited between TimeoutACKMin
+// and the fixed TimeoutACK. A peer without measurement gets the fixed timeout.
+//
+//------------------------------------------------------------------------------------------------
+U32 extIntAckWaitTime(void)
+{
+	U32 timeout;
+
+	AckRttStamp = MAC_TIMER_NOW();
+	for (AckRttEntry = 0; AckRttEntry < ACK_RTT_TABLE_SIZE; AckRttEntry++)
+	{
+		if (AckRttTable[AckRttEntry].srtt != 0 && AckRttTable[AckRttEntry].did == AckRttDid)
+		{
+			timeout = AckRttTable[AckRttEntry].srtt + 4 * AckRttTable[AckRttEntry].rttvar;
+			if (timeout < TimeoutACKMin)
+				return TimeoutACKMin;
+			if (timeout < TimeoutACK)
+				return timeout;
+			return TimeoutACK;
+		}
+	}
+	return TimeoutACK;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntAckRttSample()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Called when the ACK is received. The time from the end of the transmission updates the
+// estimate of the peer like the TCP retransmission timer (RFC 6298):
+//		rttvar = 3/4 rttvar + 1/4 |srtt - rtt|
+//		srtt   = 7/8 srtt   + 1/8 rtt
+// The first sample sets srtt = rtt and rttvar = rtt / 2, a new peer replaces the entries in
+// turn. The ACK of a retransmitted packet is not used because it can belong to any of the
+// transmissions. A zero sample means that the port has no free-running MAC timer.
+//
+//------------------------------------------------------------------------------------------------
+void extIntAckRttSample(void)
+{
+	U32 rtt;
+	U32 delta;
+
+	rtt = MAC_TIMER_NOW() - AckRttStamp;
+	if (rtt == 0 || EZMacProTxAttempts > 1)
+		return;
+
+	if (AckRttEntry >= ACK_RTT_TABLE_SIZE)
+	{	// the first sample of the peer
+		AckRttEntry = AckRttNext;
+		if (++AckRttNext >= ACK_RTT_TABLE_SIZE)
+			AckRttNext = 0;
+		AckRttTable[AckRttEntry].did = AckRttDid;
+		AckRttTable[AckRttEntry].srtt = rtt;
+		AckRttTable[AckRttEntry].rttvar = rtt / 2;
+		return;
+	}
+
+	if (rtt > AckRttTable[AckRttEntry].srtt)
+		delta = rtt - AckRttTable[AckRttEntry].srtt;
+	else
+		delta = AckRttTable[AckRttEntry].srtt - rtt;
+	AckRttTable[AckRttEntry].rttvar = AckRttTable[AckRttEntry].rttvar - AckRttTable[AckRttEntry].rttvar / 4 + delta / 4;
+	AckRttTable[AckRttEntry].srtt = AckRttTable[AckRttEntry].srtt - AckRttTable[AckRttEntry].srtt / 8 + rtt / 8;
+	if (AckRttTable[AckRttEntry].srtt == 0)
+		AckRttTable[AckRttEntry].srtt = 1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntBulkAck()
+//
+// Return Value : None
+// Parameters	: U16 map - bitmap of the received frames of the window from the block ACK
+//
+// Notes:
+//
+// The acknowledged frames are removed from the window. If the window is complete the next one
+// is started, and the transfer is finished after the last window. If frames are missing they are
+// sent again in the next round, until the RTCR retransmissions are used up. The next frame is
+// loaded by the deferred part.
+//
+//------------------------------------------------------------------------------------------------
+void extIntBulkAck(U16 map)
+{
+	U8 size;
+	U8 temp8;
+	U16 frames;
+
+	BulkTxPending &= ~map;
+	if (BulkTxPending == 0)
+	{	// the window is complete
+		BulkTxBase += BulkTxCount;
+		size = ((EZMacProReg.name.MCR & 0x04) ? EZMacProReg.name.MPL : EZMacProReg.name.PLEN) - BULK_FRAGMENT_HEADER_SIZE;
+		frames = (BulkTxLength + size - 1) / size;
+		if (BulkTxBase >= frames)
+		{	// the transfer is complete
+			BulkTxLength = 0;
+			EZMacPRO_PacketSent(EZMacProTxAttempts);
+			extIntGotoNextStateUsingSECR(1);
+			return;
+		}
+		// the next window, the toggle changes with every window
+		frames -= BulkTxBase;
+		BulkTxCount = (frames < BULK_WINDOW_SIZE) ? (U8)frames : BULK_WINDOW_SIZE;
+		BulkTxPending = (U16)(((U32)1 << BulkTxCount) - 1);
+		BulkTxToggle ^= BULK_CTRL_TOGGLE;
+		EZMacProTxAttempts = 1;
+	}
+	else if (EZMacProTxAttempts <= (EZMacProReg.name.RTCR & RTCR_RETRIES))
+	{	// send the missing frames again
+		EZMacProTxAttempts++;
+	}
+	else
+	{	// the retransmissions are used up
+		BulkTxLength = 0;
+		EZMacPRO_AckTimeout(EZMacProTxAttempts);
+		extIntGotoNextStateUsingSECR(1);
+		return;
+	}
+
+	BulkTxNext = 0;
+	// disable the receiver
+	extIntSetFunction1(SI4432_XTON);
+	// clear RX FIFO
+	temp8 = extIntSpiReadReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2);
+	temp8 |= SI4432_FFCLRRX;
+	extIntSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+	temp8 &= ~SI4432_FFCLRRX;
+	extIntSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+	// go to the next state, the deferred part loads the next frame
+	EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_DEFERRED_BULK;
+	TRIGGER_MAC_DEFERRED_INTERRUPT();
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntBulkLoad()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Writes the next unacknowledged frame of the bulk transfer window to the TX FIFO and sets the
+// headers, like macBulkLoad(). The last unacknowledged frame of the window requests the block ACK.
+//
+//------------------------------------------------------------------------------------------------
+void extIntBulkLoad(void)
+{
+	U8 index;
+	U8 ctrl;
+	U8 size;
+	U8 temp8;
+	U16 offset;
+
+	for (index = BulkTxNext; (BulkTxPending & ((U16)1 << index)) == 0; index++);
+
+	ctrl = (index << 4) | BULK_CTRL_MARK | BulkTxToggle;
+	if ((BulkTxPending >> index) == 1)
+	{	// no more frames in this round
+		ctrl |= BULK_CTRL_LAST;
+		BulkTxNext = BULK_WINDOW_SIZE;
+	}
+	else
+		BulkTxNext = index + 1;
+
+	size = ((EZMacProReg.name.MCR & 0x04) ? EZMacProReg.name.MPL : EZMacProReg.name.PLEN) - BULK_FRAGMENT_HEADER_SIZE;
+	offset = (BulkTxBase + index) * size;
+
+	// clear TX FIFO
+	temp8 = extIntSpiReadReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2);
+	temp8 |= SI4432_FFCLRTX;
+	extIntSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+	temp8 &= ~SI4432_FFCLRTX;
+	extIntSpiWriteReg (SI4432_OPERATING_AND_FUNCTION_CONTROL_2, temp8);
+
+	// set the transmit headers
+	if (EZMacProReg.name.MCR & 0x80)
+	{	// if CID is used
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, ctrl);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SCID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.SFID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_0, EZMacProReg.name.DID);
+	}
+	else
+	{	// if CID is not used
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_3, ctrl);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_2, EZMacProReg.name.SFID);
+		extIntSpiWriteReg(SI4432_TRANSMIT_HEADER_1, EZMacProReg.name.DID);
+	}
+
+	// the last fragment of the message can be shorter
+	temp8 = ((BulkTxLength - offset) < size) ? (U8)(BulkTxLength - offset) : size;
+	if (EZMacProReg.name.MCR & 0x04)
+		// if dynamic payload length mode is set
+		extIntSpiWriteReg(SI4432_TRANSMIT_PACKET_LENGTH, temp8 + BULK_FRAGMENT_HEADER_SIZE);
+	// the fragment header
+	extIntSpiWriteReg(SI4432_FIFO_ACCESS, BulkTxMessage);
+	extIntSpiWriteReg(SI4432_FIFO_ACCESS, (U8)offset);
+	extIntSpiWriteReg(SI4432_FIFO_ACCESS, (U8)(offset >> 8));
+	extIntSpiWriteReg(SI4432_FIFO_ACCESS, (U8)BulkTxLength);
+	extIntSpiWriteReg(SI4432_FIFO_ACCESS, (U8)(BulkTxLength >> 8));
+	extIntSpiWriteFIFO(temp8, BulkTxBuf + offset);
+	if ((EZMacProReg.name.MCR & 0x04) == 0)
+	{	// if static payload length mode is set, fill the remain payload bytes with zero
+		for (; temp8 < size; temp8++)
+			extIntSpiWriteReg(SI4432_FIFO_ACCESS, 0x00);
+	}
+	BulkTxFrames++;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntSetLinkRate()
+//
+// Return Value : None
+// Parameters	: U8 rate - data rate (MCR bits 6:5 format)
+//
+// Notes:
+//
+// Switches the modem to the data rate of a link, like macSetLinkRate().
+//
+//------------------------------------------------------------------------------------------------
+void extIntSetLinkRate (U8 rate)
+{
+	U8 i;
+	U8 preamble;
+	U16 delta;
+
+	if (rate == LinkRate)
+		return;
+
+	delta = LinkRateDelta[LinkRate][rate];
+	for (i = 0; i < NUMBER_OF_PARAMETER_B1; i++)
+		if (delta & ((U16)1 << i))
+			extIntSpiWriteReg(LinkRateReg[i], RfSettingsB1[rate][i]);
+	extIntSpiWriteReg(SI4432_PREAMBLE_DETECTION_CONTROL, (Parameters[rate][PREAMBLE_DETECTION_THRESHOLD]<<3)|0x02);
+#ifdef FOUR_CHANNEL_IS_USED
+	preamble = Parameters[rate][PREAMBLE_IF_ONE_CHANNEL + (EZMacProReg.name.MCR & 0x03)];
+	extIntSpiWriteReg(SI4432_PREAMBLE_LENGTH, preamble<<1);
+	TimeoutChannelSearch = EZMacProByteTime[rate] * Parameters[rate][SEARCH_TIME];
+#endif
+#ifdef MORE_CHANNEL_IS_USED
+	preamble = Parameters[rate][PREAMBLE_LENGTH];
+	extIntSpiWriteReg(SI4432_PLL_TUNE_TIME, Parameters[rate][PLL_TUNE_TIME_REG_VALUE]);
+	extIntSpiWriteReg(SI4432_PREAMBLE_LENGTH, Parameters[rate][PREAMBLE_LENGTH_REG_VALUE2]);
+	TimeoutChannelSearch = (EZMacProByteTime[rate]/8) * Parameters[rate][SEARCH_TIME];
+	#ifdef FAST_SCAN_ENABLED
+	TimeoutFastScan = FAST_SCAN_TIMEOUT(EZMacProByteTime[rate]);
+	#endif
+#endif
+	TimeoutSyncWord = (preamble + 2) * (U32)EZMacProByteTime[rate];
+	LinkRate = rate;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntLinkEntry()
+//
+// Return Value : U8 - index of the entry in LinkTable
+// Parameters	: U8 did - ID of the peer
+//
+// Notes:
+//
+// Returns the link entry of a peer, like macLinkEntry().
+//
+//------------------------------------------------------------------------------------------------
+U8 extIntLinkEntry(U8 did)
+{
+	U8 i;
+
+	for (i = 0; i < LINK_TABLE_SIZE; i++)
+		if (LinkTable[i].rate != 0xFF && LinkTable[i].did == did)
+			return i;
+
+	i = LinkNext;
+	if (++LinkNext >= LINK_TABLE_SIZE)
+		LinkNext = 0;
+	LinkTable[i].did = did;
+	LinkTable[i].rate = (EZMacProReg.name.MCR >> 5) & 0x03;
+	LinkTable[i].rssi = 0;
+	LinkTable[i].acks = 0;
+	LinkTable[i].fails = 0;
+	// the modems of the peers are not switched yet
+	LinkTable[i].stamp = MAC_TIMER_NOW() - LINK_RATE_HOLD;
+	return i;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntLinkGrant()
+//
+// Return Value : U8 - the granted data rate
+// Parameters	: None
+//
+// Notes:
+//
+// Called when the ACK of a packet is built. The RSSI of the packet is smoothed in the entry of
+// the sender (3/4 old + 1/4 new), the requested data rate is granted if the RSSI
+// is at least LinkRateRssi[] of it, else the fastest data rate above the base data rate that
+// meets it. The modem is switched to the granted data rate after the ACK is sent.
+//
+//------------------------------------------------------------------------------------------------
+U8 extIntLinkGrant(void)
+{
+	U8 entry;
+	U8 base;
+	U8 rate;
+
+	entry = extIntLinkEntry(EZMacProReg.name.RSID);
+	if (LinkTable[entry].rssi == 0)
+		LinkTable[entry].rssi = EZMacProRSSIvalue;
+	else
+		LinkTable[entry].rssi = LinkTable[entry].rssi - LinkTable[entry].rssi / 4 + EZMacProRSSIvalue / 4;
+
+	base = (EZMacProReg.name.MCR >> 5) & 0x03;
+	rate = EZMacProReg.name.RCTRL & 0x03;
+	if (rate < base)
+		rate = base;
+	while ((rate > base) && (LinkTable[entry].rssi < LinkRateRssi[rate]))
+		rate--;
+
+	LinkTable[entry].rate = rate;
+	LinkTable[entry].stamp = MAC_TIMER_NOW();
+	LinkEntry = entry;
+	return rate;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntLinkAck()
+//
+// Return Value : None
+// Parameters	: U8 ctrl - control byte of the received ACK
+//
+// Notes:
+//
+// Called when the ACK of a first transmission or a retransmission is received. The link takes
+// the data rate granted by the peer, the acknowledged packets are counted again after a change.
+//
+//------------------------------------------------------------------------------------------------
+void extIntLinkAck(U8 ctrl)
+{
+	U8 rate;
+
+	if (LinkEntry >= LINK_TABLE_SIZE)
+		return;
+
+	rate = ctrl & 0x03;
+	if (rate < ((EZMacProReg.name.MCR >> 5) & 0x03))
+		rate = (EZMacProReg.name.MCR >> 5) & 0x03;
+	if (rate != LinkTable[LinkEntry].rate)
+	{
+		LinkTable[LinkEntry].rate = rate;
+		LinkTable[LinkEntry].acks = 0;
+	}
+	else if (LinkTable[LinkEntry].acks < 255)
+		LinkTable[LinkEntry].acks++;
+	LinkTable[LinkEntry].fails = 0;
+	LinkTable[LinkEntry].stamp = MAC_TIMER_NOW();
+	extIntSetLinkRate(rate);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	extIntLinkPower()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Called when the ACK is received, the last byte of its payload is the RSSI of the packet at the
+// peer. It is removed from the payload in dynamic payload length mode. The TX power of the link
+// is raised at once to reach LinkPowerRssi[] of the data rate of the link, and it is lowered by
+// one step if the RSSI stays LINK_POWER_HYSTERESIS_DB above it after the step. The new TX power
+// is set by the next transmission.
+//
+//------------------------------------------------------------------------------------------------
+void extIntLinkPower(void)
+{
+	U8 power;
+	U8 max;
+	S16 margin;
+
+	if ((RxFrame == FRAME_POOL_INVALID) || (EZMacProReg.name.PLEN == 0))
+		return;
+	// the margin in dB, the RSSI register has 0.5 dB steps
+	margin = (S16)FRAME_POOL_BUFFER(RxFrame)[EZMacProReg.name.PLEN - 1];
+	if (EZMacProReg.name.MCR & 0x04)
+		EZMacProReg.name.PLEN--;
+	if (LinkEntry >= LINK_TABLE_SIZE)
+		return;
+	margin = (margin - LinkPowerRssi[LinkTable[LinkEntry].rate]) / 2;
+
+	max = (EZMacProReg.name.TCR >> 4) & 0x07;
+	power = LinkTable[LinkEntry].power;
+	if (power > max)
+		power = max;
+	if (margin < 0)
+	{
+		while ((power < max) && (margin < 0))
+		{
+			margin += LinkPowerDbm[power + 1] - LinkPowerDbm[power];
+			power++;
+		}
+	}
+	else if ((power > 0) && (margin >= LinkPowerDbm[power] - LinkPowerDbm[power - 1] + LINK_POWER_HYSTERESIS_DB))
+		power--;
+	LinkTable[LinkEntry].power = power;
+}
+#endif //EXTENDED_PACKET_FORMAT
+#endif //TRANSCEIVER_OPERATION
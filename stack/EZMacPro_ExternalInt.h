@@ -23,12 +23,21 @@
                  *     G L O B A L   V A R I A B L E S     *
                  * ======================================= */
 
+extern volatile SEGMENT_VARIABLE(ExtIntMaxCycles, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(ExtIntDeferredMaxCycles, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+
                 /* ======================================= *
                  *  F U N C T I O N   P R O T O T Y P E S  *
                  * ======================================= */
 
 void extIntDisableInterrupts (void);
 void extIntNextRX_Channel (void);
+#ifdef CHANNEL_QUALITY_ENABLED
+void extIntChannelPenalty (U8, U8);
+U8 extIntChannelSkip (U8);
+void extIntChannelResult (U8);
+#endif
 #ifdef FOUR_CHANNEL_IS_USED
 void extIntIncrementError (U8 );
 #endif//FOUR_CHANNEL_IS_USED
@@ -45,6 +54,27 @@ void extIntSetEnable2 (U8);
 void extIntSetFunction1 (U8);
 U8 extIntHeaderError(void);
 U8 extIntBadAddrError(void);
+U8 extIntRxFrameAlloc(void);
+void extIntPacketReceived(void);
+U8 extIntDuplicateCheck(void);
+U8 extIntBulkFrameCheck(void);
+void extIntBulkReceived(void);
+void extIntPacketDuplicate(void);
+void extIntAckFrameAlloc(U8 length);
+void extIntAckFrameWriteFIFO(U8 length);
+U32 extIntAckWaitTime(void);
+void extIntAckRttSample(void);
+void extIntBulkAck(U16 map);
+void extIntBulkLoad(void);
+void extIntSetLinkRate(U8 rate);
+U8 extIntLinkEntry(U8 did);
+U8 extIntLinkGrant(void);
+void extIntLinkAck(U8 ctrl);
+void extIntLinkPower(void);
+void externalIntDeferredISR(void);
+void extIntDeferredAck(void);
+void extIntDeferredBulk(void);
+void extIntDeferredForwarding(void);
 
 
 
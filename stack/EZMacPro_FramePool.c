@@ -0,0 +1,236 @@
+/*!\file EZMacPro_FramePool.c
+ * \brief Fixed-size frame pool shared by the RX, TX and forwarding paths.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+/* ======================================= *
+ *				I N C L U D E				*
+ * ======================================= */
+
+#include "stack.h"
+
+#ifdef STM32_MODULE
+	// the CM3 CoreSupport header of the STM32F10x library has no __CLZ()
+	#ifndef __CLZ
+		#ifdef __CC_ARM
+			#define __CLZ(x)	__clz(x)
+		#else
+			#define __CLZ(x)	__builtin_clz(x)
+		#endif
+	#endif
+#else
+	// the pool can be called with the interrupts already disabled (MAC interrupts, critical
+	// sections of the caller), EA is restored instead of being enabled
+	#define FRAME_POOL_ENTER(save)	do { (save) = EA; EA = 0; } while (0)
+	#define FRAME_POOL_EXIT(save)	EA = (save)
+#endif
+
+/* ======================================= *
+ *	 G L O B A L	V A R I A B L E S	 *
+ * ======================================= */
+
+SEGMENT_VARIABLE(FramePool[FRAME_POOL_SIZE][FRAME_POOL_FRAME_SIZE], U8, BUFFER_MSPACE);
+
+// one bit per frame, set if the frame is free
+volatile SEGMENT_VARIABLE(FramePoolFreeMap, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+// statistics
+volatile SEGMENT_VARIABLE(FramePoolInUse, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(FramePoolHighWater, U32, EZMAC_PRO_GLOBAL_MSPACE);
+volatile SEGMENT_VARIABLE(FramePoolAllocFail, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+/* ======================================= *
+ *		L O C A L	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	framePoolAdd()
+//
+// Return Value : U32 - the new value
+// Parameters	: p - pointer to the counter
+//				  delta - value to add
+//
+// Notes:
+//
+// Atomic read-modify-write of a pool counter. The Cortex-M3 exclusive monitor is used, so the
+// update is never lost if it is preempted by the external or timer interrupt and the interrupts
+// are never disabled. The 8051 has no exclusive access, a short critical section is used there.
+//
+//------------------------------------------------------------------------------------------------
+static U32 framePoolAdd(volatile U32 * p, S32 delta)
+{
+	U32 value;
+#ifndef STM32_MODULE
+	U8 ea;
+#endif
+#ifdef STM32_MODULE
+	do
+	{
+		value = __LDREXW((U32 *)p) + delta;
+	} while (__STREXW(value, (U32 *)p));
+#else
+	FRAME_POOL_ENTER(ea);
+	value = *p + delta;
+	*p = value;
+	FRAME_POOL_EXIT(ea);
+#endif
+	return value;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	framePoolUpdateHighWater()
+//
+// Return Value : None
+// Parameters	: inUse - number of the allocated frames
+//
+// Notes:
+//
+// The high water mark is only written if it has to be raised, so an allocation in a higher
+// priority context can not be overwritten with a smaller value.
+//
+//------------------------------------------------------------------------------------------------
+static void framePoolUpdateHighWater(U32 inUse)
+{
+#ifndef STM32_MODULE
+	U8 ea;
+#endif
+
+#ifdef STM32_MODULE
+	do
+	{
+		if (inUse <= __LDREXW((U32 *)&FramePoolHighWater))
+		{
+			__CLREX();
+			return;
+		}
+	} while (__STREXW(inUse, (U32 *)&FramePoolHighWater));
+#else
+	FRAME_POOL_ENTER(ea);
+	if (inUse > FramePoolHighWater)
+		FramePoolHighWater = inUse;
+	FRAME_POOL_EXIT(ea);
+#endif
+}
+
+/* ======================================= *
+ *	 P U B L I C	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_FramePool_Init()
+//					Releases all frames and clears the statistics. It is called by EZMacPRO_Init(),
+//					any frame held by the application is lost.
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_FramePool_Init(void)
+{
+	FramePoolFreeMap = (FRAME_POOL_SIZE == 32) ? 0xFFFFFFFF : (((U32)1 << FRAME_POOL_SIZE) - 1);
+	FramePoolInUse = 0;
+	FramePoolHighWater = 0;
+	FramePoolAllocFail = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Frame_Alloc()
+//					Takes a free frame from the pool. The function can be called from the main
+//					thread and from the MAC interrupts as well. The time of the allocation does not
+//					depend on the pool size.
+//
+// Return Value :	frame handle, use FRAME_POOL_BUFFER() to access the payload
+//					FRAME_POOL_INVALID: there was no free frame, FramePoolAllocFail is incremented
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+U8 EZMacPRO_Frame_Alloc(void)
+{
+	U32 freeMap;
+	U8 frame;
+#ifndef STM32_MODULE
+	U8 ea;
+#endif
+
+#ifdef STM32_MODULE
+	do
+	{
+		freeMap = __LDREXW((U32 *)&FramePoolFreeMap);
+		if (freeMap == 0)
+		{
+			__CLREX();
+			framePoolAdd(&FramePoolAllocFail, 1);
+			return FRAME_POOL_INVALID;
+		}
+		frame = 31 - __CLZ(freeMap);			// take the highest free frame
+		freeMap &= ~((U32)1 << frame);
+	} while (__STREXW(freeMap, (U32 *)&FramePoolFreeMap));
+#else
+	FRAME_POOL_ENTER(ea);
+	freeMap = FramePoolFreeMap;
+	if (freeMap == 0)
+	{
+		FRAME_POOL_EXIT(ea);
+		framePoolAdd(&FramePoolAllocFail, 1);
+		return FRAME_POOL_INVALID;
+	}
+	for (frame = 0; (freeMap & ((U32)1 << frame)) == 0; frame++);
+	FramePoolFreeMap = freeMap & ~((U32)1 << frame);
+	FRAME_POOL_EXIT(ea);
+#endif
+
+	framePoolUpdateHighWater(framePoolAdd(&FramePoolInUse, 1));
+	return frame;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Frame_Free()
+//					Gives the frame back to the pool. Freeing FRAME_POOL_INVALID or a frame which is
+//					already free is ignored.
+//
+// Return Value :	None
+// Parameters	:	frame - frame handle returned by EZMacPRO_Frame_Alloc()
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Frame_Free(U8 frame)
+{
+	U32 freeMap;
+#ifndef STM32_MODULE
+	U8 ea;
+#endif
+
+	if (frame >= FRAME_POOL_SIZE)
+		return;
+
+#ifdef STM32_MODULE
+	do
+	{
+		freeMap = __LDREXW((U32 *)&FramePoolFreeMap);
+		if (freeMap & ((U32)1 << frame))
+		{
+			__CLREX();
+			return;
+		}
+		freeMap |= ((U32)1 << frame);
+	} while (__STREXW(freeMap, (U32 *)&FramePoolFreeMap));
+#else
+	FRAME_POOL_ENTER(ea);
+	freeMap = FramePoolFreeMap;
+	if (freeMap & ((U32)1 << frame))
+	{
+		FRAME_POOL_EXIT(ea);
+		return;
+	}
+	FramePoolFreeMap = freeMap | ((U32)1 << frame);
+	FRAME_POOL_EXIT(ea);
+#endif
+
+	framePoolAdd(&FramePoolInUse, -1);
+}
@@ -0,0 +1,57 @@
+/*!\file EZMacPro_FramePool.h
+ * \brief Header of EZMacPro_FramePool.c.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+#ifndef _EZMACPRO_FRAMEPOOL_H_
+#define _EZMACPRO_FRAMEPOOL_H_
+
+
+                /* ======================================= *
+                 *          D E F I N I T I O N S          *
+                 * ======================================= */
+
+/*!
+ * Frame handle returned when the pool is exhausted or no frame is held.
+ */
+#define FRAME_POOL_INVALID              0xFF
+
+/*!
+ * Size of one frame buffer, every frame can hold the largest payload.
+ */
+#define FRAME_POOL_FRAME_SIZE           RECEIVED_BUFFER_SIZE
+
+/*!
+ * Access the payload buffer of a frame handle.
+ */
+#define FRAME_POOL_BUFFER(frame)        (FramePool[frame])
+
+
+                /* ======================================= *
+                 *     G L O B A L   V A R I A B L E S     *
+                 * ======================================= */
+
+extern SEGMENT_VARIABLE(FramePool[FRAME_POOL_SIZE][FRAME_POOL_FRAME_SIZE], U8, BUFFER_MSPACE);
+extern volatile SEGMENT_VARIABLE(FramePoolInUse, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(FramePoolHighWater, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern volatile SEGMENT_VARIABLE(FramePoolAllocFail, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+
+                /* ======================================= *
+                 *  F U N C T I O N   P R O T O T Y P E S  *
+                 * ======================================= */
+
+void EZMacPRO_FramePool_Init(void);
+U8   EZMacPRO_Frame_Alloc(void);
+void EZMacPRO_Frame_Free(U8 frame);
+
+
+#endif //_EZMACPRO_FRAMEPOOL_H_
@@ -0,0 +1,419 @@
+/*!\file EZMacPro_Nvm.c
+ * \brief Wear-levelled record store in the flash pages provided by the port.
+ *
+ * \n The records are appended to the active page, a changed record is written
+ * \n again and the previous copy is left in place. When the active page is
+ * \n full, the latest copy of every record is moved to the next page, so the
+ * \n pages are erased in turn. The first word of a page holds its sequence
+ * \n number, the page with the highest valid sequence number is the active one.
+ * \n This word is written after the records are copied, so a reset during the
+ * \n copy leaves the previous page active.
+ *
+ * \n A record starts with a word holding its key, its length and a check
+ * \n value, followed by the data padded to words. A record with a wrong check
+ * \n value (e.g. written during a reset) is skipped. A record of length 0
+ * \n erases the key.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+/* ======================================= *
+ *				I N C L U D E				*
+ * ======================================= */
+
+#include "stack.h"
+
+#ifdef FLASH_ENABLED
+
+#define NVM_PAGE_HEADER(seq)			(((U32)(U16)~(seq) << 16) | (U16)(seq))
+#define NVM_RECORD_HEADER(key, len, check)	(((U32)(check) << 16) | ((U32)(len) << 8) | (key))
+#define NVM_RECORD_KEY(header)			((U8)(header))
+#define NVM_RECORD_LEN(header)			((U8)((header) >> 8))
+#define NVM_RECORD_CHECK(header)		((U16)((header) >> 16))
+// size of a record with its header in bytes
+#define NVM_RECORD_SIZE(len)			((U16)(4 + (((U16)(len) + 3) & ~3)))
+
+/* ======================================= *
+ *	 G L O B A L	V A R I A B L E S	 *
+ * ======================================= */
+
+SEGMENT_VARIABLE(NvmPage, U8, EZMAC_PRO_GLOBAL_MSPACE);
+SEGMENT_VARIABLE(NvmSeq, U16, EZMAC_PRO_GLOBAL_MSPACE);
+// offset of the first free word in the active page
+SEGMENT_VARIABLE(NvmFree, U16, EZMAC_PRO_GLOBAL_MSPACE);
+
+// statistics
+SEGMENT_VARIABLE(NvmEraseCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+SEGMENT_VARIABLE(NvmWriteCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+/* ======================================= *
+ *		L O C A L	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	nvmCheckByte()
+//
+// Return Value : U16 - the updated check value
+// Parameters	: check - check value
+//				  value - next byte of the record
+//
+// Notes:
+//
+// Fletcher style check over the key, the length and the data of a record.
+//
+//------------------------------------------------------------------------------------------------
+static U16 nvmCheckByte(U16 check, U8 value)
+{
+	U8 sum1 = (U8)check + value;
+	U8 sum2 = (U8)(check >> 8) + sum1;
+
+	return ((U16)sum2 << 8) | sum1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	nvmByte()
+//
+// Return Value : U8 - byte of the record data
+// Parameters	: page - flash page
+//				  offset - offset of the record header
+//				  index - index of the byte in the record data
+//
+//------------------------------------------------------------------------------------------------
+static U8 nvmByte(U8 page, U16 offset, U8 index)
+{
+	return (U8)(NvmReadWord(page, offset + 4 + (index & ~3)) >> (8 * (index & 3)));
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	nvmRecordValid()
+//
+// Return Value : U8 - 1 if the record is complete
+// Parameters	: page - flash page
+//				  offset - offset of the record header
+//
+//------------------------------------------------------------------------------------------------
+static U8 nvmRecordValid(U8 page, U16 offset)
+{
+	U32 header = NvmReadWord(page, offset);
+	U8 len = NVM_RECORD_LEN(header);
+	U16 check;
+	U8 index;
+
+	if ((NVM_RECORD_KEY(header) == 0) || (NVM_RECORD_KEY(header) >= NVM_KEYS))
+		return 0;
+
+	check = nvmCheckByte(nvmCheckByte(0, NVM_RECORD_KEY(header)), len);
+	for (index = 0; index < len; index++)
+		check = nvmCheckByte(check, nvmByte(page, offset, index));
+
+	return (check == NVM_RECORD_CHECK(header)) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	nvmPageEnd()
+//
+// Return Value : U16 - offset of the first free word of the page
+// Parameters	: page - flash page
+//
+// Notes:
+//
+// The records are walked by their length up to the first erased header word. A record running
+// over the end of the page fills the page.
+//
+//------------------------------------------------------------------------------------------------
+static U16 nvmPageEnd(U8 page)
+{
+	U16 offset = 4;
+	U32 header;
+
+	while (offset < NVM_PAGE_SIZE)
+	{
+		header = NvmReadWord(page, offset);
+		if (header == NVM_ERASED)
+			break;
+		offset += NVM_RECORD_SIZE(NVM_RECORD_LEN(header));
+	}
+
+	return (offset < NVM_PAGE_SIZE) ? offset : NVM_PAGE_SIZE;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	nvmFind()
+//
+// Return Value : U16 - offset of the latest valid record of the key in the active page,
+//				  0 if there is none
+// Parameters	: key - record key
+//
+//------------------------------------------------------------------------------------------------
+static U16 nvmFind(U8 key)
+{
+	U16 offset;
+	U16 found = 0;
+	U32 header;
+
+	for (offset = 4; offset < NvmFree; offset += NVM_RECORD_SIZE(NVM_RECORD_LEN(header)))
+	{
+		header = NvmReadWord(NvmPage, offset);
+		if ((NVM_RECORD_KEY(header) == key) && nvmRecordValid(NvmPage, offset))
+			found = offset;
+	}
+
+	return found;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	nvmAppend()
+//
+// Return Value : U8 - 1 if the record is written
+// Parameters	: page - flash page
+//				  offset - offset of the record header, it has to be free
+//				  key - record key
+//				  data - record data
+//				  len - length of the data
+//
+// Notes:
+//
+// The header is written first, so a record interrupted by a reset has a header with a wrong
+// check value and the following records can still be found by its length.
+//
+//------------------------------------------------------------------------------------------------
+static U8 nvmAppend(U8 page, U16 offset, U8 key, VARIABLE_SEGMENT_POINTER(data, U8, APPLICATION_MSPACE), U8 len)
+{
+	U16 check;
+	U32 word = 0;
+	U8 index;
+
+	check = nvmCheckByte(nvmCheckByte(0, key), len);
+	for (index = 0; index < len; index++)
+		check = nvmCheckByte(check, data[index]);
+
+	NvmWriteCount++;
+	if (!NvmWriteWord(page, offset, NVM_RECORD_HEADER(key, len, check)))
+		return 0;
+
+	for (index = 0; index < len; index++)
+	{
+		word |= (U32)data[index] << (8 * (index & 3));
+		if (((index & 3) == 3) || (index == len - 1))
+		{
+			if (!NvmWriteWord(page, offset + 4 + (index & ~3), word))
+				return 0;
+			word = 0;
+		}
+	}
+
+	return 1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	nvmFormat()
+//
+// Return Value : U16 - offset of the first free word of the erased page, 0 if it failed
+// Parameters	: page - flash page
+//				  skip - key which is not copied, 0 to copy all records
+//
+// Notes:
+//
+// Erases the page and copies the latest valid record of every key from the active page to it.
+// The erased keys are dropped. The page header is not written.
+//
+//------------------------------------------------------------------------------------------------
+static U16 nvmFormat(U8 page, U8 skip)
+{
+	U16 latest[NVM_KEYS];
+	U16 offset;
+	U16 to = 4;
+	U16 index;
+	U32 header;
+	U8 key;
+
+	NvmEraseCount++;
+	if (!NvmErasePage(page))
+		return 0;
+
+	for (key = 0; key < NVM_KEYS; key++)
+		latest[key] = 0;
+	for (offset = 4; offset < NvmFree; offset += NVM_RECORD_SIZE(NVM_RECORD_LEN(header)))
+	{
+		header = NvmReadWord(NvmPage, offset);
+		if (nvmRecordValid(NvmPage, offset))
+			latest[NVM_RECORD_KEY(header)] = offset;
+	}
+
+	for (key = 1; key < NVM_KEYS; key++)
+	{
+		offset = latest[key];
+		if ((key == skip) || (offset == 0))
+			continue;
+		header = NvmReadWord(NvmPage, offset);
+		if (NVM_RECORD_LEN(header) == 0)
+			continue;
+
+		NvmWriteCount++;
+		for (index = 0; index < NVM_RECORD_SIZE(NVM_RECORD_LEN(header)); index += 4)
+			if (!NvmWriteWord(page, to + index, NvmReadWord(NvmPage, offset + index)))
+				return 0;
+		to += NVM_RECORD_SIZE(NVM_RECORD_LEN(header));
+	}
+
+	return to;
+}
+
+/* ======================================= *
+ *	 P U B L I C	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Nvm_Init()
+//					Finds the active page and its end. If there is no valid page (first start)
+//					the first page is erased and activated. It is called by EZMacPRO_Init().
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Nvm_Init(void)
+{
+	U8 page;
+	U8 found = 0;
+	U32 header;
+
+	for (page = 0; page < NVM_PAGES; page++)
+	{
+		header = NvmReadWord(page, 0);
+		if (header != NVM_PAGE_HEADER((U16)header))
+			continue;
+		if (!found || ((S16)((U16)header - NvmSeq) > 0))
+		{
+			NvmPage = page;
+			NvmSeq = (U16)header;
+			found = 1;
+		}
+	}
+
+	if (found)
+	{
+		NvmFree = nvmPageEnd(NvmPage);
+		return;
+	}
+
+	NvmPage = 0;
+	NvmSeq = 0;
+	NvmFree = 4;
+	NvmEraseCount++;
+	if (!NvmErasePage(0) || !NvmWriteWord(0, 0, NVM_PAGE_HEADER(0)))
+		NvmFree = NVM_PAGE_SIZE;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Nvm_Read()
+//					Reads the latest copy of a record.
+//
+// Return Value :	the number of bytes copied to data, 0 if the record is not found or erased
+// Parameters	:	key - record key, 1 to NVM_KEYS - 1
+//					data - buffer of the record
+//					size - size of the buffer, a longer record is truncated
+//------------------------------------------------------------------------------------------------
+U8 EZMacPRO_Nvm_Read(U8 key, VARIABLE_SEGMENT_POINTER(data, U8, APPLICATION_MSPACE), U8 size)
+{
+	U16 offset;
+	U8 len;
+	U8 index;
+
+	if ((key == 0) || (key >= NVM_KEYS))
+		return 0;
+
+	offset = nvmFind(key);
+	if (offset == 0)
+		return 0;
+
+	len = NVM_RECORD_LEN(NvmReadWord(NvmPage, offset));
+	if (len > size)
+		len = size;
+	for (index = 0; index < len; index++)
+		data[index] = nvmByte(NvmPage, offset, index);
+
+	return len;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Nvm_Write()
+//					Writes a record. Nothing is written if the data is the same as the latest
+//					copy, so the record can be written whenever it may have changed. If the page
+//					is full the records are moved to the next page.
+//					The CPU stalls while the flash is written, it can only be called when the
+//					MAC is in Sleep or Idle state.
+//
+// Return Value :	MAC_OK: the record is written
+//					STATE_ERROR: the MAC is not in Sleep or Idle state
+//					INCONSISTENT_SETTING: the record does not fit into a page with the others
+//					VALUE_ERROR: invalid key or the flash could not be written
+// Parameters	:	key - record key, 1 to NVM_KEYS - 1
+//					data - record data
+//					len - length of the data, 0 erases the record
+//------------------------------------------------------------------------------------------------
+MacParams EZMacPRO_Nvm_Write(U8 key, VARIABLE_SEGMENT_POINTER(data, U8, APPLICATION_MSPACE), U8 len)
+{
+	U16 offset;
+	U8 index;
+	U8 page;
+
+	if ((key == 0) || (key >= NVM_KEYS))
+		return VALUE_ERROR;
+	if ((EZMacProReg.name.MSR != EZMAC_PRO_SLEEP) && (EZMacProReg.name.MSR != EZMAC_PRO_IDLE))
+		return STATE_ERROR;
+
+	offset = nvmFind(key);
+	if (offset != 0)
+	{
+		if (NVM_RECORD_LEN(NvmReadWord(NvmPage, offset)) == len)
+		{
+			for (index = 0; index < len; index++)
+				if (nvmByte(NvmPage, offset, index) != data[index])
+					break;
+			if (index == len)
+				return MAC_OK;
+		}
+	}
+	else if (len == 0)
+		return MAC_OK;
+
+	if (NvmFree + NVM_RECORD_SIZE(len) <= NVM_PAGE_SIZE)
+	{
+		offset = NvmFree;
+		NvmFree += NVM_RECORD_SIZE(len);
+		return nvmAppend(NvmPage, offset, key, data, len) ? MAC_OK : VALUE_ERROR;
+	}
+
+	// the page is full, move the records to the next page with the new one
+	page = (NvmPage + 1) % NVM_PAGES;
+	offset = nvmFormat(page, key);
+	if (offset == 0)
+		return VALUE_ERROR;
+	if ((len != 0) && (offset + NVM_RECORD_SIZE(len) > NVM_PAGE_SIZE))
+		return INCONSISTENT_SETTING;
+	if ((len != 0) && !nvmAppend(page, offset, key, data, len))
+		return VALUE_ERROR;
+	if (!NvmWriteWord(page, 0, NVM_PAGE_HEADER(NvmSeq + 1)))
+		return VALUE_ERROR;
+
+	NvmPage = page;
+	NvmSeq++;
+	NvmFree = nvmPageEnd(page);
+	return MAC_OK;
+}
+
+#endif //FLASH_ENABLED
@@ -0,0 +1,37 @@
+/*!\file EZMacPro_Nvm.h
+ * \brief Header of EZMacPro_Nvm.c.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+#ifndef _EZMACPRO_NVM_H_
+#define _EZMACPRO_NVM_H_
+
+#ifdef FLASH_ENABLED
+
+                /* ======================================= *
+                 *     G L O B A L   V A R I A B L E S     *
+                 * ======================================= */
+
+extern SEGMENT_VARIABLE(NvmEraseCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+extern SEGMENT_VARIABLE(NvmWriteCount, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+
+                /* ======================================= *
+                 *  F U N C T I O N   P R O T O T Y P E S  *
+                 * ======================================= */
+
+void EZMacPRO_Nvm_Init(void);
+U8   EZMacPRO_Nvm_Read(U8 key, VARIABLE_SEGMENT_POINTER(data, U8, APPLICATION_MSPACE), U8 size);
+MacParams EZMacPRO_Nvm_Write(U8 key, VARIABLE_SEGMENT_POINTER(data, U8, APPLICATION_MSPACE), U8 len);
+
+#endif //FLASH_ENABLED
+
+#endif //_EZMACPRO_NVM_H_
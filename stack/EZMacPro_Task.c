@@ -0,0 +1,306 @@
+/*!\file EZMacPro_Task.c
+ * \brief Cooperative task scheduler and asynchronous API on top of the event queue.
+ *
+ * \n The tasks are protothreads (see EZMacPro_Task.h). EZMacPRO_Task_Schedule()
+ * \n takes one event from the event queue, runs the expired software timers,
+ * \n completes the pending asynchronous operation if the event belongs to it,
+ * \n then runs every task once. The MCU sleeps in EZMacPRO_Event_Wait() while
+ * \n all tasks are waiting and the queue is empty.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+/* ======================================= *
+ *				I N C L U D E				*
+ * ======================================= */
+
+#include "stack.h"
+
+/* ======================================= *
+ *	 G L O B A L	V A R I A B L E S	 *
+ * ======================================= */
+
+#define EVENT_MASK(type)		((U32)1 << (type))
+
+SEGMENT_VARIABLE(TaskTable[TASK_TABLE_SIZE], EZMacProTask, APPLICATION_MSPACE);
+SEGMENT_VARIABLE(TaskPt[TASK_TABLE_SIZE], EZMacProPt, APPLICATION_MSPACE);
+SEGMENT_VARIABLE(TaskReady, U8, APPLICATION_MSPACE);
+
+// the event being processed by the tasks, EZMAC_EVENT_NONE if the tasks run without event
+SEGMENT_VARIABLE(TaskEvent, EZMacProEvent, APPLICATION_MSPACE);
+
+// pending asynchronous operation
+SEGMENT_VARIABLE(AsyncMask, U32, APPLICATION_MSPACE);
+SEGMENT_VARIABLE(AsyncDone, EZMacProCompletion, APPLICATION_MSPACE);
+// the event that completed the last asynchronous operation
+SEGMENT_VARIABLE(AsyncEvent, EZMacProEvent, APPLICATION_MSPACE);
+
+/* ======================================= *
+ *		L O C A L	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	asyncStart()
+//
+// Return Value : MacParams - status of the started operation
+// Parameters	: status - return value of the synchronous API function
+//				  mask - events completing the operation
+//				  done - completion callback, can be NULL
+//
+// Notes:
+//
+// The operation is pending only if it has been started. The completing event can already be in
+// the queue, it is processed by the next EZMacPRO_Task_Schedule() call after the mask is set.
+//
+//------------------------------------------------------------------------------------------------
+static MacParams asyncStart(MacParams status, U32 mask, EZMacProCompletion done)
+{
+	if (status == MAC_OK)
+	{
+		AsyncDone = done;
+		AsyncEvent.type = EZMAC_EVENT_NONE;
+		AsyncMask = mask;
+	}
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	asyncDispatch()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Completes the pending operation if TaskEvent is one of its completing events.
+//
+//------------------------------------------------------------------------------------------------
+static void asyncDispatch(void)
+{
+	EZMacProCompletion done;
+
+	if ((TaskEvent.type == EZMAC_EVENT_NONE) || !(AsyncMask & EVENT_MASK(TaskEvent.type)))
+		return;
+
+	AsyncMask = 0;
+	AsyncEvent.type = TaskEvent.type;
+	AsyncEvent.param = TaskEvent.param;
+	done = AsyncDone;
+	AsyncDone = NULL;
+	if (done != NULL)
+		done(TaskEvent.type, TaskEvent.param);
+}
+
+/* ======================================= *
+ *	 P U B L I C	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Task_Init()
+//					Removes all tasks and cancels the pending asynchronous operation.
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Task_Init(void)
+{
+	U8 temp8;
+
+	for (temp8 = 0; temp8 < TASK_TABLE_SIZE; temp8++)
+		TaskTable[temp8] = NULL;
+	TaskReady = 0;
+	TaskEvent.type = EZMAC_EVENT_NONE;
+	AsyncMask = 0;
+	AsyncDone = NULL;
+	AsyncEvent.type = EZMAC_EVENT_NONE;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Task_Add()
+//					Adds a task to the scheduler. The tasks run in the order they were added, a
+//					task can wait for a flag set by an earlier task in the same round.
+//
+// Return Value :	MAC_OK: the task is added
+//					VALUE_ERROR: the task table is full (TASK_TABLE_SIZE)
+// Parameters	:	task - the task function
+//------------------------------------------------------------------------------------------------
+MacParams EZMacPRO_Task_Add(EZMacProTask task)
+{
+	U8 temp8;
+
+	for (temp8 = 0; temp8 < TASK_TABLE_SIZE; temp8++)
+	{
+		if (TaskTable[temp8] == NULL)
+		{
+			PT_INIT(&TaskPt[temp8]);
+			TaskTable[temp8] = task;
+			// run the new task without waiting for an event
+			TaskReady = 1;
+			return MAC_OK;
+		}
+	}
+	return VALUE_ERROR;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Task_Schedule()
+//					Runs one round of the scheduler, it should be called from the main loop.
+//					If there is no event and no task yielded in the previous round the MCU
+//					sleeps until the next event. A task that exited or ended is removed.
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Task_Schedule(void)
+{
+	U8 temp8;
+	U8 ready = 0;
+
+	if (!EZMacPRO_Event_Get(&TaskEvent))
+	{
+		if (TaskReady)
+			TaskEvent.type = EZMAC_EVENT_NONE;
+		else
+			EZMacPRO_Event_Wait(&TaskEvent);
+	}
+
+	// the timer handlers run before the tasks see the event
+	EZMacPRO_Timer_Process();
+	asyncDispatch();
+
+	TaskReady = 0;
+	for (temp8 = 0; temp8 < TASK_TABLE_SIZE; temp8++)
+	{
+		if (TaskTable[temp8] == NULL)
+			continue;
+
+		switch (TaskTable[temp8](&TaskPt[temp8]))
+		{
+			case PT_YIELDED:
+				ready = 1;
+				break;
+
+			case PT_EXITED:
+			case PT_ENDED:
+				TaskTable[temp8] = NULL;
+				break;
+		}
+	}
+
+	// the event is consumed
+	TaskEvent.type = EZMAC_EVENT_NONE;
+	if (ready)
+		TaskReady = 1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Async_Busy()
+//					Waitable handle of the asynchronous API.
+//
+// Return Value :	1: the last asynchronous operation is not completed yet
+//					0: it is completed, AsyncEvent holds the completing event
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+U8 EZMacPRO_Async_Busy(void)
+{
+	return (AsyncMask != 0) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Transmit_Async()
+//					Starts EZMacPRO_Transmit(). The operation completes when the packet is sent
+//					(and acknowledged if requested) or the transmission failed.
+//
+// Return Values:	as EZMacPRO_Transmit()
+// Parameters	:	done - completion callback, called with EZMAC_EVENT_PACKET_SENT,
+//					EZMAC_EVENT_LBT_TIMEOUT, EZMAC_EVENT_ACK_TIMEOUT or EZMAC_EVENT_STATE_ERROR
+//------------------------------------------------------------------------------------------------
+#ifndef RECEIVER_ONLY_OPERATION
+MacParams EZMacPRO_Transmit_Async(EZMacProCompletion done)
+{
+	return asyncStart(
+		EZMacPRO_Transmit(),
+		EVENT_MASK(EZMAC_EVENT_PACKET_SENT) | EVENT_MASK(EZMAC_EVENT_LBT_TIMEOUT) |
+		EVENT_MASK(EZMAC_EVENT_ACK_TIMEOUT) | EVENT_MASK(EZMAC_EVENT_STATE_ERROR),
+		done);
+}
+#endif //RECEIVER_ONLY_OPERATION not defined
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Receive_Async()
+//					Starts EZMacPRO_Receive() and completes when a packet is received. If the
+//					stack is already receiving (the state after receive is RX in SECR) it only
+//					waits for the next packet.
+//
+// Return Values:	as EZMacPRO_Receive()
+// Parameters	:	done - completion callback, called with EZMAC_EVENT_PACKET_RECEIVED and the
+//					RSSI of the packet
+//------------------------------------------------------------------------------------------------
+#ifndef TRANSMITTER_ONLY_OPERATION
+MacParams EZMacPRO_Receive_Async(EZMacProCompletion done)
+{
+	MacParams status = MAC_OK;
+
+	if (!(EZMacProReg.name.MSR & RX_STATE_BIT))
+		status = EZMacPRO_Receive();
+
+	return asyncStart(status, EVENT_MASK(EZMAC_EVENT_PACKET_RECEIVED), done);
+}
+#endif //TRANSMITTER_ONLY_OPERATION not defined
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Idle_Async()
+//					Calls EZMacPRO_Idle() and completes when the Idle state entered event is
+//					processed. An aborted transmission or reception is not an error here.
+//
+// Return Values:	MAC_OK: the MAC goes to Idle
+//					STATE_ERROR: the MAC is in Sleep state
+// Parameters	:	done - completion callback, called with EZMAC_EVENT_STATE_IDLE
+//------------------------------------------------------------------------------------------------
+MacParams EZMacPRO_Idle_Async(EZMacProCompletion done)
+{
+	if (EZMacProReg.name.MSR == EZMAC_PRO_SLEEP)
+		return STATE_ERROR;
+
+	EZMacPRO_Idle();
+	return asyncStart(MAC_OK, EVENT_MASK(EZMAC_EVENT_STATE_IDLE), done);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Sleep_Async()
+//					Calls EZMacPRO_Sleep() and completes when the Sleep state entered event is
+//					processed.
+//
+// Return Values:	as EZMacPRO_Sleep()
+// Parameters	:	done - completion callback, called with EZMAC_EVENT_STATE_SLEEP
+//------------------------------------------------------------------------------------------------
+MacParams EZMacPRO_Sleep_Async(EZMacProCompletion done)
+{
+	return asyncStart(EZMacPRO_Sleep(), EVENT_MASK(EZMAC_EVENT_STATE_SLEEP), done);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Wake_Up_Async()
+//					Calls EZMacPRO_Wake_Up_Start(), it does not wait for the crystal. The operation
+//					completes when the Idle state entered event (chip ready) is processed.
+//
+// Return Values:	as EZMacPRO_Wake_Up_Start()
+// Parameters	:	done - completion callback, called with EZMAC_EVENT_STATE_IDLE, or with
+//					EZMAC_EVENT_STATE_ERROR if the crystal did not start
+//------------------------------------------------------------------------------------------------
+MacParams EZMacPRO_Wake_Up_Async(EZMacProCompletion done)
+{
+	return asyncStart(
+		EZMacPRO_Wake_Up_Start(),
+		EVENT_MASK(EZMAC_EVENT_STATE_IDLE) | EVENT_MASK(EZMAC_EVENT_STATE_ERROR),
+		done);
+}
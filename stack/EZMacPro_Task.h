@@ -0,0 +1,131 @@
+/*!\file EZMacPro_Task.h
+ * \brief Header of EZMacPro_Task.c.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+#ifndef _EZMACPRO_TASK_H_
+#define _EZMACPRO_TASK_H_
+
+
+                /* ======================================= *
+                 *          D E F I N I T I O N S          *
+                 * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Protothreads
+//
+// A task is a function that keeps its position in a local continuation (the source line it
+// waits at) and returns to the scheduler instead of blocking. Local variables are not kept
+// between the calls, use global or static variables in the tasks. A switch() can not be used
+// around the wait macros.
+//------------------------------------------------------------------------------------------------
+typedef struct EZMacProPt
+{
+	U16 lc;									// local continuation
+} EZMacProPt;
+
+typedef U8 (*EZMacProTask)(EZMacProPt *pt);
+
+// return values of the tasks
+#define PT_WAITING						0
+#define PT_YIELDED						1
+#define PT_EXITED						2
+#define PT_ENDED						3
+
+#define PT_INIT(pt)						(pt)->lc = 0
+
+#define PT_BEGIN(pt)					{ U8 PT_YIELD_FLAG = 1; PT_YIELD_FLAG = PT_YIELD_FLAG; switch ((pt)->lc) { case 0:
+
+#define PT_END(pt)						} PT_INIT(pt); return PT_ENDED; }
+
+#define PT_WAIT_UNTIL(pt, condition)	\
+	do {								\
+		(pt)->lc = __LINE__;			\
+		case __LINE__:					\
+		if (!(condition))				\
+			return PT_WAITING;			\
+	} while (0)
+
+#define PT_WAIT_WHILE(pt, condition)	PT_WAIT_UNTIL((pt), !(condition))
+
+#define PT_YIELD(pt)					\
+	do {								\
+		PT_YIELD_FLAG = 0;				\
+		(pt)->lc = __LINE__;			\
+		case __LINE__:					\
+		if (PT_YIELD_FLAG == 0)			\
+			return PT_YIELDED;			\
+	} while (0)
+
+#define PT_EXIT(pt)						\
+	do {								\
+		PT_INIT(pt);					\
+		return PT_EXITED;				\
+	} while (0)
+
+// 1 while the task has not exited or ended
+#define PT_SCHEDULE(task)				((task) < PT_EXITED)
+
+// runs a child task until it exits or ends, the parent returns what the child returned
+// meanwhile, so a yield of the child keeps the task ready in the scheduler
+#define PT_SPAWN(pt, child, task)		\
+	do {								\
+		U8 PT_CHILD_STATE;				\
+		PT_INIT(child);					\
+		(pt)->lc = __LINE__;			\
+		case __LINE__:					\
+		PT_CHILD_STATE = (task);		\
+		if (PT_SCHEDULE(PT_CHILD_STATE))	\
+			return PT_CHILD_STATE;		\
+	} while (0)
+
+// waits for an event from the event queue, it has to arrive after the wait started
+#define PT_WAIT_EVENT(pt, event)		PT_WAIT_UNTIL((pt), TaskEvent.type == (event))
+
+// waits for the completion of the last EZMacPRO_xxx_Async() call
+#define PT_WAIT_ASYNC(pt)				PT_WAIT_WHILE((pt), EZMacPRO_Async_Busy())
+
+//------------------------------------------------------------------------------------------------
+// completion callback of the asynchronous API
+// event: the event that completed the operation, param: its parameter
+//------------------------------------------------------------------------------------------------
+typedef void (*EZMacProCompletion)(U8 event, U8 param);
+
+
+                /* ======================================= *
+                 *     G L O B A L   V A R I A B L E S     *
+                 * ======================================= */
+
+extern SEGMENT_VARIABLE(TaskEvent, EZMacProEvent, APPLICATION_MSPACE);
+extern SEGMENT_VARIABLE(AsyncEvent, EZMacProEvent, APPLICATION_MSPACE);
+
+
+                /* ======================================= *
+                 *  F U N C T I O N   P R O T O T Y P E S  *
+                 * ======================================= */
+
+void EZMacPRO_Task_Init(void);
+MacParams EZMacPRO_Task_Add(EZMacProTask task);
+void EZMacPRO_Task_Schedule(void);
+
+U8 EZMacPRO_Async_Busy(void);
+#ifndef RECEIVER_ONLY_OPERATION
+MacParams EZMacPRO_Transmit_Async(EZMacProCompletion done);
+#endif
+#ifndef TRANSMITTER_ONLY_OPERATION
+MacParams EZMacPRO_Receive_Async(EZMacProCompletion done);
+#endif
+MacParams EZMacPRO_Idle_Async(EZMacProCompletion done);
+MacParams EZMacPRO_Sleep_Async(EZMacProCompletion done);
+MacParams EZMacPRO_Wake_Up_Async(EZMacProCompletion done);
+
+
+#endif //_EZMACPRO_TASK_H_
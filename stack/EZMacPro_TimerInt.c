@@ -21,8 +21,13 @@
  *	 G L O B A L	V A R I A B L E S	 *
  * ======================================= */
 
+#ifndef EZMACPRO_CONTEXT
 SEGMENT_VARIABLE(ChannelOccupiedInStartPeriod, U8, EZMAC_PRO_GLOBAL_MSPACE);
 SEGMENT_VARIABLE(ChannelOccupiedCounter, U8, EZMAC_PRO_GLOBAL_MSPACE);
+#endif
+
+// the longest delay from the deadline to the timeout handling (MAC timer ticks)
+volatile SEGMENT_VARIABLE(TimerIntMaxLatency, U32, EZMAC_PRO_GLOBAL_MSPACE);
 
 /* ======================================= *
  *		L O C A L	F U N C T I O N S		*
@@ -38,10 +43,19 @@ SEGMENT_VARIABLE(ChannelOccupiedCounter, U8, EZMAC_PRO_GLOBAL_MSPACE);
 // This is the Interrupt Service Routing for the T0 timer. The T0 timer is used for all MAC
 // time outs and MAC timing events. The T0 time base uses SYSCLK/4 for all supported SYSCLK
 // frequencies. The time outs are calculated using macros or calculated by the initialization
-// or register write API functions. Since some time outs require long periods a 24-bit timer
-// has been implemented using a global variable for the most significant byte. If the MSB of the
-// timer (EZMacProTimerMSB) is non-zero, it will be decrement and the ISR will be called again
-// when the timer overflows.
+// or register write API functions. Since some time outs require long periods the port extends
+// the timer to 32 bits. MAC_TIMER_EXPIRED() tells if the interrupt is the end of the timeout:
+// the STM32 port chains two timers into a free-running 32-bit clock and compares against an
+// absolute deadline, so the timeout is expired if the compare interrupt is pending. The 8051
+// port keeps the upper word in EZMacProTimerMSB, it is decremented on each overflow until it
+// reaches zero.
+//
+// The STM32 port also generates the tick of the timer wheel on the MAC timer, MAC_TIMER_TICK()
+// tells if the interrupt is a tick.
+//
+// TimerIntMaxLatency keeps the longest time from the deadline to this point. The MAC critical
+// sections of the API functions and the higher priority interrupts delay the timer interrupt,
+// the value shows the worst case jitter of the timeouts.
 //
 // This function disables the timer interrupts before executing the state machines. If a
 // timeout event is to initiate another timeout event, the timerIntTimeout() function should
@@ -62,8 +76,17 @@ INTERRUPT(timerIntT3_ISR, INTERRUPT_TIMER3)
 {
 	U8 state;
 	U8 msr;
-	if (EZMacProTimerMSB == 0)
+	U32 latency;
+
+	if (MAC_TIMER_TICK())
+		EZMacPRO_Timer_Tick();
+
+	if (MAC_TIMER_EXPIRED())
 	{
+		latency = MAC_TIMER_LATENCY();
+		if (latency > TimerIntMaxLatency)
+			TimerIntMaxLatency = latency;
+
 		DISABLE_MAC_TIMER_INTERRUPT();
 		STOP_MAC_TIMER();
 		CLEAR_MAC_TIMER_INTERRUPT();
@@ -88,11 +111,6 @@ INTERRUPT(timerIntT3_ISR, INTERRUPT_TIMER3)
 		}
 #endif
 	}
-	else
-	{
-		CLEAR_MAC_TIMER_INTERRUPT();
-		EZMacProTimerMSB--;
-	}
 }
 //------------------------------------------------------------------------------------------------
 // Function Name
@@ -169,6 +187,7 @@ void timerIntTX_StateMachine (U8 state)
 			else
 			{	//the channnel was busy during the first 0.5ms
 				BusyLBT = 0;
+				timerIntCsmaBusy();
 				ChannelOccupiedInStartPeriod = 1;
 				ChannelOccupiedCounter = 0;
 				// start timer with fix 1ms timeout
@@ -188,12 +207,23 @@ void timerIntTX_StateMachine (U8 state)
 			{	//the channel was free during the 0.5ms start period
 				if (BusyLBT == 0)
 			 {// LBT passed, channel should be clear in the fix 4.5ms period
+					// wait for a random part of the contention window first
+					timeout = timerIntCsmaBackoff();
+					if (timeout != 0)
+					{
+						timerIntTimeout(timeout);
+						EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_LBT_RANDOM_LISTEN;
+						ENABLE_MAC_TIMER_INTERRUPT();
+						break;
+					}
 					//disable the receiver
 				timerIntSetFunction1(SI4432_XTON);
 					// clear enable 2 interrupt
 				timerIntSetEnable2(0x00);
 				// enable ENPKSENT bit
 				timerIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+				// the channel is taken, the contention window is reset
+				CsmaBE = CSMA_MIN_BE;
 				// enable TX
 				timerIntSetFunction1( SI4432_TXON|SI4432_XTON);
 				// start timer with transmit packet timeout
@@ -205,8 +235,9 @@ void timerIntTX_StateMachine (U8 state)
 				else
 				{//the channel was busy during the 4.5ms
 					BusyLBT = 0;
+					timerIntCsmaBusy();
 					// multiple by fixed plus random number
-				timeout = LBT_FIXED_TIME_5000US + TimeoutLBTI * (U32)(timerIntRandom());
+				timeout = LBT_FIXED_TIME_5000US + timerIntCsmaBackoff();
 				// start timer with timeout
 				timerIntTimeout(timeout);
 					//go to the next state
@@ -223,7 +254,7 @@ void timerIntTX_StateMachine (U8 state)
 				if (BusyLBT == 0)
 				{	// LBT passed, channel should be clear in the fix 1ms period
 					// multiple by fixed plus random number
-					timeout = LBT_FIXED_TIME_5000US + TimeoutLBTI * (U32)(timerIntRandom());
+					timeout = LBT_FIXED_TIME_5000US + timerIntCsmaBackoff();
 					// start timer with timeout
 					timerIntTimeout(timeout);
 					//go to the next state
@@ -290,6 +321,8 @@ void timerIntTX_StateMachine (U8 state)
 				timerIntSetEnable2(0x00);
 				// enable ENPKSENT bit
 				timerIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+				// the channel is taken, the contention window is reset
+				CsmaBE = CSMA_MIN_BE;
 				// enable TX
 				timerIntSetFunction1( SI4432_TXON|SI4432_XTON);
 				// start timer with transmit packet timeout
@@ -301,6 +334,7 @@ void timerIntTX_StateMachine (U8 state)
 				else
 				{//the channel was busy during the 5ms + random period
 					BusyLBT = 0;
+					timerIntCsmaBusy();
 					EZMacProLBT_Retrys++;
 					if (EZMacProLBT_Retrys < MAX_LBT_RETRIES)
 		 		{//the channel was busy and the retries didn't reach the maximum value
@@ -376,13 +410,65 @@ void timerIntTX_StateMachine (U8 state)
 		 timerIntSpiReadReg(SI4432_INTERRUPT_STATUS_2);
 		 //disable the receiver
 		 timerIntSetFunction1(SI4432_XTON);
+		 // double the ACK timeout of the peer (srtt + 4 * rttvar), the estimate recovers with
+		 // the next acknowledged first transmission
+		 if (AckRttEntry < ACK_RTT_TABLE_SIZE && AckRttTable[AckRttEntry].rttvar < TimeoutACK)
+			AckRttTable[AckRttEntry].rttvar = 2 * AckRttTable[AckRttEntry].rttvar + AckRttTable[AckRttEntry].srtt / 4;
+		 // raise the TX power of the link, to the maximum if the packet is given up
+		 if (EZMacProReg.name.LACR & LACR_POWER)
+			timerIntLinkPowerUp();
+		 // send the packet again if the retransmissions are not used up
+		 if (EZMacProTxAttempts <= (EZMacProReg.name.RTCR & RTCR_RETRIES))
+		 {
+			timeout = timerIntRetryBackoff();
+			EZMacProTxAttempts++;
+			if (timeout)
+			{
+				// start timer with the backoff
+				timerIntTimeout(timeout);
+				// go to the next state
+				EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_RETRY_BACKOFF;
+				ENABLE_MAC_TIMER_INTERRUPT();
+			}
+			else
+				timerIntRetransmit();
+			break;
+		 }
 //			//go to TX ERROR NO ACK state
 //		 EZMacProReg.name.MSR = TX_STATE_BIT | TX_ERROR_NO_ACK;
+		 // the bulk transfer is given up too
+		 BulkTxLength = 0;
+		 // too many lost packets bring the link back to the base data rate
+		 if (EZMacProReg.name.LACR & LACR_RATE)
+			timerIntLinkFailed();
 		 //call the no ack callback function
-		 EZMacPRO_AckTimeout();
+		 EZMacPRO_AckTimeout(EZMacProTxAttempts);
 		 // all done use SECR to determine next state
 		 timerIntGotoNextStateUsingSECR(1);
 		 break;
+
+		case TX_STATE_RETRY_BACKOFF:
+			// the backoff is over, send the packet again
+			timerIntRetransmit();
+			break;
+
+		case TX_STATE_BULK_GAP:
+			// the receiver is back in RX, send the next frame of the bulk transfer
+			// clear interrupts
+			timerIntSpiReadReg(SI4432_INTERRUPT_STATUS_1);
+			timerIntSpiReadReg(SI4432_INTERRUPT_STATUS_2);
+			// enable ENPKSENT bit
+			timerIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+			// clear enable 2 interrupt
+			timerIntSetEnable2(0x00);
+			// go to the next state
+			EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_WAIT_FOR_TX;
+			// start timer with transmit packet timeout
+			timerIntTimeout(TimeoutTX_Packet);
+			ENABLE_MAC_INTERRUPTS();
+			// enable TX
+			timerIntSetFunction1(SI4432_TXON|SI4432_XTON);
+			break;
 		#endif
 	#endif
 
@@ -441,6 +527,17 @@ void timerIntRX_StateMachine (U8 state)
 	{
 	#ifdef FOUR_CHANNEL_IS_USED
 		case RX_STATE_FREQUENCY_SEARCH:
+		#ifdef CHANNEL_QUALITY_ENABLED
+			// no preamble on the channel, measure its noise
+			timerIntChannelNoise(EZMacProCurrentChannel);
+		#endif
+		#ifdef TRANSCEIVER_OPERATION
+			#ifdef EXTENDED_PACKET_FORMAT
+			// the link to the last peer has expired, listen at the base data rate
+			if (EZMacProReg.name.LACR & LACR_RATE)
+				timerIntLinkHold();
+			#endif
+		#endif
 			if (EZMacProReg.name.RCR & 0x04)		// jump to the next channel if search mechanism is enabled
 				timerIntNextRX_Channel();
 
@@ -451,6 +548,32 @@ void timerIntRX_StateMachine (U8 state)
 
 	#ifdef MORE_CHANNEL_IS_USED
 		case RX_STATE_FREQUENCY_SEARCH:
+		#ifdef FAST_SCAN_ENABLED
+			// end of the RSSI screen: stay on the channel and wait for the preamble if it is not idle
+			if ((EZMacProReg.name.RCR & RCR_FAST_SCAN) && (FastScanDwell == 0))
+			{
+				if (timerIntSpiReadReg(SI4432_RECEIVED_SIGNAL_STRENGTH_INDICATOR) >= FAST_SCAN_RSSI_LIMIT)
+				{
+					FastScanDwell = 1;
+					timerIntTimeout(TimeoutChannelSearch);
+					ENABLE_MAC_TIMER_INTERRUPT();
+					break;
+				}
+			}
+			FastScanDwell = 0;
+		#endif
+		#ifdef CHANNEL_QUALITY_ENABLED
+			// no preamble on the channel, measure its noise and skip the blacklisted channels
+			timerIntChannelNoise(SelectedChannel);
+			timerIntSkipChannels();
+		#endif
+		#ifdef TRANSCEIVER_OPERATION
+			#ifdef EXTENDED_PACKET_FORMAT
+			// the link to the last peer has expired, listen at the base data rate
+			if (EZMacProReg.name.LACR & LACR_RATE)
+				timerIntLinkHold();
+			#endif
+		#endif
 			//check the channel number
 			if (SelectedChannel < (maxChannelNumber - 1))
 			{
@@ -462,7 +585,7 @@ void timerIntRX_StateMachine (U8 state)
 				//switch on the receiver
 				timerIntSetFunction1(SI4432_XTON|SI4432_RXON);
 				// start timer with channel search timeout
-				timerIntTimeout(TimeoutChannelSearch);
+				timerIntTimeout(SEARCH_TIMEOUT);
 					ENABLE_MAC_TIMER_INTERRUPT();
 			}
 			else
@@ -475,7 +598,7 @@ void timerIntRX_StateMachine (U8 state)
 				//switch on the receiver
 					timerIntSetFunction1(SI4432_XTON|SI4432_RXON);
 				// start timer with channel search timeout
-				timerIntTimeout(TimeoutChannelSearch);
+				timerIntTimeout(SEARCH_TIMEOUT);
 				ENABLE_MAC_TIMER_INTERRUPT();
 			}
 			break;
@@ -532,8 +655,11 @@ void timerIntRX_StateMachine (U8 state)
 			}
 			//jump to the next channel
 			timerIntSpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0+SelectedChannel]);
+		#ifdef FAST_SCAN_ENABLED
+			FastScanDwell = 0;
+		#endif
 			// start timer with channel search timeout
-			timerIntTimeout(TimeoutChannelSearch);
+			timerIntTimeout(SEARCH_TIMEOUT);
 		 ENABLE_MAC_TIMER_INTERRUPT();
 
 	#endif //MORE_CHANNEL_IS_USED
@@ -599,6 +725,7 @@ void timerIntRX_StateMachine (U8 state)
 			else
 			{//the channnel was busy during the first 0.5ms
 				BusyLBT = 0;
+				timerIntCsmaBusy();
 				ChannelOccupiedInStartPeriod = 1;
 				ChannelOccupiedCounter = 0;
 			 // start timer with fix 1ms timeout
@@ -620,12 +747,23 @@ void timerIntRX_StateMachine (U8 state)
 
 			 if (BusyLBT == 0)
 			 {// LBT passed, channel should be clear in the fix 4.5ms period
+					// wait for a random part of the contention window first
+					timeout = timerIntCsmaBackoff();
+					if (timeout != 0)
+					{
+						timerIntTimeout(timeout);
+						EZMacProReg.name.MSR = RX_STATE_BIT | RX_STATE_FORWARDING_LBT_RANDOM_LISTEN;
+						ENABLE_MAC_TIMER_INTERRUPT();
+						break;
+					}
 					//disable the receiver
 				timerIntSetFunction1(SI4432_XTON);
 					// clear enable 2 interrupt
 				timerIntSetEnable2(0x00);
 				// enable ENPKSENT bit
 				timerIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+				// the channel is taken, the contention window is reset
+				CsmaBE = CSMA_MIN_BE;
 				// enable TX
 				timerIntSetFunction1( SI4432_TXON|SI4432_XTON);
 				// start timer with packet transmit timeout
@@ -637,8 +775,9 @@ void timerIntRX_StateMachine (U8 state)
 				else
 				{//the channel was busy during the 4.5ms
 					BusyLBT = 0;
+					timerIntCsmaBusy();
 					// multiple by fixed plus random number
-				timeout = LBT_FIXED_TIME_5000US + TimeoutLBTI * (U32)(timerIntRandom());
+				timeout = LBT_FIXED_TIME_5000US + timerIntCsmaBackoff();
 				// start timer with timeout
 				timerIntTimeout(timeout);
 					//got to the next state
@@ -656,7 +795,7 @@ void timerIntRX_StateMachine (U8 state)
 				if (BusyLBT == 0)
 			 {// LBT passed, channel should be clear in the fix 1ms period
 				// multiple by fixed plus random number
-				timeout = LBT_FIXED_TIME_5000US + TimeoutLBTI * (U32)(timerIntRandom());
+				timeout = LBT_FIXED_TIME_5000US + timerIntCsmaBackoff();
 				// start timer with timeout
 				timerIntTimeout(timeout);
 					//go to the next state
@@ -723,6 +862,8 @@ void timerIntRX_StateMachine (U8 state)
 				timerIntSetEnable2(0x00);
 				// enable ENPKSENT bit
 				timerIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+				// the channel is taken, the contention window is reset
+				CsmaBE = CSMA_MIN_BE;
 				// enable TX
 				timerIntSetFunction1( SI4432_TXON|SI4432_XTON);
 				// start timer with fix transmit packet timeout
@@ -734,6 +875,7 @@ void timerIntRX_StateMachine (U8 state)
 			else
 			{	//the channel was busy during the 5ms + random period
 				BusyLBT = 0;
+				timerIntCsmaBusy();
 				EZMacProLBT_Retrys++;
 				if (EZMacProLBT_Retrys < MAX_LBT_RETRIES)
 				{	//the channel was busy and the retries didn't reach the maximum value
@@ -815,21 +957,15 @@ void timerIntRX_StateMachine (U8 state)
 // Function Name
 //	timerIntRandom()
 //
-// Return Value : U8 4-bit random number
+// Return Value : U8 random number
 // Parameters	: None
 //
 // Notes:
 //
-// This function provides a pseudo random number.
-// It uses 8-bit multiply and shift to generate the next random number.
-//
-// The constants used are based on the largest possible primes that will
-// satisfy the linear congruent criteria.
-//
-// The pseudo random sequence will repeat every 256 times.
-// The sequence always starts at the same point. If the application
-// requires a different sequence each time on reset, a truly random
-// seed may be required.
+// This function provides a pseudo random number, the upper byte of the next state of the
+// xorshift32 generator (see RANDOM_NEXT()). The generator is seeded by EZMacPRO_Init() from the
+// RSSI noise, the unique ID of the MCU and the timers, so the nodes started together do not
+// select the same backoffs.
 //
 // This function is only included if LISTEN_BEFORE_TALK_SUPPORTED is defined.
 //
@@ -837,16 +973,159 @@ void timerIntRX_StateMachine (U8 state)
 #ifdef TRANSCEIVER_OPERATION
 U8 timerIntRandom (void)
 {
-	U8 temp8;
-									// 61 is largest prime less than 256/4
-	EZMacProRandomNumber *= 245;	// 4 * 61 + 1 = 245
-	EZMacProRandomNumber += 251;	// 251 is the largest prime < 256
+	RANDOM_NEXT(EZMacProRandomNumber);
+	return (U8)(EZMacProRandomNumber >> 24);
+}
+#endif
+
 
-	temp8 = EZMacProRandomNumber >> 4;
-	if (temp8 == 0)
-		return 1;
+//-----------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntCsmaBackoff()
+//
+// Return Value : U32 random backoff in MAC timer ticks, 0: no backoff
+// Parameters	: None
+//
+// Notes:
+//
+// The backoff is a random number of LBT slots (TimeoutLBTI) from 0 to 2^CsmaBE - 1.
+//
+//-----------------------------------------------------------------------------------------------
+#ifdef TRANSCEIVER_OPERATION
+U32 timerIntCsmaBackoff (void)
+{
+	U8 slots;
+
+	slots = timerIntRandom() & (U8)((1 << CsmaBE) - 1);
+	return TimeoutLBTI * slots;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntCsmaBusy()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// The channel was found busy, the contention window is doubled up to 2^CSMA_MAX_BE slots.
+// It is reset to 2^CSMA_MIN_BE slots when the packet is sent.
+//
+//-----------------------------------------------------------------------------------------------
+void timerIntCsmaBusy (void)
+{
+	if (CsmaBE < CSMA_MAX_BE)
+		CsmaBE++;
+#ifdef CHANNEL_QUALITY_ENABLED
+	// the busy TX channel counts as noise
+	timerIntChannelPenalty(EZMacProCurrentChannel, CHANNEL_NOISE_PENALTY);
+#endif
+}
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntRetryBackoff()
+//
+// Return Value : U32 wait before the next retransmission in MAC timer ticks, 0: no wait
+// Parameters	: None
+//
+// Notes:
+//
+// The backoff is selected by the RTCR register. EZMacProTxAttempts is the number of the
+// transmissions so far, the next one is the EZMacProTxAttempts-th retransmission.
+// The exponential backoff takes a random number of slots from 1 to 2^(n-1), up to 16 slots.
+//
+//-----------------------------------------------------------------------------------------------
+#ifdef EXTENDED_PACKET_FORMAT
+U32 timerIntRetryBackoff (void)
+{
+	U8 slots;
+
+	switch (EZMacProReg.name.RTCR & RTCR_BACKOFF)
+	{
+		case RTCR_BACKOFF_FIXED:
+			slots = 1;
+			break;
+		case RTCR_BACKOFF_LINEAR:
+			slots = EZMacProTxAttempts;
+			break;
+		case RTCR_BACKOFF_EXPONENTIAL:
+			if (EZMacProTxAttempts < 5)
+				slots = 1 << (EZMacProTxAttempts - 1);
+			else
+				slots = 16;
+			slots = (timerIntRandom() & (slots - 1)) + 1;
+			break;
+		default:
+			slots = 0;
+			break;
+	}
+	return RETRY_BACKOFF_SLOT * slots;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntRetransmit()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// This function starts the transmission of the unacknowledged packet again. The TX FIFO and
+// the transmit headers still hold the packet (the radio keeps the TX FIFO after sending, the
+// AFCH feature relies on it too), so only the state of the transmission is set up like in
+// EZMacPRO_Transmit(). The LBT is done again if it is enabled.
+//
+//-----------------------------------------------------------------------------------------------
+void timerIntRetransmit (void)
+{
+	#ifndef B1_ONLY
+	if (EZMacProReg.name.DTR == 0) // if the rev V2 chip is used
+		// set the TX deviation (only rev V2)
+		timerIntSpiWriteReg (SI4432_FREQUENCY_DEVIATION, TX_Freq_dev);
+	#endif
+	// clear interrupts
+	timerIntSpiReadReg(SI4432_INTERRUPT_STATUS_1);
+	timerIntSpiReadReg(SI4432_INTERRUPT_STATUS_2);
+
+	if (EZMacProReg.name.TCR & 0x08)
+	{	// LBT enabled
+		// Set Listen Before Talk Limit to RSSI threshold register
+		timerIntSpiWriteReg(SI4432_RSSI_THRESHOLD, EZMacProReg.name.LBTLR);
+		// disable all Si443x interrupt enable 1 sources
+		timerIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, 0x00);
+		// enable RSSI interrupt
+		timerIntSetEnable2(SI4432_ENRSSI);
+		EZMacProLBT_Retrys = 0;
+		BusyLBT = 0;
+		// go to the next state
+		EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_LBT_START_LISTEN;
+		// start timer with LBT ETSI fix timeout
+		timerIntTimeout(TIMEOUT_LBTI_ETSI);
+		ENABLE_MAC_INTERRUPTS();
+		// enable RX
+		timerIntSetFunction1(SI4432_RXON|SI4432_XTON);
+	}
 	else
-		return temp8;
+	{
+		// enable ENPKSENT bit
+		timerIntSpiWriteReg(SI4432_INTERRUPT_ENABLE_1, SI4432_ENPKSENT);
+		// clear enable 2 interrupt
+		timerIntSetEnable2(0x00);
+		// go to the next state
+		EZMacProReg.name.MSR = TX_STATE_BIT | TX_STATE_WAIT_FOR_TX;
+		// start timer with transmit packet timeout
+		timerIntTimeout(TimeoutTX_Packet);
+		ENABLE_MAC_INTERRUPTS();
+		// enable TX
+		timerIntSetFunction1(SI4432_TXON|SI4432_XTON);
+	}
 }
 #endif
 
@@ -892,6 +1171,9 @@ void timerIntNextRX_Channel (void)
 {
 	U8	mask;
 	U8	n;
+#ifdef CHANNEL_QUALITY_ENABLED
+	U8	tries = 0;
+#endif
 
 	n = EZMacProCurrentChannel;
 
@@ -907,7 +1189,12 @@ void timerIntNextRX_Channel (void)
 		if (mask == 0x80) mask = 0x08;	// wrap mask to bits 3-6
 
 		// continue until unmasked bit is found
+#ifndef CHANNEL_QUALITY_ENABLED
 	} while ((EZMacProReg.name.RCR & mask) == mask);
+#else
+		// and skip the blacklisted channels, the fourth one is taken anyway
+	} while (((EZMacProReg.name.RCR & mask) == mask) || ((++tries < 4) && timerIntChannelSkip(n)));
+#endif
 
 	//switch off the receiver
 	timerIntSetFunction1(SI4432_XTON);
@@ -1004,8 +1291,11 @@ void timerIntGotoNextStateUsingSECR( U8 tx)
 		//select the nex channel
 		SelectedChannel = 0;
 		timerIntSpiWriteReg (SI4432_FREQUENCY_HOPPING_CHANNEL_SELECT,EZMacProReg.array[FR0+SelectedChannel]);
+		#ifdef FAST_SCAN_ENABLED
+		FastScanDwell = 0;
+		#endif
 		// start timer with channel search timeout
-		timerIntTimeout(TimeoutChannelSearch);
+		timerIntTimeout(SEARCH_TIMEOUT);
 		ENABLE_MAC_TIMER_INTERRUPT();
 	#endif
 		//go to the next state
@@ -1083,6 +1373,108 @@ void timerIntIncrementError (U8 mask)
 	#endif
 #endif
 
+#ifdef CHANNEL_QUALITY_ENABLED
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntChannelPenalty()
+//
+// Return Value : None
+// Parameters	: U8 ch - index of the frequency register, U8 penalty - score to add
+//
+// Notes:
+//
+// A channel reaching CHANNEL_BLACKLIST is skipped CHANNEL_PROBE_SKIPS times by the search
+// before it is searched again (probed).
+//
+//------------------------------------------------------------------------------------------------
+void timerIntChannelPenalty(U8 ch, U8 penalty)
+{
+	if ((U16)ChannelQuality[ch].score + penalty >= CHANNEL_BLACKLIST)
+		ChannelQuality[ch].score = CHANNEL_BLACKLIST + CHANNEL_PROBE_SKIPS - 1;
+	else
+		ChannelQuality[ch].score += penalty;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntChannelSkip()
+//
+// Return Value : U8 - 1 if the search skips the channel
+// Parameters	: U8 ch - index of the frequency register
+//
+// Notes:
+//
+// Every skip lowers the score of a blacklisted channel, it is probed when the score is below
+// CHANNEL_BLACKLIST again.
+//
+//------------------------------------------------------------------------------------------------
+U8 timerIntChannelSkip(U8 ch)
+{
+	if (ChannelQuality[ch].score < CHANNEL_BLACKLIST)
+		return 0;
+	ChannelQuality[ch].score--;
+	return 1;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntChannelNoise()
+//
+// Return Value : None
+// Parameters	: U8 ch - index of the frequency register
+//
+// Notes:
+//
+// Called at the end of a search dwell without preamble. The RSSI of the idle channel is the
+// noise, a noisy channel gets CHANNEL_NOISE_PENALTY, a quiet one lowers its score.
+//
+//------------------------------------------------------------------------------------------------
+void timerIntChannelNoise(U8 ch)
+{
+	U8 rssi;
+
+	rssi = timerIntSpiReadReg(SI4432_RECEIVED_SIGNAL_STRENGTH_INDICATOR);
+	if (ChannelQuality[ch].noise == 0)
+		ChannelQuality[ch].noise = rssi;
+	else
+		ChannelQuality[ch].noise = ChannelQuality[ch].noise - ChannelQuality[ch].noise / 4 + rssi / 4;
+
+	if (rssi >= CHANNEL_NOISE_LIMIT)
+		timerIntChannelPenalty(ch, CHANNEL_NOISE_PENALTY);
+	else if (ChannelQuality[ch].score)
+		ChannelQuality[ch].score--;
+}
+	#ifdef MORE_CHANNEL_IS_USED
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntSkipChannels()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Moves SelectedChannel over the blacklisted channels that follow it, so the search steps to
+// the next channel that is not skipped. If all are skipped the next one is searched anyway.
+//
+//------------------------------------------------------------------------------------------------
+void timerIntSkipChannels(void)
+{
+	U8 next;
+	U8 i;
+
+	for (i = 1; i < maxChannelNumber; i++)
+	{
+		next = (SelectedChannel < (maxChannelNumber - 1)) ? SelectedChannel + 1 : 0;
+		if (!timerIntChannelSkip(next))
+			return;
+		SelectedChannel = next;
+	}
+}
+	#endif //MORE_CHANNEL_IS_USED
+#endif //CHANNEL_QUALITY_ENABLED
+
 //------------------------------------------------------------------------------------------------
 // Function Name
 //	timerIntSetEnable2()
@@ -1143,4 +1535,144 @@ void timerIntSetFunction1(U8 value)
 }
 #endif//TRANSMITTER_ONLY_OPERATION
 
+#ifdef TRANSCEIVER_OPERATION
+	#ifdef EXTENDED_PACKET_FORMAT
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntSetLinkRate()
+//
+// Return Value : None
+// Parameters	: U8 rate - data rate (MCR bits 6:5 format)
+//
+// Notes:
+//
+// Switches the modem to the data rate of a link, like macSetLinkRate().
+//
+//------------------------------------------------------------------------------------------------
+void timerIntSetLinkRate (U8 rate)
+{
+	U8 i;
+	U8 preamble;
+	U16 delta;
+
+	if (rate == LinkRate)
+		return;
+
+	delta = LinkRateDelta[LinkRate][rate];
+	for (i = 0; i < NUMBER_OF_PARAMETER_B1; i++)
+		if (delta & ((U16)1 << i))
+			timerIntSpiWriteReg(LinkRateReg[i], RfSettingsB1[rate][i]);
+	timerIntSpiWriteReg(SI4432_PREAMBLE_DETECTION_CONTROL, (Parameters[rate][PREAMBLE_DETECTION_THRESHOLD]<<3)|0x02);
+#ifdef FOUR_CHANNEL_IS_USED
+	preamble = Parameters[rate][PREAMBLE_IF_ONE_CHANNEL + (EZMacProReg.name.MCR & 0x03)];
+	timerIntSpiWriteReg(SI4432_PREAMBLE_LENGTH, preamble<<1);
+	TimeoutChannelSearch = EZMacProByteTime[rate] * Parameters[rate][SEARCH_TIME];
+#endif
+#ifdef MORE_CHANNEL_IS_USED
+	preamble = Parameters[rate][PREAMBLE_LENGTH];
+	timerIntSpiWriteReg(SI4432_PLL_TUNE_TIME, Parameters[rate][PLL_TUNE_TIME_REG_VALUE]);
+	timerIntSpiWriteReg(SI4432_PREAMBLE_LENGTH, Parameters[rate][PREAMBLE_LENGTH_REG_VALUE2]);
+	TimeoutChannelSearch = (EZMacProByteTime[rate]/8) * Parameters[rate][SEARCH_TIME];
+	#ifdef FAST_SCAN_ENABLED
+	TimeoutFastScan = FAST_SCAN_TIMEOUT(EZMacProByteTime[rate]);
+	#endif
+#endif
+	TimeoutSyncWord = (preamble + 2) * (U32)EZMacProByteTime[rate];
+	LinkRate = rate;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntLinkFailed()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Called when the retransmissions of a packet are used up. After LINK_RATE_FAILURES lost
+// packets in a row the link falls back to the base data rate, both sides reach it there: the
+// peer returns to it when the link expires.
+//
+//------------------------------------------------------------------------------------------------
+void timerIntLinkFailed(void)
+{
+	if (LinkEntry >= LINK_TABLE_SIZE)
+		return;
+
+	LinkTable[LinkEntry].acks = 0;
+	if (++LinkTable[LinkEntry].fails >= LINK_RATE_FAILURES)
+	{
+		LinkTable[LinkEntry].rate = (EZMacProReg.name.MCR >> 5) & 0x03;
+		LinkTable[LinkEntry].fails = 0;
+		timerIntSetLinkRate(LinkTable[LinkEntry].rate);
+	}
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntLinkHold()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Called at the channel search timeout. The receiver stays at the data rate of the last peer
+// for LINK_RATE_HOLD, then it listens at the base data rate again.
+//
+//------------------------------------------------------------------------------------------------
+void timerIntLinkHold(void)
+{
+	U8 rate;
+
+	if ((LinkEntry < LINK_TABLE_SIZE) && ((MAC_TIMER_NOW() - LinkTable[LinkEntry].stamp) < LINK_RATE_HOLD))
+		rate = LinkTable[LinkEntry].rate;
+	else
+		rate = (EZMacProReg.name.MCR >> 5) & 0x03;
+	if (rate == LinkRate)
+		return;
+
+	//switch off the receiver
+	timerIntSetFunction1(SI4432_XTON);
+	timerIntSetLinkRate(rate);
+	//switch on the receiver
+	timerIntSetFunction1(SI4432_XTON|SI4432_RXON);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerIntLinkPowerUp()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Called when the ACK is missing. The TX power of the link is raised by LINK_POWER_RECOVERY
+// steps for the retransmission, and to the maximum (TCR) if the retransmissions are used up.
+//
+//------------------------------------------------------------------------------------------------
+void timerIntLinkPowerUp(void)
+{
+	U8 power;
+	U8 max;
+
+	if (LinkEntry >= LINK_TABLE_SIZE)
+		return;
+
+	max = (EZMacProReg.name.TCR >> 4) & 0x07;
+	power = LinkTable[LinkEntry].power + LINK_POWER_RECOVERY;
+	if ((power > max) || (EZMacProTxAttempts > (EZMacProReg.name.RTCR & RTCR_RETRIES)))
+		power = max;
+	LinkTable[LinkEntry].power = power;
+	if (power != LinkPower)
+	{
+		timerIntSpiWriteReg(SI4432_TX_POWER, (power | 0x18));
+		LinkPower = power;
+	}
+}
+	#endif //EXTENDED_PACKET_FORMAT
+#endif //TRANSCEIVER_OPERATION
+
 
@@ -0,0 +1,307 @@
+/*!\file EZMacPro_TimerWheel.c
+ * \brief Hierarchical timer wheel for the application and stack timeouts.
+ *
+ * \n The wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots. A timer
+ * \n is linked into the slot of the lowest level that covers its remaining
+ * \n time, and is moved one level down when the slot is reached (cascade).
+ * \n Starting, stopping and expiring a timer takes constant time, independent
+ * \n of the number of the active timers.
+ *
+ * \n The tick comes from the MAC timer interrupt, it only counts TimerWheelTicks
+ * \n and signals EZMAC_EVENT_TIMER if a slot has to be processed. The timers are
+ * \n expired and the handlers are called by EZMacPRO_Timer_Process() in the main
+ * \n loop. The timers should be started and stopped from the main loop only. The
+ * \n tick runs only while there is an active timer.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+/* ======================================= *
+ *				I N C L U D E				*
+ * ======================================= */
+
+#include "stack.h"
+
+/* ======================================= *
+ *	 G L O B A L	V A R I A B L E S	 *
+ * ======================================= */
+
+// the longest time a timer can be placed for, a longer timer is placed again when it is reached
+#define TIMER_WHEEL_RANGE		(((U32)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+SEGMENT_VARIABLE(TimerWheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS], EZMacProTimer *, APPLICATION_MSPACE);
+
+// ticks counted by the interrupt
+volatile SEGMENT_VARIABLE(TimerWheelTicks, U32, EZMAC_PRO_GLOBAL_MSPACE);
+// ticks processed by EZMacPRO_Timer_Process()
+SEGMENT_VARIABLE(TimerWheelNow, U32, APPLICATION_MSPACE);
+// number of the active timers
+SEGMENT_VARIABLE(TimerWheelActive, U16, APPLICATION_MSPACE);
+
+/* ======================================= *
+ *		L O C A L	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerWheelLink()
+//
+// Return Value : None
+// Parameters	: timer - the timer to place
+//
+// Notes:
+//
+// Links the timer into the slot of the lowest level that covers the time until its expiry.
+// If the expiry is farther than TIMER_WHEEL_RANGE the timer is placed at the end of the range.
+//
+//------------------------------------------------------------------------------------------------
+static void timerWheelLink(EZMacProTimer *timer)
+{
+	EZMacProTimer **slot;
+	U32 expires = timer->expires;
+	U32 delta = expires - TimerWheelNow;
+	U8 level;
+
+	if (delta > TIMER_WHEEL_RANGE)
+	{
+		delta = TIMER_WHEEL_RANGE;
+		expires = TimerWheelNow + TIMER_WHEEL_RANGE;
+	}
+
+	for (level = 0; level < (TIMER_WHEEL_LEVELS - 1); level++)
+	{
+		if (delta < ((U32)1 << (TIMER_WHEEL_BITS * (level + 1))))
+			break;
+	}
+
+	slot = &TimerWheel[level][(expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK];
+	timer->next = *slot;
+	if (timer->next != NULL)
+		timer->next->pprev = &timer->next;
+	timer->pprev = slot;
+	*slot = timer;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerWheelUnlink()
+//
+// Return Value : None
+// Parameters	: timer - an active timer
+//
+//------------------------------------------------------------------------------------------------
+static void timerWheelUnlink(EZMacProTimer *timer)
+{
+	if (timer->next != NULL)
+		timer->next->pprev = timer->pprev;
+	*timer->pprev = timer->next;
+	timer->pprev = NULL;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name
+//	timerWheelAdvance()
+//
+// Return Value : None
+// Parameters	: None
+//
+// Notes:
+//
+// Processes one tick. The slots of the upper levels reached by this tick are moved down, then
+// the timers of the level 0 slot expire. A periodic timer is placed again relative to its
+// expiry, so it does not drift if the main loop is late.
+//
+//------------------------------------------------------------------------------------------------
+static void timerWheelAdvance(void)
+{
+	EZMacProTimer *timer;
+	EZMacProTimer **slot;
+	U8 level;
+
+	TimerWheelNow++;
+
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		if (TimerWheelNow & (((U32)1 << (TIMER_WHEEL_BITS * level)) - 1))
+			break;
+
+		slot = &TimerWheel[level][(TimerWheelNow >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK];
+		while ((timer = *slot) != NULL)
+		{
+			timerWheelUnlink(timer);
+			timerWheelLink(timer);
+		}
+	}
+
+	slot = &TimerWheel[0][TimerWheelNow & TIMER_WHEEL_MASK];
+	while ((timer = *slot) != NULL)
+	{
+		timerWheelUnlink(timer);
+
+		if (timer->expires != TimerWheelNow)
+		{	// end of the range of a long timer
+			timerWheelLink(timer);
+			continue;
+		}
+
+		if (timer->period != 0)
+		{
+			timer->expires += timer->period;
+			timerWheelLink(timer);
+		}
+		else
+		{
+			TimerWheelActive--;
+		}
+
+		timer->expired = 1;
+		if (timer->handler != NULL)
+			timer->handler(timer);
+	}
+}
+
+/* ======================================= *
+ *	 P U B L I C	F U N C T I O N S		*
+ * ======================================= */
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Timer_Init()
+//					Stops the tick and all timers. It is called by EZMacPRO_Init().
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Timer_Init(void)
+{
+	EZMacProTimer *timer;
+	U8 level;
+	U8 temp8;
+
+	TIMER_WHEEL_TICK_STOP();
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		for (temp8 = 0; temp8 < TIMER_WHEEL_SLOTS; temp8++)
+		{	// the timers started before are marked stopped
+			while ((timer = TimerWheel[level][temp8]) != NULL)
+				timerWheelUnlink(timer);
+		}
+	}
+	TimerWheelTicks = 0;
+	TimerWheelNow = 0;
+	TimerWheelActive = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Timer_Start()
+//					Starts or restarts a timer. The handler is called from the main loop when the
+//					timer expires, a periodic timer is reloaded before the handler is called.
+//
+// Return Value :	None
+// Parameters	:	timer - the timer
+//					ticks - time until the first expiry in TIMER_WHEEL_TICK_MS ticks, minimum 1
+//					period - reload value in ticks, 0 for a one-shot timer
+//					handler - called on expiry, can be NULL
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Timer_Start(EZMacProTimer *timer, U32 ticks, U32 period, EZMacProTimerHandler handler)
+{
+	if (timer->pprev != NULL)
+		timerWheelUnlink(timer);
+	else if (TimerWheelActive++ == 0)
+	{	// the wheel was stopped, it continues from the last tick
+		TimerWheelNow = TimerWheelTicks;
+		TIMER_WHEEL_TICK_START();
+	}
+
+	if (ticks == 0)
+		ticks = 1;
+	timer->expires = TimerWheelNow + ticks;
+	timer->period = period;
+	timer->handler = handler;
+	timer->expired = 0;
+	timerWheelLink(timer);
+
+	// the interrupt may have passed the slot before the timer was linked
+	if (TimerWheelTicks != TimerWheelNow)
+		EZMacPRO_Event_Signal(EZMAC_EVENT_TIMER);
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Timer_Stop()
+//					Stops a timer. Stopping a timer which is not active is ignored.
+//
+// Return Value :	None
+// Parameters	:	timer - the timer
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Timer_Stop(EZMacProTimer *timer)
+{
+	if (timer->pprev == NULL)
+		return;
+
+	timerWheelUnlink(timer);
+	if (--TimerWheelActive == 0)
+		TIMER_WHEEL_TICK_STOP();
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Timer_Active()
+//
+// Return Value :	1: the timer is running
+//					0: the timer is stopped or a one-shot timer expired
+// Parameters	:	timer - the timer, NULL: any timer
+//------------------------------------------------------------------------------------------------
+U8 EZMacPRO_Timer_Active(EZMacProTimer *timer)
+{
+	if (timer == NULL)
+		return (TimerWheelActive != 0) ? 1 : 0;
+	return (timer->pprev != NULL) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Timer_Process()
+//					Processes the ticks counted since the last call and calls the handlers of
+//					the expired timers. It is called by EZMacPRO_Task_Schedule(), an application
+//					without tasks should call it from its main loop.
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Timer_Process(void)
+{
+	while (TimerWheelNow != TimerWheelTicks)
+	{
+		if (TimerWheelActive == 0)
+		{
+			TimerWheelNow = TimerWheelTicks;
+			break;
+		}
+		timerWheelAdvance();
+	}
+
+	if (TimerWheelActive == 0)
+		TIMER_WHEEL_TICK_STOP();
+}
+
+//------------------------------------------------------------------------------------------------
+// Function Name:	EZMacPRO_Timer_Tick()
+//					Counts one tick. It is called from the MAC timer interrupt. The main loop is
+//					only woken up if the tick reaches an occupied slot or an upper level slot.
+//
+// Return Value :	None
+// Parameters	:	None
+//------------------------------------------------------------------------------------------------
+void EZMacPRO_Timer_Tick(void)
+{
+	U32 ticks = TimerWheelTicks + 1;
+
+	TimerWheelTicks = ticks;
+	if (((ticks & TIMER_WHEEL_MASK) == 0) || (TimerWheel[0][ticks & TIMER_WHEEL_MASK] != NULL))
+		EZMacPRO_Event_Signal(EZMAC_EVENT_TIMER);
+}
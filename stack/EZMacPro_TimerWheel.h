@@ -0,0 +1,67 @@
+/*!\file EZMacPro_TimerWheel.h
+ * \brief Header of EZMacPro_TimerWheel.c.
+ *
+ * \n EZMacPRO version: 3.0.1r
+ *
+ * \n This software must be used in accordance with the End User License
+ * \n Agreement.
+ *
+ * \b COPYRIGHT
+ * \n Copyright 2012 Silicon Laboratories, Inc.
+ * \n http://www.silabs.com
+ */
+
+#ifndef _EZMACPRO_TIMERWHEEL_H_
+#define _EZMACPRO_TIMERWHEEL_H_
+
+
+                /* ======================================= *
+                 *          D E F I N I T I O N S          *
+                 * ======================================= */
+
+#define TIMER_WHEEL_SLOTS               (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK                (TIMER_WHEEL_SLOTS - 1)
+
+// timer ticks of the given milliseconds
+#define TIMER_MS(ms)                    ((U32)(ms) / TIMER_WHEEL_TICK_MS)
+
+//------------------------------------------------------------------------------------------------
+// software timer
+// The structure is owned by the application, it has to stay valid while the timer is active.
+// expired is set when the timer expires, it can be polled instead of using a handler.
+//------------------------------------------------------------------------------------------------
+typedef struct EZMacProTimer EZMacProTimer;
+
+typedef void (*EZMacProTimerHandler)(EZMacProTimer *timer);
+
+struct EZMacProTimer
+{
+	EZMacProTimer *next;				// next timer in the same slot
+	EZMacProTimer **pprev;				// link pointing to this timer, NULL if not active
+	U32 expires;						// tick of the expiry
+	U32 period;							// reload value in ticks, 0 for one-shot
+	EZMacProTimerHandler handler;		// called on expiry, can be NULL
+	U8 expired;
+};
+
+
+                /* ======================================= *
+                 *     G L O B A L   V A R I A B L E S     *
+                 * ======================================= */
+
+extern volatile SEGMENT_VARIABLE(TimerWheelTicks, U32, EZMAC_PRO_GLOBAL_MSPACE);
+
+
+                /* ======================================= *
+                 *  F U N C T I O N   P R O T O T Y P E S  *
+                 * ======================================= */
+
+void EZMacPRO_Timer_Init(void);
+void EZMacPRO_Timer_Start(EZMacProTimer *timer, U32 ticks, U32 period, EZMacProTimerHandler handler);
+void EZMacPRO_Timer_Stop(EZMacProTimer *timer);
+U8   EZMacPRO_Timer_Active(EZMacProTimer *timer);
+void EZMacPRO_Timer_Process(void);
+void EZMacPRO_Timer_Tick(void);
+
+
+#endif //_EZMACPRO_TIMERWHEEL_H_
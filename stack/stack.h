@@ -18,6 +18,12 @@
 
 #include "EZMacPro_Defs.h"
 #include "EZMacPro.h"
+#include "EZMacPro_FramePool.h"
+#include "EZMacPro_Event.h"
+#include "EZMacPro_Task.h"
+#include "EZMacPro_TimerWheel.h"
+#include "EZMacPro_Nvm.h"
+#include "EZMacPro_Aggregate.h"
 #include "EZMacPro_Const.h"
 #include "EZMacPro_ExternalInt.h"
 #include "EZMacPro_TimerInt.h"